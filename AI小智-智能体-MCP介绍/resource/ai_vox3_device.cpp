@@ -8,25 +8,49 @@
 #include <esp_lcd_panel_io.h>
 #include <esp_lcd_panel_ops.h>
 #include <esp_lcd_panel_vendor.h>
+#include <esp_timer.h>
 
 #include "ai_vox_engine.h"
+#include "arduino_wifi_fast_connect_driver.h"
+#include "arena.h"
+#include "asset_pack.h"
 #include "audio_device/audio_device_es8311.h"
+#include "boot_graph.h"
 #include "components/espressif/button/button_gpio.h"
 #include "components/espressif/button/iot_button.h"
-#include "components/espressif/esp_audio_codec/esp_audio_simple_dec.h"
-#include "components/espressif/esp_audio_codec/esp_mp3_dec.h"
 #include "components/wifi_configurator/wifi_configurator.h"
+#include "deferred_log.h"
 #include "display.h"
-#include "led_strip.h"
+#include "dns_prefetch.h"
+#include "esp_asset_partition.h"
+#include "esp_i2c_bus.h"
+#include "i2c_bus_manager.h"
+#include "json_writer.h"
+#include "latency_trace.h"
+#include "led_effects.h"
+#include "mcp_async.h"
+#include "mcp_batch.h"
+#include "mcp_tool.h"
+#include "metrics.h"
+#ifndef PROMPT_ASSET_PACK
 #include "network_config_mode_mp3.h"
 #include "network_connected_mp3.h"
 #include "notification_0_mp3.h"
+#endif
+#include "pcm_dsp.h"
+#include "prompt_player.h"
+#include "sensor_sampler.h"
+#include <algorithm>
+#include <atomic>
 #include <map>
 #include <vector>
 #include <functional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 #include "wifi_config.h"
+#include "wifi_fast_connect.h"
 
 namespace {
 
@@ -48,6 +72,22 @@ namespace {
  */
 constexpr smartconfig_type_t kSmartConfigType = SC_TYPE_ESPTOUCH_AIRKISS;
 
+constexpr char kOtaUrl[] = "https://api.tenclass.net/xiaozhi/ota/";
+constexpr char kWebsocketUrl[] = "wss://api.tenclass.net/xiaozhi/v1/";
+
+// 使用缓存的AP信息快速重连的超时时间(毫秒)，超时后回退到常规配网流程
+constexpr uint32_t kWifiFastConnectTimeoutMs = 3000;
+// 快速重连时是否复用上次DHCP分配的IP，仅在路由器为本设备保留了IP时开启
+constexpr bool kWifiReuseCachedIp = false;
+
+// MCP JSON响应缓冲区的默认大小
+constexpr size_t kMcpResponseBufferSize = 4096;
+// self.system.get_metrics 按测量的大小分配缓冲区，再留出余量给两次写入之间变长的数值
+constexpr size_t kMetricsJsonSlack = 256;
+
+// 主循环每次迭代的临时内存(PSRAM)，存放调试日志字符串和JSON响应，每次迭代开始时整体回收
+constexpr size_t kLoopArenaSize = 32 * 1024;
+
 constexpr auto kButtonBoot = GPIO_NUM_0;
 constexpr auto kLcdBacklightPin = GPIO_NUM_16;
 
@@ -58,6 +98,7 @@ constexpr auto kSt7789Csx = GPIO_NUM_15;   // SPI CS
 constexpr auto kSt7789Dcx = GPIO_NUM_14;   // SPI DC
 
 constexpr auto kWs2812LedPin = GPIO_NUM_41;
+constexpr uint32_t kWs2812LedCount = 1;
 
 // ES8311音频芯片引脚配置
 constexpr auto kEs8311Mclk = GPIO_NUM_11;
@@ -70,6 +111,10 @@ constexpr auto kEs8311Asdout = GPIO_NUM_9;
 constexpr auto kI2cScl = GPIO_NUM_12;
 constexpr auto kI2cSda = GPIO_NUM_13;
 constexpr auto kI2CPort = I2C_NUM_1;
+constexpr uint32_t kI2cSclSpeedHz = 400000;
+// 总线事务工作任务，优先级高于传感器采样任务，以便采样任务提交后尽快执行
+constexpr uint32_t kI2cBusTaskStackSize = 4096;
+constexpr UBaseType_t kI2cBusTaskPriority = 3;
 
 // 显示屏配置
 constexpr auto kDisplaySpiMode = 0;
@@ -80,26 +125,201 @@ constexpr bool kDisplayMirrorY = false;
 constexpr bool kDisplayInvertColor = true;
 constexpr bool kDisplaySwapXY = false;
 constexpr auto kDisplayRgbElementOrder = LCD_RGB_ELEMENT_ORDER_RGB;
+// SPI 单次传输的最大行数，决定 max_transfer_sz(240 * 20 * 2 = 9600字节)
+constexpr uint32_t kDisplayMaxTransferLines = 20;
 
 // 音频设备配置
 constexpr uint8_t kEs8311I2cAddress = 0x30;
 constexpr uint32_t kAudioSampleRate = 16000;
 
+// 定义 PROMPT_ASSET_PACK 宏时提示音从该数据分区中的资源包读取(见 asset_pack.h)
+constexpr char kAssetPartitionLabel[] = "assets";
+
+// 提示音在资源包中的ID，用 tools/asset_pack_tool 打包时使用同样的ID
+enum class PromptId : uint16_t {
+  kNotification0 = 1,
+  kNetworkConfigMode = 2,
+  kNetworkConnected = 3,
+};
+
+// 主循环空闲等待时两次检查事件之间的最长休眠时间(毫秒)，即最坏情况下的事件响应延迟
+constexpr uint32_t kMaxIdleSleepMs = 10;
+
+// 主循环中显示屏的最短刷新间隔(毫秒)，约30fps
+constexpr uint32_t kDisplayFrameIntervalMs = 33;
+
 // ==================== 全局变量 ====================
 
-i2c_master_bus_handle_t g_i2c_master_bus_handle = nullptr;
+std::unique_ptr<EspI2cBus> g_i2c_bus;
+std::unique_ptr<I2cBusManager> g_i2c_bus_manager;
 std::shared_ptr<ai_vox::AudioDeviceEs8311> g_audio_device_es8311;
+std::unique_ptr<PromptPlayer> g_prompt_player;
+#ifdef PROMPT_ASSET_PACK
+EspAssetPartition g_asset_partition;
+bool g_asset_partition_mapped = false;
+#endif
 std::unique_ptr<Display> g_display;
 auto g_observer = std::make_shared<ai_vox::Observer>();
 button_handle_t g_button_boot_handle = nullptr;
+std::unique_ptr<WifiConfigurator> g_wifi_configurator;
+ArduinoWifiFastConnectDriver g_wifi_fast_connect_driver(WiFi);
+NvsWifiFastConnectStore g_wifi_fast_connect_store;
+int64_t g_wifi_connect_start_time_us = 0;
+int64_t g_wifi_connected_time_us = 0;
+int64_t g_engine_start_time_us = 0;
+bool g_wifi_fast_connected = false;
 
 bool g_led_on = false;
-led_strip_handle_t g_led_strip;
+std::unique_ptr<LedEffects> g_led_effects;
+// 通过MCP工具手动设置了灯效后不再跟随对话状态，直到设置为 auto
+std::atomic<bool> g_led_effect_manual{false};
+std::atomic<ai_vox::ChatState> g_chat_state{ai_vox::ChatState::kIdle};
+
+// ========== MCP 调用分发表 ==========
+using McpHandler = std::function<void(const ai_vox::McpToolCallEvent&)>;
+
+// 支持以 std::string_view 直接查找，避免分发时构造临时 std::string
+struct McpToolNameHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view name) const {
+    return std::hash<std::string_view>{}(name);
+  }
+};
+
+struct McpTool {
+  // 类型化工具直接调用 invoke，通过 RegisterUserMcpHandler 注册的工具调用 handler
+  void (*invoke)(const ai_vox::McpToolCallEvent&) = nullptr;
+  McpHandler handler;
+  Metric* call_count = nullptr;
+};
 
-// ========== 用户注册的 MCP 回调存储 ==========
-std::map<std::string, std::function<void(const ai_vox::McpToolCallEvent&)>> g_user_mcp_handlers;
+// 内置工具与用户注册的工具共用一张哈希表，InitMcpTools() 中完成构建
+std::unordered_map<std::string, McpTool, McpToolNameHash, std::equal_to<>> g_mcp_tools;
 std::vector<std::function<void(ai_vox::Engine&)>> g_user_mcp_declarators;
 
+std::unique_ptr<Arena> g_loop_arena;
+
+// 最近一次 BeginMcpJsonResponse() 分配的写入器，以及分配前后 g_loop_arena 的使用量
+struct McpResponseAllocation {
+  const JsonWriter* writer = nullptr;
+  size_t mark = 0;
+  size_t end = 0;
+};
+McpResponseAllocation g_mcp_response_allocation;
+
+// ========== 运行时指标 ==========
+// 累计值，通过 self.system.get_metrics 查询，InitMetrics() 中完成注册
+struct MainLoopMetrics {
+  Metric* iterations = nullptr;
+  Metric* events = nullptr;
+  Metric* busy_us_last = nullptr;
+  Metric* busy_us_max = nullptr;
+  Metric* mcp_errors = nullptr;
+};
+
+MainLoopMetrics g_main_loop_metrics;
+
+// ========== 显示状态 ==========
+// 主循环中的显示更新先写入这里，按帧间隔统一刷新，一帧内只保留最新内容
+struct DisplayState {
+  enum DirtyFlag : uint8_t {
+    kStatusDirty = 1 << 0,
+    kEmotionDirty = 1 << 1,
+    kChatMessageDirty = 1 << 2,
+  };
+
+  uint8_t dirty = 0;
+  const char* status = nullptr;
+  std::string emotion;
+  Display::Role chat_role = Display::Role::kSystem;
+  std::string chat_message;
+  uint32_t last_flush_time = 0;
+  uint32_t update_count = 0;
+  uint32_t redraws_avoided = 0;
+  // Display::SetChatMessage() 的实际耗时，用于评估聊天文字的排版和绘制开销
+  uint32_t chat_message_count = 0;
+  int64_t chat_message_total_us = 0;
+  int64_t chat_message_max_us = 0;
+};
+
+DisplayState g_display_state;
+
+// ========== 性能统计 ==========
+#ifdef PRINT_PERF_INFO_INTERVAL
+struct PerfStats {
+  uint32_t loop_count = 0;
+  uint32_t event_count = 0;
+  uint32_t idle_ms = 0;
+  uint32_t max_wake_delay_ms = 0;
+  uint32_t mcp_call_count = 0;
+  int64_t mcp_dispatch_total_us = 0;
+  int64_t mcp_dispatch_max_us = 0;
+};
+
+PerfStats g_perf_stats;
+#endif
+
+// ========== 提示音 ==========
+
+#ifndef PROMPT_ASSET_PACK
+struct BuiltinPrompt {
+  PromptId id;
+  const uint8_t* data;
+  size_t size;
+};
+
+// 未使用资源包时提示音编译进固件
+constexpr BuiltinPrompt kBuiltinPrompts[] = {
+    {PromptId::kNotification0, kNotification0mp3, sizeof(kNotification0mp3)},
+    {PromptId::kNetworkConfigMode, kNetworkConfigModeMp3, sizeof(kNetworkConfigModeMp3)},
+    {PromptId::kNetworkConnected, kNetworkConnectedMp3, sizeof(kNetworkConnectedMp3)},
+};
+#endif
+
+std::optional<Asset> FindPrompt(PromptId id) {
+#ifdef PROMPT_ASSET_PACK
+  return g_asset_partition.pack().Find(static_cast<uint16_t>(id));
+#else
+  for (const auto& prompt : kBuiltinPrompts) {
+    if (prompt.id == id) {
+      return Asset{
+          .id = static_cast<uint16_t>(id),
+          .encoding = AssetEncoding::kMp3,
+          .channels = 0,
+          .sample_rate = 0,
+          .data = prompt.data,
+          .size = prompt.size,
+      };
+    }
+  }
+  return std::nullopt;
+#endif
+}
+
+#ifdef PROMPT_ASSET_PACK
+void CheckPromptAssets() {
+  std::string missing;
+  for (const auto id : {PromptId::kNotification0, PromptId::kNetworkConfigMode, PromptId::kNetworkConnected}) {
+    if (!g_asset_partition_mapped || !FindPrompt(id)) {
+      missing += missing.empty() ? "" : ", ";
+      missing += std::to_string(static_cast<unsigned>(id));
+    }
+  }
+  if (missing.empty()) {
+    return;
+  }
+
+  g_display->SetChatMessage(Display::Role::kSystem, "Prompt asset pack missing, please flash the assets partition.");
+  while (true) {
+    printf("Prompt asset pack in partition '%s' is missing or lacks prompt ids %s.\n"
+           "Build it with tools/asset_pack_tool and flash it with:\n"
+           "  parttool.py --port <PORT> write_partition --partition-name %s --input assets.bin\n",
+           kAssetPartitionLabel, missing.c_str(), kAssetPartitionLabel);
+    delay(1000);
+  }
+}
+#endif
+
 // ==================== 硬件初始化函数 ====================
 
 void InitI2cBus() {
@@ -116,13 +336,34 @@ void InitI2cBus() {
           .allow_pd = 0,
       },
   };
-  ESP_ERROR_CHECK(i2c_new_master_bus(&i2c_master_bus_config, &g_i2c_master_bus_handle));
-  printf("g_i2c_master_bus: %p\n", g_i2c_master_bus_handle);
+  g_i2c_bus = std::make_unique<EspI2cBus>(i2c_master_bus_config, kI2cSclSpeedHz);
+  printf("g_i2c_master_bus: %p\n", g_i2c_bus->handle());
+
+  // 外接设备的事务由工作任务按设备优先级排队执行；ES8311 驱动直接使用总线句柄，不经过队列
+  g_i2c_bus_manager = std::make_unique<I2cBusManager>(*g_i2c_bus);
+  TaskHandle_t task = nullptr;
+  if (xTaskCreatePinnedToCore(
+          [](void*) {
+            g_i2c_bus_manager->Run();
+            // Stop() 之后 Run() 返回，FreeRTOS 的任务函数不能返回
+            UnregisterMetricTask(xTaskGetCurrentTaskHandle());
+            vTaskDelete(nullptr);
+          },
+          "i2c_bus",
+          kI2cBusTaskStackSize,
+          nullptr,
+          kI2cBusTaskPriority,
+          &task,
+          0) != pdPASS) {
+    printf("Failed to create i2c bus task\n");
+    abort();
+  }
+  RegisterMetricTask("i2c_bus", task);
 }
 
 void InitEs8311() {
   g_audio_device_es8311 = std::make_shared<ai_vox::AudioDeviceEs8311>(
-      g_i2c_master_bus_handle,
+      g_i2c_bus->handle(),
       kEs8311I2cAddress,
       kI2CPort,
       kAudioSampleRate,
@@ -131,6 +372,17 @@ void InitEs8311() {
       kEs8311Lrck,
       kEs8311Asdout,
       kEs8311Dsdin);
+  g_prompt_player = std::make_unique<PromptPlayer>(g_audio_device_es8311, kAudioSampleRate);
+#ifdef PROMPT_ASSET_PACK
+  // 只检查头部和偏移表，校验值在打包时由 asset_pack_tool 核对，启动时不读取整个分区
+  g_asset_partition_mapped = g_asset_partition.Map(kAssetPartitionLabel, false);
+#endif
+  // 配网提示音在重复进入配网模式时会多次播放，首次播放后缓存PCM以省去解码。
+  // 其它提示音每次启动只播放一次，按首次播放时打印的大小/耗时报告决定是否启用。
+  // 资源包中以PCM存放的提示音本身不需要解码，不必缓存。
+  if (const auto prompt = FindPrompt(PromptId::kNetworkConfigMode); prompt && prompt->encoding == AssetEncoding::kMp3) {
+    g_prompt_player->EnablePcmCache(prompt->data);
+  }
 }
 
 void InitDisplay() {
@@ -148,7 +400,9 @@ void InitDisplay() {
       .data6_io_num = GPIO_NUM_NC,
       .data7_io_num = GPIO_NUM_NC,
       .data_io_default_level = false,
-      .max_transfer_sz = kDisplayWidth * kDisplayHeight * sizeof(uint16_t),
+      // 按20行而不是整帧分配DMA描述符。显示库的绘制缓冲区在DMA内存中，每次刷新最多10行(4800字节)，
+      // 一次SPI传输完成；IDF默认值(约4092字节)会把每次刷新拆成两次传输
+      .max_transfer_sz = kDisplayWidth * kDisplayMaxTransferLines * sizeof(uint16_t),
       .flags = 0,
       .isr_cpu_id = ESP_INTR_CPU_AFFINITY_AUTO,
       .intr_flags = 0,
@@ -186,24 +440,26 @@ void InitDisplay() {
 }
 
 void InitLed() {
-  led_strip_config_t strip_config = {
-      .strip_gpio_num = kWs2812LedPin,
-      .max_leds = 1,
-      .led_model = LED_MODEL_WS2812,
-      .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
-      .flags = {
-          .invert_out = false,
-      }};
+  g_led_effects = std::make_unique<LedEffects>(kWs2812LedPin, kWs2812LedCount);
+}
 
-  led_strip_rmt_config_t rmt_config = {
-      .clk_src = RMT_CLK_SRC_DEFAULT,
-      .resolution_hz = 10 * 1000 * 1000,
-      .mem_block_symbols = 0,
-      .flags = {
-          .with_dma = 0,
-      }};
-  ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &g_led_strip));
-  ESP_ERROR_CHECK(led_strip_clear(g_led_strip));
+// 对话状态对应的默认灯效
+LedEffects::Effect LedEffectForState(ai_vox::ChatState state) {
+  switch (state) {
+    case ai_vox::ChatState::kLoading:
+    case ai_vox::ChatState::kConnecting:
+      return {LedEffects::Mode::kChase, 0x0000FF, 1000};
+    case ai_vox::ChatState::kLoadingFailed:
+      return {LedEffects::Mode::kBlink, 0xFF0000, 500};
+    case ai_vox::ChatState::kStandby:
+      return {LedEffects::Mode::kBreathe, 0x0000FF, 3000};
+    case ai_vox::ChatState::kListening:
+      return {LedEffects::Mode::kSolid, 0x00FF00, 1000};
+    case ai_vox::ChatState::kSpeaking:
+      return {LedEffects::Mode::kBreathe, 0x00FFFF, 1000};
+    default:
+      return {};
+  }
 }
 
 void InitButton() {
@@ -225,74 +481,44 @@ void InitButton() {
 
 // ==================== 音频播放函数 ====================
 
-void PlayMp3(const uint8_t* data, size_t size) {
-  auto ret = esp_mp3_dec_register();
-  if (ret != ESP_AUDIO_ERR_OK) {
-    printf("Failed to register mp3 decoder: %d\n", ret);
-    abort();
-  }
+// 加入提示音播放队列后立即返回，由播放器任务在后台解码和输出
+void PlayMp3(const uint8_t* data, size_t size, PromptPlayer::Priority priority = PromptPlayer::Priority::kNormal) {
+  g_prompt_player->Enqueue(data, size, priority);
+}
 
-  esp_audio_simple_dec_handle_t decoder = nullptr;
-  esp_audio_simple_dec_cfg_t audio_dec_cfg{
-      .dec_type = ESP_AUDIO_SIMPLE_DEC_TYPE_MP3,
-      .dec_cfg = nullptr,
-      .cfg_size = 0,
-  };
-  ret = esp_audio_simple_dec_open(&audio_dec_cfg, &decoder);
-  if (ret != ESP_AUDIO_ERR_OK) {
-    printf("Failed to open mp3 decoder: %d\n", ret);
-    abort();
+// 按ID播放提示音，资源包中的PCM提示音不经过解码器
+void PlayMp3(PromptId id, PromptPlayer::Priority priority = PromptPlayer::Priority::kNormal) {
+  const auto prompt = FindPrompt(id);
+  if (!prompt) {
+    printf("prompt %u not found\n", static_cast<unsigned>(id));
+    return;
   }
-  g_audio_device_es8311->OpenOutput(16000);
-
-  esp_audio_simple_dec_raw_t raw = {
-      .buffer = const_cast<uint8_t*>(data),
-      .len = size,
-      .eos = true,
-      .consumed = 0,
-      .frame_recover = ESP_AUDIO_SIMPLE_DEC_RECOVERY_NONE,
-  };
-
-  uint8_t* frame_data = (uint8_t*)malloc(4096);
-  esp_audio_simple_dec_out_t out_frame = {
-      .buffer = frame_data,
-      .len = 4096,
-      .needed_size = 0,
-      .decoded_size = 0,
-  };
-
-  while (raw.len > 0) {
-    const auto ret = esp_audio_simple_dec_process(decoder, &raw, &out_frame);
-    if (ret == ESP_AUDIO_ERR_BUFF_NOT_ENOUGH) {
-      out_frame.buffer = reinterpret_cast<uint8_t*>(realloc(out_frame.buffer, out_frame.needed_size));
-      if (out_frame.buffer == nullptr) {
-        break;
-      }
-      out_frame.len = out_frame.needed_size;
-      continue;
-    }
-
-    if (ret != ESP_AUDIO_ERR_OK) {
-      break;
-    }
-
-    g_audio_device_es8311->Write(reinterpret_cast<int16_t*>(out_frame.buffer), out_frame.decoded_size >> 1);
-    raw.len -= raw.consumed;
-    raw.buffer += raw.consumed;
+  if (prompt->encoding == AssetEncoding::kPcm16) {
+    g_prompt_player->EnqueuePcm(reinterpret_cast<const int16_t*>(prompt->data), prompt->size / sizeof(int16_t),
+                                prompt->sample_rate, prompt->channels, priority);
+  } else {
+    PlayMp3(prompt->data, prompt->size, priority);
   }
-
-  free(frame_data);
-
-  g_audio_device_es8311->CloseOutput();
-  esp_audio_simple_dec_close(decoder);
-  esp_audio_dec_unregister(ESP_AUDIO_TYPE_MP3);
 }
 
 // ==================== WiFi配置函数 ====================
 
-void ConfigureWifi() {
+// 只依赖按钮，尽早开始连接，与显示屏和音频芯片的初始化并行
+void StartWifi() {
+  g_wifi_connect_start_time_us = esp_timer_get_time();
+  WifiFastConnect fast_connect(g_wifi_fast_connect_driver, g_wifi_fast_connect_store, kWifiReuseCachedIp);
+#if defined(WIFI_SSID) && defined(WIFI_PASSWORD)
+  g_wifi_fast_connected = fast_connect.TryConnect(kWifiFastConnectTimeoutMs, WIFI_SSID, WIFI_PASSWORD);
+#else
+  g_wifi_fast_connected = fast_connect.TryConnect(kWifiFastConnectTimeoutMs);
+#endif
+  if (g_wifi_fast_connected) {
+    g_wifi_connected_time_us = esp_timer_get_time();
+    return;
+  }
+
   printf("configure wifi\n");
-  auto wifi_configurator = std::make_unique<WifiConfigurator>(WiFi, kSmartConfigType);
+  g_wifi_configurator = std::make_unique<WifiConfigurator>(WiFi, kSmartConfigType);
 
   ESP_ERROR_CHECK(iot_button_register_cb(
       g_button_boot_handle,
@@ -302,36 +528,47 @@ void ConfigureWifi() {
         printf("boot button pressed\n");
         static_cast<WifiConfigurator*>(data)->StartSmartConfig();
       },
-      wifi_configurator.get()));
-
-  g_display->ShowStatus("网络配置中");
-  PlayMp3(kNotification0mp3, sizeof(kNotification0mp3));
+      g_wifi_configurator.get()));
 
 #if defined(WIFI_SSID) && defined(WIFI_PASSWORD)
   printf("wifi config start with wifi: %s, %s\n", WIFI_SSID, WIFI_PASSWORD);
-  wifi_configurator->Start(WIFI_SSID, WIFI_PASSWORD);
+  g_wifi_configurator->Start(WIFI_SSID, WIFI_PASSWORD);
 #else
   printf("wifi config start\n");
-  wifi_configurator->Start();
+  g_wifi_configurator->Start();
 #endif
+}
 
-  while (true) {
-    const auto state = wifi_configurator->WaitStateChanged();
-    if (state == WifiConfigurator::State::kConnecting) {
-      printf("wifi connecting\n");
-      g_display->ShowStatus("网络连接中");
-    } else if (state == WifiConfigurator::State::kSmartConfiguring) {
-      printf("wifi smart configuring\n");
-      g_display->ShowStatus("配网模式");
-      PlayMp3(kNetworkConfigModeMp3, sizeof(kNetworkConfigModeMp3));
-    } else if (state == WifiConfigurator::State::kFinished) {
-      break;
+// 需要显示屏和提示音，在 StartWifi() 和硬件初始化完成后调用
+void WaitWifiConnected() {
+  // 快速重连成功时不经过配网流程
+  if (!g_wifi_fast_connected) {
+    g_display->ShowStatus("网络配置中");
+    PlayMp3(PromptId::kNotification0);
+
+    while (true) {
+      const auto state = g_wifi_configurator->WaitStateChanged();
+      if (state == WifiConfigurator::State::kConnecting) {
+        printf("wifi connecting\n");
+        g_display->ShowStatus("网络连接中");
+      } else if (state == WifiConfigurator::State::kSmartConfiguring) {
+        printf("wifi smart configuring\n");
+        g_display->ShowStatus("配网模式");
+        PlayMp3(PromptId::kNetworkConfigMode, PromptPlayer::Priority::kPreempt);
+      } else if (state == WifiConfigurator::State::kFinished) {
+        g_wifi_connected_time_us = esp_timer_get_time();
+        break;
+      }
     }
-  }
 
-  iot_button_unregister_cb(g_button_boot_handle, BUTTON_PRESS_DOWN, nullptr);
+    iot_button_unregister_cb(g_button_boot_handle, BUTTON_PRESS_DOWN, nullptr);
+    g_wifi_configurator.reset();
+  }
 
-  printf("wifi connected\n");
+  const auto connect_ms = static_cast<uint32_t>((g_wifi_connected_time_us - g_wifi_connect_start_time_us) / 1000);
+  printf("wifi connected in %" PRIu32 " ms%s\n", connect_ms, g_wifi_fast_connected ? " (fast reconnect)" : "");
+  GetMetric("wifi.connect_ms").Set(connect_ms);
+  GetMetric("wifi.fast_connected").Set(g_wifi_fast_connected ? 1 : 0);
   printf("- mac address: %s\n", WiFi.macAddress().c_str());
   printf("- bssid:       %s\n", WiFi.BSSIDstr().c_str());
   printf("- ssid:        %s\n", WiFi.SSID().c_str());
@@ -339,51 +576,216 @@ void ConfigureWifi() {
   printf("- gateway:     %s\n", WiFi.gatewayIP().toString().c_str());
   printf("- subnet mask: %s\n", WiFi.subnetMask().toString().c_str());
 
+  // 保存本次连接的AP信息，下次启动时快速重连
+  WifiFastConnect(g_wifi_fast_connect_driver, g_wifi_fast_connect_store, kWifiReuseCachedIp).UpdateCache();
+
   g_display->ShowStatus("网络已连接");
-  PlayMp3(kNetworkConnectedMp3, sizeof(kNetworkConnectedMp3));
+  PlayMp3(PromptId::kNetworkConnected);
+}
+
+// ==================== 内置MCP工具处理函数 ====================
+
+void SendMcpError(int64_t id, const char* message) {
+  g_main_loop_metrics.mcp_errors->Add();
+  SendMcpErrorResult(id, message);
+}
+
+struct SetVolumeArgs {
+  int64_t volume = 0;
+};
+
+void HandleSetVolume(const ai_vox::McpToolCallEvent& event, const SetVolumeArgs& args) {
+  DLOGI("on mcp tool call: self.audio_speaker.set_volume, volume: %" PRId64 "\n", args.volume);
+  g_audio_device_es8311->set_volume(args.volume);
+  SendMcpResult(event.id, true);
+}
+
+constexpr auto kSetVolumeTool = MakeMcpTool<SetVolumeArgs>("self.audio_speaker.set_volume",
+                                                           "Set the volume of the audio speaker.",
+                                                           McpInt("volume", &SetVolumeArgs::volume, 0, 100));
+
+void HandleGetVolume(const ai_vox::McpToolCallEvent& event, const McpNoArgs&) {
+  const auto volume = g_audio_device_es8311->volume();
+  DLOGI("on mcp tool call: self.audio_speaker.get_volume, volume: %" PRIu16 "\n", volume);
+  SendMcpResult(event.id, static_cast<int64_t>(volume));
+}
+
+constexpr auto kGetVolumeTool = MakeMcpTool("self.audio_speaker.get_volume", "Get the volume of the audio speaker.");
+
+struct LedSetArgs {
+  bool state = false;
+};
+
+void HandleLedSet(const ai_vox::McpToolCallEvent& event, const LedSetArgs& args) {
+  DLOGI("on mcp tool call: self.led.set, state: %d\n", args.state);
+  if (args.state) {
+    digitalWrite(1, HIGH);
+  } else {
+    digitalWrite(1, LOW);
+  }
+  g_led_on = args.state;
+  SendMcpResult(event.id, true);
+}
+
+constexpr auto kLedSetTool = MakeMcpTool<LedSetArgs>("self.led.set",
+                                                     "Set the state of the LED, true for on, false for off.",
+                                                     McpBool("state", &LedSetArgs::state));
+
+void HandleLedGet(const ai_vox::McpToolCallEvent& event, const McpNoArgs&) {
+  const auto state = digitalRead(1);
+  DLOGI("on mcp tool call: self.led.get, state: %d\n", state);
+  SendMcpResult(event.id, static_cast<int64_t>(state));
+}
+
+constexpr auto kLedGetTool = MakeMcpTool("self.led.get", "Get the state of the LED, true for on, false for off.");
+
+struct LedStripSetEffectArgs {
+  std::string effect;
+  int64_t color = 0;
+  int64_t period_ms = 0;
+  std::optional<int64_t> brightness;  // 未提供时保持当前亮度
+};
+
+void HandleLedStripSetEffect(const ai_vox::McpToolCallEvent& event, const LedStripSetEffectArgs& args) {
+  static const std::unordered_map<std::string_view, LedEffects::Mode> kModes = {
+      {"off", LedEffects::Mode::kOff},
+      {"solid", LedEffects::Mode::kSolid},
+      {"blink", LedEffects::Mode::kBlink},
+      {"breathe", LedEffects::Mode::kBreathe},
+      {"chase", LedEffects::Mode::kChase},
+      {"rainbow", LedEffects::Mode::kRainbow},
+  };
+  DLOGI("on mcp tool call: self.led_strip.set_effect, effect: %s\n", args.effect.c_str());
+
+  if (args.brightness) {
+    g_led_effects->SetBrightness(static_cast<uint8_t>(*args.brightness * 255 / 100));
+  }
+
+  if (args.effect == "auto") {
+    g_led_effect_manual = false;
+    g_led_effects->SetEffect(LedEffectForState(g_chat_state));
+    SendMcpResult(event.id, true);
+    return;
+  }
+
+  const auto it = kModes.find(args.effect);
+  if (it == kModes.end()) {
+    SendMcpError(event.id, "Invalid argument: effect");
+    return;
+  }
+  LedEffects::Effect effect;
+  effect.mode = it->second;
+  effect.color = static_cast<uint32_t>(args.color);
+  effect.period_ms = static_cast<uint32_t>(args.period_ms);
+  g_led_effect_manual = true;
+  g_led_effects->SetEffect(effect);
+  SendMcpResult(event.id, true);
+}
+
+constexpr auto kLedStripSetEffectTool = MakeMcpTool<LedStripSetEffectArgs>(
+    "self.led_strip.set_effect",
+    "Set the animation effect of the RGB LED strip. "
+    "effect: off, solid, blink, breathe, chase, rainbow, or auto to follow the chat state. "
+    "color is 0xRRGGBB, period_ms is the animation period, brightness is 0-100.",
+    McpString("effect", &LedStripSetEffectArgs::effect),
+    McpInt("color", &LedStripSetEffectArgs::color, 0, 0xFFFFFF, 0xFFFFFF),
+    McpInt("period_ms", &LedStripSetEffectArgs::period_ms, 100, 10000, 1000),
+    McpInt("brightness", &LedStripSetEffectArgs::brightness, 0, 100));
+
+void HandleGetMetrics(const ai_vox::McpToolCallEvent& event, const McpNoArgs&) {
+  DLOGI("on mcp tool call: self.system.get_metrics\n");
+  // 指标数量随注册的工具增加，先测量输出大小
+  JsonWriter counter(nullptr, 0);
+  WriteMetricsJson(counter);
+  auto& writer = BeginMcpJsonResponse(counter.required() + kMetricsJsonSlack);
+  WriteMetricsJson(writer);
+  SendMcpJsonResponse(event.id, writer);
+}
+
+constexpr auto kGetMetricsTool =
+    MakeMcpTool("self.system.get_metrics",
+                "Get the runtime health metrics of the device as JSON, including heap usage, "
+                "task stack high-water marks, main loop timing, MCP call counts and errors.");
+
+bool HandleMcpToolCall(const ai_vox::McpToolCallEvent& event);
+
+struct BatchArgs {
+  std::string calls;
+};
+
+void HandleBatch(const ai_vox::McpToolCallEvent& event, const BatchArgs& args) {
+  DLOGI("on mcp tool call: self.batch, calls: %s\n", args.calls);
+  std::string error;
+  if (!RunMcpBatch(event.id, args.calls, HandleMcpToolCall, &error)) {
+    SendMcpError(event.id, ("Invalid argument: calls, " + error).c_str());
+    return;
+  }
+  // 还有子调用未完成时，追踪区间在发送汇总结果时结束；已经发送过时追踪记录已关闭，这里不起作用
+  TraceMcpCallDeferred(event.id);
+}
+
+constexpr auto kBatchTool = MakeMcpTool<BatchArgs>(
+    "self.batch",
+    "Call several tools in one request, e.g. to control multiple devices at once. "
+    "calls is a JSON array of {\"name\": tool name, \"arguments\": {argument name: value}}, at most 8 items. "
+    "Returns {\"results\": [{\"name\", \"ok\", \"result\" or \"error\"}]} in the same order.",
+    McpString("calls", &BatchArgs::calls));
+
+// 写入分发表，同时为该工具创建调用计数，返回false表示覆盖了同名工具
+bool SetMcpTool(const std::string& name, McpTool tool) {
+  tool.call_count = &GetMetric("mcp.calls." + name);
+  return g_mcp_tools.insert_or_assign(name, std::move(tool)).second;
+}
+
+bool SetMcpHandler(const std::string& name, McpHandler handler) {
+  return SetMcpTool(name, McpTool{nullptr, std::move(handler)});
+}
+
+// 将内置工具写入分发表，与用户工具同名时以内置工具为准
+void RegisterBuiltinMcpTool(const McpToolEntry& tool) {
+  if (!SetMcpTool(tool.name, McpTool{tool.invoke, nullptr})) {
+    printf("mcp tool %s is reserved by built-in handler, user handler ignored\n", tool.name);
+  }
 }
 
+// 向引擎声明的内置工具
+constexpr McpToolEntry kBuiltinMcpTools[] = {
+    McpToolEntryOf<kSetVolumeTool, HandleSetVolume>(),
+    McpToolEntryOf<kGetVolumeTool, HandleGetVolume>(),
+    McpToolEntryOf<kLedStripSetEffectTool, HandleLedStripSetEffect>(),
+    McpToolEntryOf<kGetMetricsTool, HandleGetMetrics>(),
+    McpToolEntryOf<kBatchTool, HandleBatch>(),
+};
+
+// 只处理调用、不向引擎声明的内置工具，GPIO1 上的LED默认交给用户工具(见 main.cpp)控制
+constexpr McpToolEntry kUndeclaredBuiltinMcpTools[] = {
+    McpToolEntryOf<kLedSetTool, HandleLedSet>(),
+    McpToolEntryOf<kLedGetTool, HandleLedGet>(),
+};
+
 // ==================== MCP工具注册函数 ====================
 
 void InitMcpTools() {
   auto& engine = ai_vox::Engine::GetInstance();
   
-  engine.AddMcpTool("self.audio_speaker.set_volume",
-                    "Set the volume of the audio speaker.",
-                    {
-                        {
-                            "volume",
-                            ai_vox::ParamSchema<int64_t>{
-                                .default_value = std::nullopt,
-                                .min = 0,
-                                .max = 100,
-                            },
-                        },
-                    });
-
-  engine.AddMcpTool("self.audio_speaker.get_volume",
-                    "Get the volume of the audio speaker.",
-                    {});
-
-//   engine.AddMcpTool("self.led.set",
-//                     "Set the state of the LED, true for on, false for off.",
-//                     {
-//                         {
-//                             "state",
-//                             ai_vox::ParamSchema<bool>{
-//                                 .default_value = std::nullopt,
-//                             },
-//                         },
-//                     });
-
-//   engine.AddMcpTool("self.led.get",
-//                     "Get the state of the LED, true for on, false for off.",
-//                     {});
+  for (const auto& tool : kBuiltinMcpTools) {
+    tool.declare(engine);
+  }
 
   // 调用用户注册的 declarator，使用户可以在 declarator 中调用 engine.AddMcpTool(...)
   for (auto &declarator : g_user_mcp_declarators) {
     declarator(engine);
   }
+
+  // 构建分发表：每次 MCP 调用只需一次哈希查找
+  for (const auto& tool : kBuiltinMcpTools) {
+    RegisterBuiltinMcpTool(tool);
+  }
+  for (const auto& tool : kUndeclaredBuiltinMcpTools) {
+    RegisterBuiltinMcpTool(tool);
+  }
+  g_mcp_tools.rehash(g_mcp_tools.size());
+  printf("mcp tools: %zu handlers\n", g_mcp_tools.size());
 }
 
 // ==================== 内存信息打印函数 ====================
@@ -416,69 +818,233 @@ void PrintMemInfo() {
 }
 #endif
 
-// ==================== 事件处理函数 ====================
+// ==================== 性能信息打印函数 ====================
 
-void HandleMcpToolCall(const ai_vox::McpToolCallEvent& event) {
-  auto& engine = ai_vox::Engine::GetInstance();
+#ifdef PRINT_PERF_INFO_INTERVAL
+void PrintPerfInfo(uint32_t elapsed_ms) {
+  if (elapsed_ms == 0) {
+    return;
+  }
 
-  if ("self.audio_speaker.set_volume" == event.name) {
-    const auto volume_ptr = event.param<int64_t>("volume");
-    if (volume_ptr != nullptr) {
-      printf("on mcp tool call: self.audio_speaker.set_volume, volume: %" PRId64 "\n", *volume_ptr);
-      g_audio_device_es8311->set_volume(*volume_ptr);
-      engine.SendMcpCallResponse(event.id, true);
-    } else {
-      engine.SendMcpCallError(event.id, "Missing valid argument: volume");
-    }
-  } else if ("self.audio_speaker.get_volume" == event.name) {
-    const auto volume = g_audio_device_es8311->volume();
-    printf("on mcp tool call: self.audio_speaker.get_volume, volume: %" PRIu16 "\n", volume);
-    engine.SendMcpCallResponse(event.id, volume);
-  } else if ("self.led.set" == event.name) {
-    const auto state_ptr = event.param<bool>("state");
-    if (state_ptr != nullptr) {
-      printf("on mcp tool call: self.led.set, state: %d\n", *state_ptr);
-      if (*state_ptr) {
-        digitalWrite(1, HIGH);
-      } else {
-        digitalWrite(1, LOW);
-      }
-      ESP_ERROR_CHECK(led_strip_refresh(g_led_strip));
-      g_led_on = *state_ptr;
-      engine.SendMcpCallResponse(event.id, true);
-    } else {
-      engine.SendMcpCallError(event.id, "Missing valid argument: state");
-    }
-  } else if ("self.led.get" == event.name) {
-    printf("on mcp tool call: self.led.get, state: %d\n", digitalRead(1));
-    engine.SendMcpCallResponse(event.id, digitalRead(1));
+  printf("main loop: %" PRIu32 " iterations/s, %" PRIu32 " events/s\n",
+         g_perf_stats.loop_count * 1000 / elapsed_ms, g_perf_stats.event_count * 1000 / elapsed_ms);
+  printf("main loop: idle %" PRIu32 "%%, max wake delay %" PRIu32 " ms\n",
+         g_perf_stats.idle_ms * 100 / elapsed_ms, g_perf_stats.max_wake_delay_ms);
+
+  if (g_perf_stats.mcp_call_count > 0) {
+    printf("mcp dispatch: %zu tools, %" PRIu32 " calls, avg %" PRId64 " us, max %" PRId64 " us\n",
+           g_mcp_tools.size(), g_perf_stats.mcp_call_count,
+           g_perf_stats.mcp_dispatch_total_us / g_perf_stats.mcp_call_count, g_perf_stats.mcp_dispatch_max_us);
+  }
+
+  const auto prompt_stats = g_prompt_player->TakeStats();
+  if (prompt_stats.decode_time_us > 0) {
+    printf("mp3 decode: %zu samples in %" PRId64 " us, %" PRId64 " samples/s, first sample after %" PRId64 " us\n",
+           prompt_stats.decoded_samples, prompt_stats.decode_time_us,
+           static_cast<int64_t>(prompt_stats.decoded_samples) * 1000000 / prompt_stats.decode_time_us,
+           prompt_stats.last_first_sample_us);
   }
 
-  // 用户注册的 handler（用户在 main.cpp 中通过 RegisterUserMcpHandler 注册）
-  auto it = g_user_mcp_handlers.find(event.name);
-  if (it != g_user_mcp_handlers.end()) {
-    it->second(event);
+  printf("display: %" PRIu32 " updates, %" PRIu32 " redraws avoided\n",
+         g_display_state.update_count, g_display_state.redraws_avoided);
+
+  PrintLatencyHistograms();
+
+  g_perf_stats = PerfStats();
+}
+#endif
+
+// ==================== 显示更新合并函数 ====================
+
+void MarkDisplayDirty(uint8_t flag) {
+  g_display_state.update_count++;
+  if (g_display_state.dirty & flag) {
+    g_display_state.redraws_avoided++;
+  }
+  g_display_state.dirty |= flag;
+}
+
+void UpdateStatus(const char* status) {
+  g_display_state.status = status;
+  MarkDisplayDirty(DisplayState::kStatusDirty);
+}
+
+void UpdateEmotion(const std::string& emotion) {
+  g_display_state.emotion = emotion;
+  MarkDisplayDirty(DisplayState::kEmotionDirty);
+}
+
+void UpdateChatMessage(Display::Role role, const std::string& content) {
+  g_display_state.chat_role = role;
+  g_display_state.chat_message = content;
+  MarkDisplayDirty(DisplayState::kChatMessageDirty);
+}
+
+// 距离下一次允许刷新显示屏的时间(毫秒)，没有待刷新内容时返回 UINT32_MAX
+uint32_t DisplayFlushDelay() {
+  if (g_display_state.dirty == 0) {
+    return UINT32_MAX;
+  }
+  const uint32_t elapsed = millis() - g_display_state.last_flush_time;
+  return elapsed >= kDisplayFrameIntervalMs ? 0 : kDisplayFrameIntervalMs - elapsed;
+}
+
+// 总是把完整的消息交给显示库，由它排版和绘制；这里只统计调用的实际耗时
+void ShowChatMessage(Display::Role role, const std::string& message) {
+  const auto start_us = esp_timer_get_time();
+  g_display->SetChatMessage(role, message);
+  const auto elapsed_us = esp_timer_get_time() - start_us;
+  g_display_state.chat_message_count++;
+  g_display_state.chat_message_total_us += elapsed_us;
+  g_display_state.chat_message_max_us = std::max(g_display_state.chat_message_max_us, elapsed_us);
+}
+
+void FlushDisplay() {
+  if (DisplayFlushDelay() != 0) {
     return;
   }
+
+  if (g_display_state.dirty & DisplayState::kStatusDirty) {
+    g_display->ShowStatus(g_display_state.status);
+  }
+  if (g_display_state.dirty & DisplayState::kEmotionDirty) {
+    g_display->SetEmotion(g_display_state.emotion);
+  }
+  if (g_display_state.dirty & DisplayState::kChatMessageDirty) {
+    ShowChatMessage(g_display_state.chat_role, g_display_state.chat_message);
+  }
+  g_display_state.dirty = 0;
+  g_display_state.last_flush_time = millis();
+}
+
+// ==================== 事件处理函数 ====================
+
+// 首次进入待命状态时记录上电到可对话的耗时，作为启动速度指标
+void ReportBootToStandby() {
+  static bool s_reported = false;
+  if (s_reported) {
+    return;
+  }
+  s_reported = true;
+  const auto now_us = esp_timer_get_time();
+  const auto boot_ms = static_cast<uint32_t>(now_us / 1000);
+  // 引擎启动到待命主要是OTA/激活请求和WebSocket连接的耗时
+  const auto engine_ms = static_cast<uint32_t>((now_us - g_engine_start_time_us) / 1000);
+  DLOGI("boot to standby: %" PRIu32 " ms, engine start to standby: %" PRIu32 " ms\n", boot_ms, engine_ms);
+  GetMetric("boot.to_standby_ms").Set(boot_ms);
+  GetMetric("engine.start_to_standby_ms").Set(engine_ms);
+}
+
+bool HandleMcpToolCall(const ai_vox::McpToolCallEvent& event) {
+  const auto it = g_mcp_tools.find(std::string_view(event.name));
+  if (it == g_mcp_tools.end()) {
+    DLOGW("on mcp tool call: no handler for %s\n", event.name);
+    g_main_loop_metrics.mcp_errors->Add();
+    TraceInstant("McpCallUnknownTool");
+    return false;
+  }
+  it->second.call_count->Add();
+  // 分发表的键在运行期间不会被释放，可直接作为追踪记录的名称
+  TraceMcpCallStart(event.id, it->first.c_str());
+  if (it->second.invoke != nullptr) {
+    it->second.invoke(event);
+  } else {
+    it->second.handler(event);
+  }
+  TraceMcpCallReturned(event.id);
+  return true;
 }
 
+// ==================== 运行时指标注册 ====================
+
+// 需在主循环所在任务(即 setup() 所在任务)中调用
+void InitMetrics() {
+  g_main_loop_metrics.iterations = &GetMetric("main_loop.iterations");
+  g_main_loop_metrics.events = &GetMetric("main_loop.events");
+  g_main_loop_metrics.busy_us_last = &GetMetric("main_loop.busy_us_last");
+  g_main_loop_metrics.busy_us_max = &GetMetric("main_loop.busy_us_max");
+  g_main_loop_metrics.mcp_errors = &GetMetric("mcp.errors");
+  RegisterMetricGauge("display.updates", [] { return g_display_state.update_count; });
+  RegisterMetricGauge("display.redraws_avoided", [] { return g_display_state.redraws_avoided; });
+  RegisterMetricGauge("display.chat_message_us_max",
+                      [] { return static_cast<uint32_t>(g_display_state.chat_message_max_us); });
+  RegisterMetricGauge("display.chat_message_us_avg", [] {
+    return g_display_state.chat_message_count == 0
+               ? 0u
+               : static_cast<uint32_t>(g_display_state.chat_message_total_us / g_display_state.chat_message_count);
+  });
+  RegisterMetricTask("main_loop", xTaskGetCurrentTaskHandle());
+  RegisterMetricGauge("loop_arena.high_water", [] { return static_cast<uint32_t>(g_loop_arena->high_water()); });
+  RegisterMetricGauge("loop_arena.overflows", [] { return g_loop_arena->overflows(); });
+}
+
+// 把调用参数格式化为 JSON 写入调试日志，字符串位于本次迭代的临时内存中，不产生堆分配
+const char* FormatMcpToolCall(const ai_vox::McpToolCallEvent& event) {
+  // 延迟日志只保留前 kDeferredLogMaxStringLength 个字符，超出部分不必格式化
+  constexpr size_t kSize = kDeferredLogMaxStringLength + 1;
+  JsonWriter writer(static_cast<char*>(g_loop_arena->Allocate(kSize, 1)), kSize);
+  writer.BeginObject();
+  writer.Field("id", event.id);
+  writer.Field("name", event.name);
+  writer.Key("params").BeginObject();
+  for (const auto& [name, value] : event.params) {
+    writer.Key(name);
+    std::visit([&writer](const auto& param) { writer.Value(param); }, value);
+  }
+  writer.EndObject();
+  writer.EndObject();
+  return writer.c_str();
+}
+
+// 响应已发送(内容已被复制)，之后没有新的分配时立即归还缓冲区，同一次迭代中的多个调用(如 self.batch)复用同一块内存
+void ReleaseMcpResponse(const JsonWriter& writer) {
+  if (&writer == g_mcp_response_allocation.writer && g_loop_arena->used() == g_mcp_response_allocation.end) {
+    g_loop_arena->Rewind(g_mcp_response_allocation.mark);
+    g_mcp_response_allocation = {};
+  }
+}
+
+#ifdef PCM_DSP_BENCHMARK
+// 在每个核心上分别核对PCM处理的向量实现并测量吞吐，结果通过串口打印
+void RunPcmDspBenchmark() {
+  struct Context {
+    TaskHandle_t caller;
+    char label[8];
+  };
+  for (BaseType_t core = 0; core < portNUM_PROCESSORS; core++) {
+    Context context = {xTaskGetCurrentTaskHandle(), {}};
+    snprintf(context.label, sizeof(context.label), "core %d", static_cast<int>(core));
+    xTaskCreatePinnedToCore(
+        [](void* arg) {
+          auto context = static_cast<Context*>(arg);
+          BenchmarkPcmDsp(context->label);
+          xTaskNotifyGive(context->caller);
+          vTaskDelete(nullptr);
+        },
+        "pcm_dsp_bench",
+        4096,
+        &context,
+        1,
+        nullptr,
+        core);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+  }
+}
+#endif
+
 }  // namespace
 
 // ==================== 公共API实现 ====================
 
 void InitializeDevice() {
   Serial.begin(115200);
+  InitMetrics();
+  StartDeferredLog();
   pinMode(1, OUTPUT);
-  
-  // 硬件初始化
-  InitLed();
-  InitI2cBus();
-  InitDisplay();
-  InitEs8311();
-  InitButton();
-
-  // 检查SPIRAM
+
+  // 检查SPIRAM。在启动各阶段之前检查，缺少PSRAM时只初始化显示屏用于提示
   if (heap_caps_get_total_size(MALLOC_CAP_SPIRAM) == 0) {
+    InitDisplay();
     g_display->SetChatMessage(Display::Role::kSystem, "No SPIRAM available, please check your board.");
     while (true) {
       printf("No SPIRAM available, please check your board.\n");
@@ -486,23 +1052,63 @@ void InitializeDevice() {
     }
   }
 
-  // WiFi配置
-  g_display->ShowStatus("初始化");
-  ConfigureWifi();
+  // PCM处理的向量实现与标量实现结果不一致时改用标量实现，避免播放出错的音频
+  printf("pcm dsp self test: %s\n", PcmDspSelfTest() ? "bit-exact" : "MISMATCH, using scalar kernels");
+
+  // 硬件初始化、WiFi连接和MCP工具注册按依赖关系并行执行。
+  // 栈大小按各阶段的工作量估计(显示屏阶段包括 LVGL 的初始化，用得最多)，可根据启动时打印的栈使用量调整
+  BootGraph boot_graph;
+  boot_graph.Add("led", InitLed, {}, 3072);
+  const auto i2c = boot_graph.Add("i2c", InitI2cBus, {}, 3072);
+  boot_graph.Add(
+      "display",
+      [] {
+        InitDisplay();
+        g_display->ShowStatus("初始化");
+      },
+      {}, 6144);
+  boot_graph.Add("es8311", InitEs8311, {i2c}, 4096);
+  const auto button = boot_graph.Add("button", InitButton, {}, 3072);
+  boot_graph.Add("wifi_start", StartWifi, {button}, 4096);
+  // 只写入引擎的工具声明和分发表，二者都在全部阶段完成、引擎启动之后才被读取，
+  // 工具处理函数使用的硬件对象也只在调用时访问，因此不依赖其它阶段
+  boot_graph.Add("mcp_tools", InitMcpTools, {}, 4096);
+  boot_graph.Add("sensor_sampler", StartSensorSampler, {}, 3072);
+  boot_graph.Run();
+
+#ifdef PCM_DSP_BENCHMARK
+  RunPcmDspBenchmark();
+#endif
+
+  g_loop_arena = std::make_unique<Arena>(kLoopArenaSize, MALLOC_CAP_SPIRAM);
+
+#ifdef PROMPT_ASSET_PACK
+  // 提示音只在资源包中，缺少资源包或其中的提示音时停在这里，而不是在没有提示音的情况下继续运行
+  CheckPromptAssets();
+#endif
+
+  // 等待WiFi连接
+  WaitWifiConnected();
+  // 在播放提示音、等待音频输出释放的同时解析服务器域名
+  PrefetchDnsAsync({kOtaUrl, kWebsocketUrl});
 
   // AI引擎初始化
-  InitMcpTools();
+  StartMcpAsyncWorkers();
 
   auto& ai_vox_engine = ai_vox::Engine::GetInstance();
   ai_vox_engine.SetObserver(g_observer);
-  ai_vox_engine.SetOtaUrl("https://api.tenclass.net/xiaozhi/ota/");
-  ai_vox_engine.ConfigWebsocket("wss://api.tenclass.net/xiaozhi/v1/",
+  ai_vox_engine.SetOtaUrl(kOtaUrl);
+  ai_vox_engine.ConfigWebsocket(kWebsocketUrl,
                                 {
                                     {"Authorization", "Bearer test-token"},
                                 });
+  // 音频输出交给AI引擎前，等待提示音播放完成并关闭播放器持有的输出通道和解码器
+  g_prompt_player->Release();
+
   printf("engine starting\n");
   g_display->ShowStatus("AI引擎启动中");
 
+  g_engine_start_time_us = esp_timer_get_time();
   ai_vox_engine.Start(g_audio_device_es8311, g_audio_device_es8311);
 
   printf("engine started\n");
@@ -514,12 +1120,13 @@ void InitializeDevice() {
       nullptr,
       [](void* button_handle, void* usr_data) {
         printf("boot button pressed\n");
+        TraceButtonPress();
         ai_vox::Engine::GetInstance().Advance();
       },
       nullptr));
 }
 
-void ProcessMainLoop() {
+void ProcessMainLoop(uint32_t idle_timeout_ms) {
 #ifdef PRINT_HEAP_INFO_INTERVAL
   static uint32_t s_print_heap_info_time = 0;
   if (s_print_heap_info_time == 0 || millis() - s_print_heap_info_time >= PRINT_HEAP_INFO_INTERVAL) {
@@ -528,76 +1135,151 @@ void ProcessMainLoop() {
   }
 #endif
 
+#ifdef PRINT_PERF_INFO_INTERVAL
+  static uint32_t s_print_perf_info_time = millis();
+  if (millis() - s_print_perf_info_time >= PRINT_PERF_INFO_INTERVAL) {
+    PrintPerfInfo(millis() - s_print_perf_info_time);
+    s_print_perf_info_time = millis();
+  }
+  g_perf_stats.loop_count++;
+#endif
+
   auto& engine = ai_vox::Engine::GetInstance();
-  const auto events = g_observer->PopEvents();
+  // 上一次迭代中分配的临时内存全部回收
+  g_loop_arena->Reset();
+  auto events = g_observer->PopEvents();
+
+  // 没有事件时休眠等待，休眠间隔从1ms开始倍增，最长 kMaxIdleSleepMs；
+  // 有待刷新的显示内容时最多等到下一帧
+  idle_timeout_ms = std::min(idle_timeout_ms, DisplayFlushDelay());
+  const auto wait_start_time = millis();
+  uint32_t idle_sleep_ms = 1;
+  while (events.empty() && millis() - wait_start_time < idle_timeout_ms) {
+    const uint32_t sleep_ms = std::min({idle_sleep_ms, kMaxIdleSleepMs, idle_timeout_ms - static_cast<uint32_t>(millis() - wait_start_time)});
+    delay(sleep_ms);
+    idle_sleep_ms <<= 1;
+    events = g_observer->PopEvents();
+#ifdef PRINT_PERF_INFO_INTERVAL
+    g_perf_stats.idle_ms += sleep_ms;
+    if (!events.empty() && sleep_ms > g_perf_stats.max_wake_delay_ms) {
+      g_perf_stats.max_wake_delay_ms = sleep_ms;
+    }
+#endif
+  }
+
+  // 只统计处理事件的时间，不含上面的空闲等待
+  const auto busy_start_us = esp_timer_get_time();
+  g_main_loop_metrics.iterations->Add();
+  g_main_loop_metrics.events->Add(events.size());
 
   for (auto& event : events) {
+#ifdef PRINT_PERF_INFO_INTERVAL
+    g_perf_stats.event_count++;
+#endif
     if (auto text_received_event = std::get_if<ai_vox::TextReceivedEvent>(&event)) {
-      printf("on text received: %s\n", text_received_event->content.c_str());
+      DLOGI("on text received: %s\n", text_received_event->content);
+      TraceInstant("TextReceived");
     } 
     else if (auto activation_event = std::get_if<ai_vox::ActivationEvent>(&event)) {
-      printf("activation code: %s, message: %s\n", activation_event->code.c_str(), activation_event->message.c_str());
-      g_display->ShowStatus("激活设备");
-      g_display->SetChatMessage(Display::Role::kSystem, activation_event->message);
+      DLOGI("activation code: %s, message: %s\n", activation_event->code, activation_event->message);
+      TraceInstant("Activation");
+      UpdateStatus("激活设备");
+      UpdateChatMessage(Display::Role::kSystem, activation_event->message);
     } 
     else if (auto state_changed_event = std::get_if<ai_vox::StateChangedEvent>(&event)) {
+      TraceStateChanged(state_changed_event->new_state);
+      g_chat_state = state_changed_event->new_state;
+      if (!g_led_effect_manual) {
+        g_led_effects->SetEffect(LedEffectForState(state_changed_event->new_state));
+      }
       switch (state_changed_event->new_state) {
         case ai_vox::ChatState::kIdle:
-          printf("Idle\n");
+          DLOGI("Idle\n");
           break;
         case ai_vox::ChatState::kInitted:
-          printf("Initted\n");
-          g_display->ShowStatus("初始化完成");
+          DLOGI("Initted\n");
+          UpdateStatus("初始化完成");
           break;
         case ai_vox::ChatState::kLoading:
-          printf("Loading...\n");
-          g_display->ShowStatus("加载协议中");
+          DLOGI("Loading...\n");
+          UpdateStatus("加载协议中");
           break;
         case ai_vox::ChatState::kLoadingFailed:
-          printf("Loading failed, please retry\n");
-          g_display->ShowStatus("加载协议失败，请重试");
+          DLOGI("Loading failed, please retry\n");
+          UpdateStatus("加载协议失败，请重试");
           break;
         case ai_vox::ChatState::kStandby:
-          printf("Standby\n");
-          g_display->ShowStatus("待命");
+          DLOGI("Standby\n");
+          ReportBootToStandby();
+          UpdateStatus("待命");
+#ifdef DUMP_CHROME_TRACE_ON_STANDBY
+          // 一轮对话结束后导出，记录覆盖按键、聆听、说话和其间的MCP调用；串口输出约需1秒，只在待命时进行
+          if (state_changed_event->old_state == ai_vox::ChatState::kListening ||
+              state_changed_event->old_state == ai_vox::ChatState::kSpeaking) {
+            DumpChromeTrace();
+          }
+#endif
           break;
         case ai_vox::ChatState::kConnecting:
-          printf("Connecting...\n");
-          g_display->ShowStatus("连接中...");
+          DLOGI("Connecting...\n");
+          UpdateStatus("连接中...");
           break;
         case ai_vox::ChatState::kListening:
-          printf("Listening...\n");
-          g_display->ShowStatus("聆听中");
+          DLOGI("Listening...\n");
+          UpdateStatus("聆听中");
           break;
         case ai_vox::ChatState::kSpeaking:
-          printf("Speaking...\n");
-          g_display->ShowStatus("说话中");
+          DLOGI("Speaking...\n");
+          UpdateStatus("说话中");
           break;
         default:
           break;
       }
     } 
     else if (auto emotion_event = std::get_if<ai_vox::EmotionEvent>(&event)) {
-      printf("emotion: %s\n", emotion_event->emotion.c_str());
-      g_display->SetEmotion(emotion_event->emotion);
+      DLOGI("emotion: %s\n", emotion_event->emotion);
+      TraceInstant("Emotion");
+      UpdateEmotion(emotion_event->emotion);
     } 
     else if (auto chat_message_event = std::get_if<ai_vox::ChatMessageEvent>(&event)) {
+      TraceChatMessage(chat_message_event->role);
       switch (chat_message_event->role) {
         case ai_vox::ChatRole::kAssistant:
-          printf("role: assistant, content: %s\n", chat_message_event->content.c_str());
-          g_display->SetChatMessage(Display::Role::kAssistant, chat_message_event->content);
+          DLOGI("role: assistant, content: %s\n", chat_message_event->content);
+          UpdateChatMessage(Display::Role::kAssistant, chat_message_event->content);
           break;
         case ai_vox::ChatRole::kUser:
-          printf("role: user, content: %s\n", chat_message_event->content.c_str());
-          g_display->SetChatMessage(Display::Role::kUser, chat_message_event->content);
+          DLOGI("role: user, content: %s\n", chat_message_event->content);
+          UpdateChatMessage(Display::Role::kUser, chat_message_event->content);
           break;
       }
     } 
     else if (auto mcp_tool_call_event = std::get_if<ai_vox::McpToolCallEvent>(&event)) {
-      printf("on mcp tool call: %s\n", mcp_tool_call_event->ToString().c_str());
+      // 完整参数只在调试级别输出，避免每次调用都构造字符串
+      DLOGI("on mcp tool call: %s, id: %" PRId64 "\n", mcp_tool_call_event->name, mcp_tool_call_event->id);
+      DLOGD("on mcp tool call: %s\n", FormatMcpToolCall(*mcp_tool_call_event));
+#ifdef PRINT_PERF_INFO_INTERVAL
+      const auto dispatch_start_us = esp_timer_get_time();
+#endif
       HandleMcpToolCall(*mcp_tool_call_event);
+#ifdef PRINT_PERF_INFO_INTERVAL
+      const auto dispatch_us = esp_timer_get_time() - dispatch_start_us;
+      g_perf_stats.mcp_call_count++;
+      g_perf_stats.mcp_dispatch_total_us += dispatch_us;
+      if (dispatch_us > g_perf_stats.mcp_dispatch_max_us) {
+        g_perf_stats.mcp_dispatch_max_us = dispatch_us;
+      }
+#endif
     }
   }
+
+  ProcessMcpAsyncCalls();
+  ProcessMcpBatches();
+  FlushDisplay();
+
+  const auto busy_us = static_cast<uint32_t>(esp_timer_get_time() - busy_start_us);
+  g_main_loop_metrics.busy_us_last->Set(busy_us);
+  g_main_loop_metrics.busy_us_max->UpdateMax(busy_us);
 }
 
 // ========== 用户注册 API 实现 ==========
@@ -606,5 +1288,68 @@ void RegisterUserMcpDeclarator(const std::function<void(ai_vox::Engine&)>& decla
 }
 
 void RegisterUserMcpHandler(const std::string& name, const std::function<void(const ai_vox::McpToolCallEvent&)>& handler) {
-  g_user_mcp_handlers[name] = handler;
+  SetMcpHandler(name, handler);
+}
+
+void RegisterUserMcpTool(const McpToolEntry& tool) {
+  g_user_mcp_declarators.push_back(tool.declare);
+  SetMcpTool(tool.name, McpTool{tool.invoke, nullptr});
+}
+
+JsonWriter& BeginMcpJsonResponse() {
+  return BeginMcpJsonResponse(kMcpResponseBufferSize);
+}
+
+JsonWriter& BeginMcpJsonResponse(size_t capacity) {
+  auto& arena = *g_loop_arena;
+  const size_t mark = arena.used();
+  auto writer = arena.New<JsonWriter>(static_cast<char*>(arena.Allocate(capacity, 1)), capacity);
+  g_mcp_response_allocation = {writer, mark, arena.used()};
+  return *writer;
+}
+
+void SendMcpJsonResponse(int64_t id, const JsonWriter& writer) {
+  if (!writer.ok()) {
+    printf("mcp json response %s, %zu bytes written\n", writer.overflow() ? "overflow" : "incomplete", writer.size());
+    SendMcpError(id, "Response too large or malformed");
+    ReleaseMcpResponse(writer);
+    return;
+  }
+  // 直接传递缓冲区指针，不再经过 String/std::string 中转
+  SendMcpJsonResult(id, writer.c_str());
+  ReleaseMcpResponse(writer);
+}
+
+Arena& LoopArena() {
+  return *g_loop_arena;
+}
+
+void RegisterUserMcpAsyncHandler(const std::string& name,
+                                 const McpAsyncHandler& handler,
+                                 uint32_t timeout_ms,
+                                 uint32_t max_in_flight) {
+  SetMcpHandler(name, MakeMcpAsyncHandler(name, handler, timeout_ms, max_in_flight));
+}
+
+I2cBusManager& GetI2cBusManager() {
+  return *g_i2c_bus_manager;
+}
+
+int AddI2cDevice(const I2cDeviceConfig& config) {
+  const int device = g_i2c_bus_manager->AddDevice(config);
+  const std::string prefix = std::string("i2c.") + config.name;
+  const auto stat = [device](uint32_t I2cDeviceStats::*field) {
+    return [device, field] {
+      I2cDeviceStats stats;
+      g_i2c_bus_manager->GetStats(device, &stats);
+      return stats.*field;
+    };
+  };
+  RegisterMetricGauge(prefix + ".errors", stat(&I2cDeviceStats::errors));
+  RegisterMetricGauge(prefix + ".dropped", stat(&I2cDeviceStats::dropped));
+  RegisterMetricGauge(prefix + ".wait_us_avg", stat(&I2cDeviceStats::wait_us_avg));
+  RegisterMetricGauge(prefix + ".wait_us_max", stat(&I2cDeviceStats::wait_us_max));
+  RegisterMetricGauge(prefix + ".bus_us_avg", stat(&I2cDeviceStats::bus_us_avg));
+  RegisterMetricGauge(prefix + ".bus_us_max", stat(&I2cDeviceStats::bus_us_max));
+  return device;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 /**
  * @file ai_vox3_device.h
  * @brief AI VOX3 设备初始化和事件处理接口
@@ -11,14 +13,23 @@
  * @brief 初始化AI VOX3设备的所有硬件和软件组件
  * 
  * 包括:
- * - I2C总线初始化
+ * - I2C总线和总线事务队列(i2c_bus_manager.h)初始化
  * - LED驱动初始化
  * - 显示屏初始化
  * - 音频设备(ES8311)初始化
  * - 按钮初始化
  * - WiFi配置
  * - MCP工具注册
+ * - 传感器后台采样任务启动
  * - AI引擎初始化和启动
+ *
+ * 互不依赖的步骤(如WiFi连接与显示屏、音频芯片初始化)并行执行，完成后打印各阶段耗时；
+ * 首次进入待命状态时打印上电到待命的总耗时。
+ * 启动时核对PCM处理的向量实现与标量实现，结果不一致时打印错误并改用标量实现；
+ * 定义 PCM_DSP_BENCHMARK 宏时，另外在两个核心上重复核对并打印吞吐。
+ * 定义 PROMPT_ASSET_PACK 宏时，提示音不再编译进固件，而是从 partitions.csv 中名为 assets 的数据分区里的
+ * 资源包(asset_pack.h)映射读取。资源包的生成和烧录步骤见 tools/asset_pack_tool.cpp；
+ * 分区中没有有效的资源包时，启动时停止并在串口和显示屏上提示。
  */
 void InitializeDevice();
 
@@ -30,23 +41,77 @@ void InitializeDevice();
  * - 处理MCP工具调用(音量控制、LED控制)
  * - 更新显示屏
  * - 可选的内存信息打印(当PRINT_HEAP_INFO_INTERVAL宏定义时)
+ * - 可选的性能统计打印(当PRINT_PERF_INFO_INTERVAL宏定义时)，包括主循环事件吞吐、
+ *   MCP调用分发耗时、MP3解码吞吐、空闲等待占比和对话延迟直方图
+ * - 记录各事件的时间戳，定义 DUMP_CHROME_TRACE_ON_STANDBY 宏时，每轮对话结束回到待命状态后
+ *   调用 latency_trace.h 中的 DumpChromeTrace() 通过串口导出
+ *
+ * @param idle_timeout_ms 没有事件时最多休眠等待的时间(毫秒)，期间以逐步加长的间隔
+ *                        检查新事件，避免 loop() 空转占满CPU；默认0立即返回，与之前的行为相同。
+ *                        main.cpp 传20，空闲时新事件最多晚20毫秒处理
  */
-void ProcessMainLoop();
+void ProcessMainLoop(uint32_t idle_timeout_ms = 0);
 
 // ========== User MCP registration helpers ==========
 #include <functional>
 #include <string>
 
+#include "mcp_async.h"
+
 // 前向声明，避免在头文件中强制包含 ai_vox 头
 namespace ai_vox {
 class Engine;
 struct McpToolCallEvent;
 }
+struct McpToolEntry;
+class JsonWriter;
+class Arena;
+class I2cBusManager;
+struct I2cDeviceConfig;
 
 // 注册一个用户侧的 "MCP 工具声明器"。传入的 lambda 会在 InitMcpTools() 内被调用，
 // 并接收一个 ai_vox::Engine&，用户可在该 lambda 中调用 engine.AddMcpTool(...) 来注册工具（包含参数 schema）。
 void RegisterUserMcpDeclarator(const std::function<void(ai_vox::Engine&)>& declarator);
 
 // 注册一个用户侧的 MCP 调用处理器。当收到与 name 匹配的 MCP 调用时，
-// ai_vox3 会调用 handler，handler 负责调用 engine.SendMcpCallResponse/SendMcpCallError（或在 handler 内部完成所需处理）。
+// ai_vox3 会调用 handler，handler 负责调用 mcp_batch.h 中的 SendMcpResult/SendMcpErrorResult 返回结果；
+// 直接调用 engine.SendMcpCallResponse 的工具在 self.batch 批量调用中得到错误；在 handler 返回之后
+// (例如由其它任务)才给出结果的工具需先调用 DeferMcpResult(event.id)。
 void RegisterUserMcpHandler(const std::string& name, const std::function<void(const ai_vox::McpToolCallEvent&)>& handler);
+
+// 注册一个由 mcp_tool.h 中的类型化描述生成的工具，声明和处理只需一次注册：
+//   RegisterUserMcpTool(McpToolEntryOf<kMyTool, HandleMyTool>());
+// 参数 schema 由描述生成，handler 收到已校验的参数结构体，缺少参数或超出范围时自动返回错误。
+void RegisterUserMcpTool(const McpToolEntry& tool);
+
+// 返回一个 JSON 写入器，缓冲区(4KB)从本次主循环迭代的临时内存 LoopArena() 中分配，发送后归还。
+// 只能在同步处理器(RegisterUserMcpHandler/RegisterUserMcpTool)中使用，异步处理器请用 responder.Respond()。
+JsonWriter& BeginMcpJsonResponse();
+
+// 同上，缓冲区大小为 capacity 字节，超出 LoopArena() 剩余空间时从堆上分配，同样在迭代结束后回收。
+JsonWriter& BeginMcpJsonResponse(size_t capacity);
+
+// 将写入器中的 JSON 作为调用结果发送，不产生额外的堆分配；内容超出缓冲区或对象未闭合时发送错误。
+void SendMcpJsonResponse(int64_t id, const JsonWriter& writer);
+
+// 主循环本次迭代的临时内存(PSRAM，32KB)，在下一次迭代开始时整体回收，不在堆上留下碎片。
+// 同步处理器中的临时字符串等可从这里分配(见 arena.h 中的 ArenaString)，不能保存到迭代之后，也不能在其它任务中使用。
+Arena& LoopArena();
+
+// 注册一个异步执行的 MCP 调用处理器，适合读取DHT11、超声波测距、舵机转动等耗时操作。
+// handler 在另一个核心上的工作任务中执行，不会阻塞主循环；通过 responder.Respond()/Error() 返回结果，
+// 由主循环统一发送响应。timeout_ms 为0表示不限时，超时后自动返回错误；max_in_flight 限制该工具同时执行的调用数。
+void RegisterUserMcpAsyncHandler(const std::string& name,
+                                 const McpAsyncHandler& handler,
+                                 uint32_t timeout_ms = 0,
+                                 uint32_t max_in_flight = 1);
+
+// ========== 共享 I2C 总线 ==========
+
+// 返回共享 I2C 总线(SCL 12, SDA 13)的事务队列，InitializeDevice() 之后可用。
+// 外接传感器和驱动板通过它异步读写，按设备优先级排队，相邻的寄存器读取自动合并，见 i2c_bus_manager.h。
+I2cBusManager& GetI2cBusManager();
+
+// 在总线管理器中添加设备，并把该设备的排队等待时间、总线占用时间、错误数加入性能指标(i2c.<name>.*)。
+// 返回的设备编号用于 GetI2cBusManager() 的读写函数，InitializeDevice() 之后调用。
+int AddI2cDevice(const I2cDeviceConfig& config);
@@ -0,0 +1,88 @@
+#include "arduino_wifi_fast_connect_driver.h"
+
+#include <Arduino.h>
+#include <esp_wifi.h>
+
+#include <cstring>
+
+namespace {
+
+constexpr uint32_t kConnectPollIntervalMs = 10;
+
+// esp_wifi 配置中的字符串占满数组时没有结尾的'\0'
+template <size_t kDestSize, size_t kSrcSize>
+void CopyConfigString(char (&dest)[kDestSize], const uint8_t (&src)[kSrcSize]) {
+  static_assert(kDestSize > kSrcSize);
+  memcpy(dest, src, kSrcSize);
+  dest[kSrcSize] = '\0';
+}
+
+}  // namespace
+
+ArduinoWifiFastConnectDriver::ArduinoWifiFastConnectDriver(WiFiClass& wifi) : wifi_(wifi) {
+}
+
+bool ArduinoWifiFastConnectDriver::GetSavedCredentials(WifiCredentials& credentials) {
+  // 读取配置前需要先初始化WiFi驱动
+  wifi_.mode(WIFI_STA);
+  wifi_config_t config = {};
+  if (esp_wifi_get_config(WIFI_IF_STA, &config) != ESP_OK || config.sta.ssid[0] == '\0') {
+    return false;
+  }
+  CopyConfigString(credentials.ssid, config.sta.ssid);
+  CopyConfigString(credentials.password, config.sta.password);
+  return true;
+}
+
+WifiFastConnectResult ArduinoWifiFastConnectDriver::Connect(const WifiCredentials& credentials,
+                                                            const WifiConnectionInfo& info,
+                                                            bool static_ip,
+                                                            uint32_t timeout_ms) {
+  if (static_ip) {
+    wifi_.config(IPAddress(info.ip), IPAddress(info.gateway), IPAddress(info.subnet), IPAddress(info.dns));
+  }
+
+  // 指定信道和BSSID后驱动不再扫描全部信道
+  wifi_.begin(credentials.ssid, credentials.password, info.channel, info.bssid);
+  const auto start_time = millis();
+  while (true) {
+    switch (wifi_.status()) {
+      case WL_CONNECTED:
+        return WifiFastConnectResult::kConnected;
+      case WL_NO_SSID_AVAIL:
+        return WifiFastConnectResult::kNetworkNotFound;
+      case WL_CONNECT_FAILED:
+        return WifiFastConnectResult::kAuthFailed;
+      default:
+        break;
+    }
+    if (millis() - start_time >= timeout_ms) {
+      return WifiFastConnectResult::kTimeout;
+    }
+    delay(kConnectPollIntervalMs);
+  }
+}
+
+void ArduinoWifiFastConnectDriver::Disconnect() {
+  wifi_.disconnect();
+  // 全0的地址表示恢复DHCP
+  wifi_.config(IPAddress(), IPAddress(), IPAddress());
+}
+
+bool ArduinoWifiFastConnectDriver::GetConnectionInfo(WifiConnectionInfo& info) {
+  if (wifi_.status() != WL_CONNECTED) {
+    return false;
+  }
+
+  info = WifiConnectionInfo();
+  const uint8_t* bssid = wifi_.BSSID();
+  if (bssid != nullptr) {
+    memcpy(info.bssid, bssid, sizeof(info.bssid));
+  }
+  info.channel = static_cast<uint8_t>(wifi_.channel());
+  info.ip = wifi_.localIP();
+  info.gateway = wifi_.gatewayIP();
+  info.subnet = wifi_.subnetMask();
+  info.dns = wifi_.dnsIP(0);
+  return true;
+}
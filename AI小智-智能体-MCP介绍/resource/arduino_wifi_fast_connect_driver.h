@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef _ARDUINO_WIFI_FAST_CONNECT_DRIVER_H_
+#define _ARDUINO_WIFI_FAST_CONNECT_DRIVER_H_
+
+#include <WiFi.h>
+
+#include "wifi_fast_connect.h"
+
+/**
+ * @file arduino_wifi_fast_connect_driver.h
+ * @brief 基于 Arduino WiFiClass 的 WifiFastConnectDriver 实现
+ *
+ * 保存的凭据从 esp_wifi 的STA配置读取(arduino-esp32 默认把它保存在WiFi驱动自己的NVS中)，
+ * 连接结果按 WiFi.status() 区分：WL_NO_SSID_AVAIL 为找不到AP，WL_CONNECT_FAILED 为认证失败。
+ */
+class ArduinoWifiFastConnectDriver : public WifiFastConnectDriver {
+ public:
+  explicit ArduinoWifiFastConnectDriver(WiFiClass& wifi);
+
+  bool GetSavedCredentials(WifiCredentials& credentials) override;
+  WifiFastConnectResult Connect(const WifiCredentials& credentials,
+                                const WifiConnectionInfo& info,
+                                bool static_ip,
+                                uint32_t timeout_ms) override;
+  void Disconnect() override;
+  bool GetConnectionInfo(WifiConnectionInfo& info) override;
+
+ private:
+  WiFiClass& wifi_;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#include "arena.h"
+
+#include <esp_heap_caps.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+Arena::Arena(size_t capacity, uint32_t caps) : capacity_(capacity) {
+  block_ = static_cast<uint8_t*>(heap_caps_malloc(capacity, caps));
+  if (block_ == nullptr) {
+    printf("Failed to allocate %zu bytes for arena\n", capacity);
+    abort();
+  }
+}
+
+Arena::~Arena() {
+  Reset();
+  heap_caps_free(block_);
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+  const auto base = reinterpret_cast<uintptr_t>(block_);
+  const size_t offset = ((base + used_ + alignment - 1) & ~(alignment - 1)) - base;
+  if (offset <= capacity_ && size <= capacity_ - offset) {
+    used_ = offset + size;
+    high_water_ = std::max(high_water_, used_);
+    return block_ + offset;
+  }
+
+  // 块已用完，从堆上分配，链表头放在分配的内存之前
+  overflows_++;
+  const size_t align = std::max(alignment, alignof(std::max_align_t));
+  const size_t header = (sizeof(OverflowBlock) + align - 1) & ~(align - 1);
+  auto memory = static_cast<uint8_t*>(aligned_alloc(align, (header + size + align - 1) & ~(align - 1)));
+  if (memory == nullptr) {
+    printf("Failed to allocate %zu bytes for arena overflow\n", size);
+    abort();
+  }
+  auto block = reinterpret_cast<OverflowBlock*>(memory);
+  block->next = overflow_blocks_;
+  overflow_blocks_ = block;
+  return memory + header;
+}
+
+const char* Arena::CopyString(std::string_view value) {
+  auto copy = static_cast<char*>(Allocate(value.size() + 1, 1));
+  memcpy(copy, value.data(), value.size());
+  copy[value.size()] = '\0';
+  return copy;
+}
+
+void Arena::Reset() {
+  while (overflow_blocks_ != nullptr) {
+    auto next = overflow_blocks_->next;
+    free(overflow_blocks_);
+    overflow_blocks_ = next;
+  }
+  used_ = 0;
+}
+
+void Arena::Rewind(size_t mark) {
+  used_ = std::min(used_, mark);
+}
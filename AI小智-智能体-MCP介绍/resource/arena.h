@@ -0,0 +1,156 @@
+#pragma once
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @file arena.h
+ * @brief 按块整体释放的临时内存(bump allocator)
+ *
+ * 从一整块预先分配的内存中顺序分配，不单独释放，Reset() 时一次性回收。
+ * 适合生命周期相同的大量小对象，例如主循环一次迭代中产生的日志字符串和 JSON 响应，
+ * 不会在堆上留下碎片。块用完后改从堆分配，这些溢出的内存同样在 Reset() 时释放。
+ *
+ * 示例：
+ * @code
+ * Arena& arena = LoopArena();
+ * ArenaString text(arena);
+ * text += "temperature: ";
+ * text += std::to_string(25);
+ * @endcode
+ */
+class Arena {
+ public:
+  /**
+   * @param capacity 块大小(字节)
+   * @param caps 块的内存类型，如 MALLOC_CAP_SPIRAM
+   */
+  Arena(size_t capacity, uint32_t caps);
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief 分配 size 字节，内存不足时终止程序，不会返回 nullptr
+   */
+  void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+  /**
+   * @brief 在 arena 中构造对象，只能用于可平凡析构的类型(Reset() 不会调用析构函数)
+   */
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    static_assert(std::is_trivially_destructible_v<T>, "Arena does not run destructors");
+    return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * @brief 复制一个字符串，返回以'\0'结尾的副本
+   */
+  const char* CopyString(std::string_view value);
+
+  /**
+   * @brief 回收所有分配，之前返回的指针全部失效
+   */
+  void Reset();
+
+  /**
+   * @brief 回收块内 used() 等于 mark 之后的所有分配，调用者须确保这些内存不再使用
+   *
+   * 用于在 Reset() 之前提前归还一段确定已经用完的临时内存，溢出到堆的分配仍在 Reset() 时释放。
+   */
+  void Rewind(size_t mark);
+
+  size_t capacity() const {
+    return capacity_;
+  }
+
+  size_t used() const {
+    return used_;
+  }
+
+  /**
+   * @brief 块内使用量的历史最大值，用于调整块大小
+   */
+  size_t high_water() const {
+    return high_water_;
+  }
+
+  /**
+   * @brief 块用完后改从堆分配的次数
+   */
+  uint32_t overflows() const {
+    return overflows_;
+  }
+
+ private:
+  struct OverflowBlock {
+    OverflowBlock* next;
+  };
+
+  uint8_t* block_ = nullptr;
+  const size_t capacity_;
+  size_t used_ = 0;
+  size_t high_water_ = 0;
+  uint32_t overflows_ = 0;
+  OverflowBlock* overflow_blocks_ = nullptr;
+};
+
+/**
+ * @brief 从 Arena 分配的标准库分配器，deallocate 为空操作
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  // 允许隐式转换，以便直接写 ArenaString text(arena)
+  ArenaAllocator(Arena& arena) : arena_(&arena) {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) : arena_(other.arena()) {
+  }
+
+  T* allocate(size_t count) {
+    return static_cast<T*>(arena_->Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, size_t) {
+  }
+
+  Arena* arena() const {
+    return arena_;
+  }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  Arena* arena_;
+};
+
+using ArenaString = std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
@@ -0,0 +1,119 @@
+#include "asset_pack.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+uint32_t AssetPackChecksum(const uint8_t* data, size_t size, uint32_t seed) {
+  uint32_t hash = seed;
+  for (size_t i = 0; i < size; i++) {
+    hash = (hash ^ data[i]) * 16777619u;
+  }
+  return hash;
+}
+
+bool AssetPack::Open(const void* data, size_t size) {
+  data_ = nullptr;
+  size_ = 0;
+  entries_ = nullptr;
+  entry_count_ = 0;
+
+  const auto bytes = static_cast<const uint8_t*>(data);
+  // 偏移表直接按结构体读取，要求资源包起始地址对齐(分区映射和文件映射都按页对齐)
+  if (reinterpret_cast<uintptr_t>(bytes) % alignof(AssetPackEntry) != 0) {
+    printf("asset pack: unaligned data\n");
+    return false;
+  }
+  if (size < sizeof(AssetPackHeader)) {
+    printf("asset pack: %zu bytes is too small\n", size);
+    return false;
+  }
+
+  AssetPackHeader header;
+  memcpy(&header, bytes, sizeof(header));
+  if (memcmp(header.magic, kAssetPackMagic, sizeof(kAssetPackMagic)) != 0) {
+    printf("asset pack: bad magic\n");
+    return false;
+  }
+  if (header.version != kAssetPackVersion) {
+    printf("asset pack: unsupported version %u\n", header.version);
+    return false;
+  }
+  // 分区通常比资源包大，只要求资源包完整地落在映射范围内
+  if (header.size > size) {
+    printf("asset pack: size %" PRIu32 " exceeds mapped %zu bytes\n", header.size, size);
+    return false;
+  }
+  const size_t table_end = sizeof(AssetPackHeader) + size_t{header.asset_count} * sizeof(AssetPackEntry);
+  if (table_end > header.size) {
+    printf("asset pack: offset table of %u entries exceeds pack\n", header.asset_count);
+    return false;
+  }
+
+  const auto entries = reinterpret_cast<const AssetPackEntry*>(bytes + sizeof(AssetPackHeader));
+  for (size_t i = 0; i < header.asset_count; i++) {
+    const auto& entry = entries[i];
+    if (i > 0 && entry.id <= entries[i - 1].id) {
+      printf("asset pack: ids not strictly ascending at entry %zu\n", i);
+      return false;
+    }
+    if (entry.offset < table_end || entry.offset > header.size || entry.size > header.size - entry.offset ||
+        entry.offset % kAssetPackAlignment != 0) {
+      printf("asset pack: asset %u has bad range %" PRIu32 "+%" PRIu32 "\n", entry.id, entry.offset, entry.size);
+      return false;
+    }
+    if (entry.encoding == static_cast<uint8_t>(AssetEncoding::kPcm16)) {
+      if (entry.channels == 0 || entry.sample_rate == 0 || entry.size % (entry.channels * sizeof(int16_t)) != 0) {
+        printf("asset pack: asset %u has bad pcm format\n", entry.id);
+        return false;
+      }
+    } else if (entry.encoding != static_cast<uint8_t>(AssetEncoding::kMp3)) {
+      printf("asset pack: asset %u has unknown encoding %u\n", entry.id, entry.encoding);
+      return false;
+    }
+  }
+
+  data_ = bytes;
+  size_ = header.size;
+  entries_ = entries;
+  entry_count_ = header.asset_count;
+  return true;
+}
+
+bool AssetPack::Verify() const {
+  if (data_ == nullptr) {
+    return false;
+  }
+  AssetPackHeader header;
+  memcpy(&header, data_, sizeof(header));
+  const auto checksum = AssetPackChecksum(data_ + sizeof(AssetPackHeader), size_ - sizeof(AssetPackHeader));
+  if (checksum != header.checksum) {
+    printf("asset pack: checksum %08" PRIx32 " does not match header %08" PRIx32 "\n", checksum, header.checksum);
+    return false;
+  }
+  return true;
+}
+
+std::optional<Asset> AssetPack::Find(uint16_t id) const {
+  const auto end = entries_ + entry_count_;
+  const auto it = std::lower_bound(entries_, end, id, [](const AssetPackEntry& entry, uint16_t value) {
+    return entry.id < value;
+  });
+  if (it == end || it->id != id) {
+    return std::nullopt;
+  }
+  return at(it - entries_);
+}
+
+Asset AssetPack::at(size_t index) const {
+  const auto& entry = entries_[index];
+  return Asset{
+      .id = entry.id,
+      .encoding = static_cast<AssetEncoding>(entry.encoding),
+      .channels = entry.channels,
+      .sample_rate = entry.sample_rate,
+      .data = data_ + entry.offset,
+      .size = entry.size,
+  };
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef _ASSET_PACK_H_
+#define _ASSET_PACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+/**
+ * @file asset_pack.h
+ * @brief 只读资源包(提示音等)的格式定义和读取
+ *
+ * 资源包烧录在单独的 flash 分区中，映射到地址空间后直接读取，不复制到内存。
+ * 更换提示音只需重新烧录分区，不必重新编译固件。资源包由 tools/asset_pack_tool.cpp 生成，
+ * 在 Linux 上可用同一个读取实现检查内存映射的文件。
+ *
+ * 格式(小端)：
+ * @code
+ * AssetPackHeader                 16 字节
+ * AssetPackEntry[asset_count]     每项 16 字节，按 id 升序
+ * 资源数据                        每项的起始偏移按 4 字节对齐
+ * @endcode
+ */
+
+enum class AssetEncoding : uint8_t {
+  kMp3 = 0,
+  kPcm16 = 1,  // 16位有符号PCM，多声道时交错存放
+};
+
+struct AssetPackHeader {
+  char magic[4];         // "AVAP"
+  uint16_t version;      // kAssetPackVersion
+  uint16_t asset_count;  // 偏移表的项数
+  uint32_t size;         // 整个资源包的字节数
+  uint32_t checksum;     // 偏移表和资源数据(头部之后的所有字节)的 FNV-1a 校验值
+};
+
+struct AssetPackEntry {
+  uint16_t id;
+  uint8_t encoding;      // AssetEncoding
+  uint8_t channels;      // PCM 的声道数，MP3 为0(由解码器报告)
+  uint32_t sample_rate;  // PCM 的采样率，MP3 为0
+  uint32_t offset;       // 数据相对资源包起始处的偏移
+  uint32_t size;         // 数据的字节数
+};
+
+static_assert(sizeof(AssetPackHeader) == 16, "AssetPackHeader layout");
+static_assert(sizeof(AssetPackEntry) == 16, "AssetPackEntry layout");
+
+constexpr char kAssetPackMagic[4] = {'A', 'V', 'A', 'P'};
+constexpr uint16_t kAssetPackVersion = 1;
+constexpr uint32_t kAssetPackAlignment = 4;
+
+/**
+ * @brief 计算 FNV-1a 校验值，生成资源包时和校验时共用
+ */
+uint32_t AssetPackChecksum(const uint8_t* data, size_t size, uint32_t seed = 2166136261u);
+
+/**
+ * @brief 资源包中的一项资源，data 指向映射的资源包内部
+ */
+struct Asset {
+  uint16_t id;
+  AssetEncoding encoding;
+  uint8_t channels;
+  uint32_t sample_rate;
+  const uint8_t* data;
+  size_t size;
+};
+
+/**
+ * @brief 在一段内存(映射的分区或文件)上读取资源包，本身不持有内存
+ */
+class AssetPack {
+ public:
+  /**
+   * @brief 检查头部和偏移表，不计算校验值
+   *
+   * 只读取头部和偏移表，打开耗时与资源数据的大小无关。格式错误时打印原因并返回false。
+   */
+  bool Open(const void* data, size_t size);
+
+  /**
+   * @brief 计算并核对校验值，需要读取整个资源包
+   */
+  bool Verify() const;
+
+  /**
+   * @brief 按ID查找资源(二分查找)，不存在时返回空
+   */
+  std::optional<Asset> Find(uint16_t id) const;
+
+  /**
+   * @brief 第 index 项资源，按ID升序
+   */
+  Asset at(size_t index) const;
+
+  size_t asset_count() const {
+    return entry_count_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  const AssetPackEntry* entries_ = nullptr;
+  size_t entry_count_ = 0;
+};
+
+#endif
@@ -0,0 +1,84 @@
+#include "boot_graph.h"
+
+#include <esp_timer.h>
+#include <freertos/task.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+BootGraph::BootGraph() : done_bits_(xEventGroupCreate()) {
+  if (done_bits_ == nullptr) {
+    printf("Failed to create boot graph event group\n");
+    abort();
+  }
+  stages_.reserve(kMaxStages);
+}
+
+BootGraph::~BootGraph() {
+  vEventGroupDelete(done_bits_);
+}
+
+BootGraph::Stage BootGraph::Add(const char* name,
+                                std::function<void()> function,
+                                std::initializer_list<Stage> dependencies,
+                                uint32_t stack_size,
+                                BaseType_t core) {
+  if (stages_.size() >= kMaxStages) {
+    printf("Too many boot stages, max: %zu\n", kMaxStages);
+    abort();
+  }
+
+  StageInfo stage;
+  stage.graph = this;
+  stage.name = name;
+  stage.function = std::move(function);
+  stage.bit = EventBits_t{1} << stages_.size();
+  stage.stack_size = stack_size;
+  stage.core = core;
+  for (const auto dependency : dependencies) {
+    if (dependency >= stages_.size()) {
+      printf("Boot stage %s depends on an unknown stage\n", name);
+      abort();
+    }
+    stage.dependency_bits |= stages_[dependency].bit;
+  }
+  stages_.push_back(std::move(stage));
+  return stages_.size() - 1;
+}
+
+void BootGraph::StageTask(void* arg) {
+  auto& stage = *static_cast<StageInfo*>(arg);
+  if (stage.dependency_bits != 0) {
+    xEventGroupWaitBits(stage.graph->done_bits_, stage.dependency_bits, pdFALSE, pdTRUE, portMAX_DELAY);
+  }
+  stage.start_us = esp_timer_get_time();
+  stage.function();
+  stage.end_us = esp_timer_get_time();
+  stage.stack_free = uxTaskGetStackHighWaterMark(nullptr);
+  xEventGroupSetBits(stage.graph->done_bits_, stage.bit);
+  vTaskDelete(nullptr);
+}
+
+void BootGraph::Run() {
+  const auto start_us = esp_timer_get_time();
+  EventBits_t all_bits = 0;
+  for (auto& stage : stages_) {
+    all_bits |= stage.bit;
+    // 阶段任务使用与调用者相同的优先级
+    if (xTaskCreatePinnedToCore(StageTask, stage.name, stage.stack_size, &stage, uxTaskPriorityGet(nullptr), nullptr, stage.core) != pdPASS) {
+      printf("Failed to create boot stage task %s\n", stage.name);
+      abort();
+    }
+  }
+  xEventGroupWaitBits(done_bits_, all_bits, pdFALSE, pdTRUE, portMAX_DELAY);
+  const auto end_us = esp_timer_get_time();
+
+  for (const auto& stage : stages_) {
+    printf("boot stage %-14s start +%4" PRId64 " ms, took %4" PRId64 " ms, stack %5" PRIu32 " / %5" PRIu32 " B\n",
+           stage.name, (stage.start_us - start_us) / 1000, (stage.end_us - stage.start_us) / 1000,
+           stage.stack_size - stage.stack_free, stage.stack_size);
+  }
+  printf("boot stages finished in %" PRId64 " ms\n", (end_us - start_us) / 1000);
+}
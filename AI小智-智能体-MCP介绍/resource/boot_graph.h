@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef _BOOT_GRAPH_H_
+#define _BOOT_GRAPH_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+/**
+ * @file boot_graph.h
+ * @brief 按依赖关系并行执行的启动流程
+ *
+ * 每个阶段在独立的任务中运行，依赖的阶段全部完成后才开始执行，
+ * 互不依赖的阶段由两个核心并行执行。Run() 在全部阶段完成后返回，并打印每个阶段的耗时和栈的使用量，
+ * 据此调整各阶段的栈大小。
+ */
+class BootGraph {
+ public:
+  using Stage = size_t;
+
+  // 事件组可用的位数，即最多支持的阶段数
+  static constexpr size_t kMaxStages = 24;
+  static constexpr uint32_t kDefaultStackSize = 4096;
+
+  BootGraph();
+  ~BootGraph();
+
+  /**
+   * @brief 添加一个阶段，只能依赖已经添加的阶段
+   *
+   * @param name 阶段名称，必须是在程序运行期间一直有效的字符串
+   * @param stack_size 阶段任务的栈大小(字节)
+   * @param core 运行该阶段的核心，默认不绑定核心
+   */
+  Stage Add(const char* name,
+            std::function<void()> function,
+            std::initializer_list<Stage> dependencies = {},
+            uint32_t stack_size = kDefaultStackSize,
+            BaseType_t core = tskNO_AFFINITY);
+
+  /**
+   * @brief 执行全部阶段，阻塞直到全部完成
+   */
+  void Run();
+
+ private:
+  struct StageInfo {
+    BootGraph* graph = nullptr;
+    const char* name = nullptr;
+    std::function<void()> function;
+    EventBits_t bit = 0;
+    EventBits_t dependency_bits = 0;
+    uint32_t stack_size = kDefaultStackSize;
+    BaseType_t core = tskNO_AFFINITY;
+    // 阶段结束时栈的历史最小剩余空间
+    uint32_t stack_free = 0;
+    int64_t start_us = 0;
+    int64_t end_us = 0;
+  };
+
+  static void StageTask(void* arg);
+
+  std::vector<StageInfo> stages_;
+  EventGroupHandle_t done_bits_ = nullptr;
+};
+
+#endif
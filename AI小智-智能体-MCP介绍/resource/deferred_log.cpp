@@ -0,0 +1,256 @@
+#include "deferred_log.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+
+#include "metrics.h"
+
+namespace {
+
+constexpr size_t kRingSize = 8192;
+constexpr uint32_t kLogTaskStackSize = 4096;
+constexpr UBaseType_t kLogTaskPriority = 1;
+constexpr uint32_t kLogTaskIntervalMs = 20;
+constexpr size_t kMaxLineLength = 512;
+constexpr size_t kMaxSpecLength = 16;
+
+constexpr uint32_t kCommittedFlag = 1u << 31;
+constexpr uint32_t kPaddingFlag = 1u << 30;
+constexpr uint32_t kSizeMask = 0xFFFF;
+
+// 每条记录以此开头，记录总长度按头部大小对齐，保证环形缓冲区末尾剩余空间总能放下一个头部
+struct RecordHeader {
+  std::atomic<uint32_t> state;
+  const char* format;
+};
+
+static_assert((sizeof(RecordHeader) & (sizeof(RecordHeader) - 1)) == 0, "record header size must be a power of two");
+static_assert(kRingSize % sizeof(RecordHeader) == 0, "ring size must be a multiple of record header size");
+
+alignas(RecordHeader) uint8_t g_ring[kRingSize];
+// 写入位置和读取位置单调递增，取模得到缓冲区内偏移
+std::atomic<uint32_t> g_reserve_pos{0};
+std::atomic<uint32_t> g_read_pos{0};
+std::atomic<uint32_t> g_dropped_count{0};
+TaskHandle_t g_log_task = nullptr;
+// 只在读取端加锁，保证日志任务和 FlushDeferredLog() 不会同时读取
+std::mutex g_drain_mutex;
+
+RecordHeader* HeaderAt(uint32_t pos) {
+  return reinterpret_cast<RecordHeader*>(&g_ring[pos % kRingSize]);
+}
+
+constexpr size_t AlignRecord(size_t size) {
+  return (size + sizeof(RecordHeader) - 1) & ~(sizeof(RecordHeader) - 1);
+}
+
+template <typename T>
+T ReadValue(const uint8_t*& in) {
+  T value;
+  memcpy(&value, in, sizeof(value));
+  in += sizeof(value);
+  return value;
+}
+
+// 把一个参数按格式说明符 spec (如 "%5d"，不含长度修饰符) 追加到 out，整数统一按64位格式化
+void FormatArg(char* out, size_t out_size, size_t& length, const char* spec, char conversion, const uint8_t*& in) {
+  const auto type = static_cast<deferred_log::ArgType>(*in++);
+  char format[kMaxSpecLength + 4];
+  const size_t remaining = out_size - length;
+  int written = 0;
+  switch (type) {
+    case deferred_log::ArgType::kInt:
+    case deferred_log::ArgType::kUint: {
+      const auto value = ReadValue<uint64_t>(in);
+      if (strchr("fFeEgG", conversion) != nullptr) {
+        snprintf(format, sizeof(format), "%s%c", spec, conversion);
+        written = snprintf(out + length, remaining, format,
+                           type == deferred_log::ArgType::kInt ? static_cast<double>(static_cast<int64_t>(value))
+                                                               : static_cast<double>(value));
+      } else if (conversion == 'c') {
+        snprintf(format, sizeof(format), "%sc", spec);
+        written = snprintf(out + length, remaining, format, static_cast<int>(value));
+      } else if (conversion == 's' || conversion == 'p') {
+        written = snprintf(out + length, remaining, "%" PRIu64, value);
+      } else {
+        snprintf(format, sizeof(format), "%sll%c", spec, conversion);
+        written = snprintf(out + length, remaining, format, static_cast<long long>(value));
+      }
+      break;
+    }
+    case deferred_log::ArgType::kDouble: {
+      const auto value = ReadValue<double>(in);
+      snprintf(format, sizeof(format), "%s%c", spec, strchr("fFeEgG", conversion) != nullptr ? conversion : 'g');
+      written = snprintf(out + length, remaining, format, value);
+      break;
+    }
+    case deferred_log::ArgType::kString: {
+      const auto string_length = ReadValue<uint16_t>(in);
+      // 复制的字符串不以'\0'结尾，用精度限制输出长度
+      snprintf(format, sizeof(format), "%s.*s", spec);
+      written = snprintf(out + length, remaining, format, static_cast<int>(string_length), reinterpret_cast<const char*>(in));
+      in += string_length;
+      break;
+    }
+    case deferred_log::ArgType::kPointer: {
+      const auto value = ReadValue<uintptr_t>(in);
+      written = snprintf(out + length, remaining, "%p", reinterpret_cast<void*>(value));
+      break;
+    }
+  }
+
+  if (written > 0) {
+    length = std::min(length + static_cast<size_t>(written), out_size - 1);
+  }
+}
+
+void FormatRecord(const char* format, const uint8_t* in, const uint8_t* end, char* out, size_t out_size) {
+  size_t length = 0;
+  out[0] = '\0';
+  for (const char* p = format; *p != '\0' && length + 1 < out_size; p++) {
+    if (*p != '%') {
+      out[length++] = *p;
+      continue;
+    }
+
+    if (p[1] == '%') {
+      out[length++] = '%';
+      p++;
+      continue;
+    }
+
+    // 解析 %[flags][width][.precision][length]conversion，丢弃长度修饰符
+    char spec[kMaxSpecLength];
+    size_t spec_length = 0;
+    const char* conversion = p + 1;
+    spec[spec_length++] = '%';
+    while (*conversion != '\0' && strchr("diouxXcsfFeEgGp", *conversion) == nullptr) {
+      if (strchr("hljztL", *conversion) == nullptr && spec_length + 1 < sizeof(spec)) {
+        spec[spec_length++] = *conversion;
+      }
+      conversion++;
+    }
+    spec[spec_length] = '\0';
+    if (*conversion == '\0' || in >= end) {
+      break;
+    }
+    out[length] = '\0';
+    FormatArg(out, out_size, length, spec, *conversion, in);
+    p = conversion;
+  }
+  out[length] = '\0';
+}
+
+// 输出已提交的日志，遇到尚未提交的记录时停止
+void Drain() {
+  std::lock_guard<std::mutex> lock(g_drain_mutex);
+  static char line[kMaxLineLength];
+  uint32_t read_pos = g_read_pos.load(std::memory_order_relaxed);
+  while (read_pos != g_reserve_pos.load(std::memory_order_acquire)) {
+    auto header = HeaderAt(read_pos);
+    const auto state = header->state.load(std::memory_order_acquire);
+    if ((state & kCommittedFlag) == 0) {
+      break;
+    }
+
+    const auto size = state & kSizeMask;
+    if ((state & kPaddingFlag) == 0) {
+      const auto payload = reinterpret_cast<const uint8_t*>(header + 1);
+      FormatRecord(header->format, payload, reinterpret_cast<const uint8_t*>(header) + size, line, sizeof(line));
+      fputs(line, stdout);
+    }
+
+    // 记录长度不同，之后的记录头可能落在这条记录的载荷上。把整条记录清零，
+    // 保证 Reserve() 分配出去的空间在 Commit() 之前读起来都是未提交
+    memset(static_cast<void*>(header), 0, size);
+    read_pos += size;
+    g_read_pos.store(read_pos, std::memory_order_release);
+  }
+
+  static uint32_t s_reported_dropped_count = 0;
+  const auto dropped_count = g_dropped_count.load(std::memory_order_relaxed);
+  if (dropped_count != s_reported_dropped_count) {
+    printf("[log] %" PRIu32 " messages dropped\n", dropped_count - s_reported_dropped_count);
+    s_reported_dropped_count = dropped_count;
+  }
+  fflush(stdout);
+}
+
+void LogTask(void*) {
+  while (true) {
+    Drain();
+    vTaskDelay(pdMS_TO_TICKS(kLogTaskIntervalMs));
+  }
+}
+
+}  // namespace
+
+namespace deferred_log {
+
+uint8_t* Reserve(size_t payload_size, void** token) {
+  const size_t record_size = AlignRecord(sizeof(RecordHeader) + payload_size);
+  if (record_size > kSizeMask || record_size > kRingSize / 2) {
+    g_dropped_count.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+
+  // 多个任务可同时写入：通过CAS抢占一段空间；末尾放不下时先用填充记录占满末尾，再从头写入
+  uint32_t pos = g_reserve_pos.load(std::memory_order_relaxed);
+  uint32_t padding = 0;
+  while (true) {
+    const uint32_t contiguous = kRingSize - pos % kRingSize;
+    padding = record_size <= contiguous ? 0 : contiguous;
+    const uint32_t next = pos + padding + record_size;
+    if (next - g_read_pos.load(std::memory_order_acquire) > kRingSize) {
+      g_dropped_count.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    if (g_reserve_pos.compare_exchange_weak(pos, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+      break;
+    }
+  }
+
+  if (padding > 0) {
+    auto padding_header = HeaderAt(pos);
+    padding_header->format = nullptr;
+    padding_header->state.store(kCommittedFlag | kPaddingFlag | padding, std::memory_order_release);
+    pos += padding;
+  }
+
+  auto header = HeaderAt(pos);
+  header->state.store(record_size, std::memory_order_relaxed);
+  *token = header;
+  return reinterpret_cast<uint8_t*>(header + 1);
+}
+
+void Commit(void* token, const char* format) {
+  auto header = static_cast<RecordHeader*>(token);
+  header->format = format;
+  header->state.store(header->state.load(std::memory_order_relaxed) | kCommittedFlag, std::memory_order_release);
+}
+
+}  // namespace deferred_log
+
+void StartDeferredLog() {
+  if (g_log_task != nullptr) {
+    return;
+  }
+  xTaskCreate(LogTask, "deferred_log", kLogTaskStackSize, nullptr, kLogTaskPriority, &g_log_task);
+  RegisterMetricTask("deferred_log", g_log_task);
+  RegisterMetricGauge("log.dropped", DeferredLogDroppedCount);
+}
+
+void FlushDeferredLog() {
+  Drain();
+}
+
+uint32_t DeferredLogDroppedCount() {
+  return g_dropped_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#ifndef _DEFERRED_LOG_H_
+#define _DEFERRED_LOG_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/**
+ * @file deferred_log.h
+ * @brief 延迟格式化的日志
+ *
+ * 热路径上的日志调用只把格式字符串指针和原始参数写入无锁环形缓冲区，
+ * 格式化和串口输出由低优先级的日志任务完成。缓冲区满时丢弃日志并计数。
+ *
+ * 格式字符串必须是字符串常量；字符串参数(const char* / std::string)会被复制，
+ * 超过 kDeferredLogMaxStringLength 的部分被截断。
+ */
+
+#define DLOG_LEVEL_NONE 0
+#define DLOG_LEVEL_ERROR 1
+#define DLOG_LEVEL_WARN 2
+#define DLOG_LEVEL_INFO 3
+#define DLOG_LEVEL_DEBUG 4
+
+// 编译期日志级别，低于该级别的日志调用(包括参数求值)在编译时被移除
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL DLOG_LEVEL_INFO
+#endif
+
+constexpr size_t kDeferredLogMaxStringLength = 192;
+
+/**
+ * @brief 启动日志输出任务，在此之前写入的日志会保留在缓冲区中
+ */
+void StartDeferredLog();
+
+/**
+ * @brief 在当前任务中立即格式化并输出缓冲区中的全部日志
+ */
+void FlushDeferredLog();
+
+/**
+ * @brief 因缓冲区满而被丢弃的日志条数
+ */
+uint32_t DeferredLogDroppedCount();
+
+namespace deferred_log {
+
+enum class ArgType : uint8_t {
+  kInt,
+  kUint,
+  kDouble,
+  kString,
+  kPointer,
+};
+
+// 为一条日志在环形缓冲区中预留空间，失败时返回nullptr
+uint8_t* Reserve(size_t payload_size, void** token);
+void Commit(void* token, const char* format);
+
+inline size_t StringLength(const char* value) {
+  return value == nullptr ? 0 : strnlen(value, kDeferredLogMaxStringLength);
+}
+
+template <typename T>
+inline size_t ArgSize(const T& value) {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, std::string>) {
+    return 1 + sizeof(uint16_t) + std::min(value.size(), kDeferredLogMaxStringLength);
+  } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+    return 1 + sizeof(uint16_t) + StringLength(value);
+  } else if constexpr (std::is_floating_point_v<U>) {
+    return 1 + sizeof(double);
+  } else if constexpr (std::is_pointer_v<U>) {
+    return 1 + sizeof(uintptr_t);
+  } else {
+    static_assert(std::is_integral_v<U> || std::is_enum_v<U>, "unsupported log argument type");
+    return 1 + sizeof(uint64_t);
+  }
+}
+
+inline uint8_t* WriteString(uint8_t* out, const char* value, size_t length) {
+  *out++ = static_cast<uint8_t>(ArgType::kString);
+  const auto length16 = static_cast<uint16_t>(length);
+  memcpy(out, &length16, sizeof(length16));
+  out += sizeof(length16);
+  if (length > 0) {
+    memcpy(out, value, length);
+  }
+  return out + length;
+}
+
+template <typename T>
+inline uint8_t* WriteArg(uint8_t* out, const T& value) {
+  using U = std::decay_t<T>;
+  if constexpr (std::is_same_v<U, std::string>) {
+    return WriteString(out, value.data(), std::min(value.size(), kDeferredLogMaxStringLength));
+  } else if constexpr (std::is_same_v<U, const char*> || std::is_same_v<U, char*>) {
+    return WriteString(out, value, StringLength(value));
+  } else if constexpr (std::is_floating_point_v<U>) {
+    *out++ = static_cast<uint8_t>(ArgType::kDouble);
+    const double number = value;
+    memcpy(out, &number, sizeof(number));
+    return out + sizeof(number);
+  } else if constexpr (std::is_pointer_v<U>) {
+    *out++ = static_cast<uint8_t>(ArgType::kPointer);
+    const auto number = reinterpret_cast<uintptr_t>(value);
+    memcpy(out, &number, sizeof(number));
+    return out + sizeof(number);
+  } else if constexpr (std::is_signed_v<U> || std::is_enum_v<U>) {
+    *out++ = static_cast<uint8_t>(ArgType::kInt);
+    const auto number = static_cast<int64_t>(value);
+    memcpy(out, &number, sizeof(number));
+    return out + sizeof(number);
+  } else {
+    *out++ = static_cast<uint8_t>(ArgType::kUint);
+    const auto number = static_cast<uint64_t>(value);
+    memcpy(out, &number, sizeof(number));
+    return out + sizeof(number);
+  }
+}
+
+template <typename... Args>
+inline void Log(const char* format, const Args&... args) {
+  const size_t payload_size = (size_t{0} + ... + ArgSize(args));
+  void* token = nullptr;
+  uint8_t* out = Reserve(payload_size, &token);
+  if (out == nullptr) {
+    return;
+  }
+  ((out = WriteArg(out, args)), ...);
+  Commit(token, format);
+}
+
+}  // namespace deferred_log
+
+// 被禁用的日志调用仍做类型检查，避免参数变量被报告为未使用，但不会生成代码
+#define DLOG_DISABLED(format, ...)                      \
+  do {                                                  \
+    if (false) {                                        \
+      deferred_log::Log(format, ##__VA_ARGS__);         \
+    }                                                   \
+  } while (0)
+
+#if DLOG_LEVEL >= DLOG_LEVEL_ERROR
+#define DLOGE(format, ...) deferred_log::Log(format, ##__VA_ARGS__)
+#else
+#define DLOGE(format, ...) DLOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_WARN
+#define DLOGW(format, ...) deferred_log::Log(format, ##__VA_ARGS__)
+#else
+#define DLOGW(format, ...) DLOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_INFO
+#define DLOGI(format, ...) deferred_log::Log(format, ##__VA_ARGS__)
+#else
+#define DLOGI(format, ...) DLOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+
+#if DLOG_LEVEL >= DLOG_LEVEL_DEBUG
+#define DLOGD(format, ...) deferred_log::Log(format, ##__VA_ARGS__)
+#else
+#define DLOGD(format, ...) DLOG_DISABLED(format, ##__VA_ARGS__)
+#endif
+
+#endif
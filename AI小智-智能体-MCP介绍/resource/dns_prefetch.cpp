@@ -0,0 +1,55 @@
+#include "dns_prefetch.h"
+
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+constexpr uint32_t kPrefetchTaskStackSize = 4096;
+constexpr UBaseType_t kPrefetchTaskPriority = 1;
+
+std::string HostOf(const std::string& url) {
+  auto begin = url.find("://");
+  begin = begin == std::string::npos ? 0 : begin + 3;
+  const auto end = url.find_first_of(":/", begin);
+  return url.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+}
+
+void PrefetchTask(void* arg) {
+  auto hosts = static_cast<std::vector<std::string>*>(arg);
+  for (const auto& host : *hosts) {
+    const auto start_time = esp_timer_get_time();
+    IPAddress address;
+    if (WiFi.hostByName(host.c_str(), address) == 1) {
+      printf("dns prefetch: %s -> %s in %" PRId64 " ms\n", host.c_str(), address.toString().c_str(),
+             (esp_timer_get_time() - start_time) / 1000);
+    } else {
+      printf("dns prefetch: failed to resolve %s\n", host.c_str());
+    }
+  }
+  delete hosts;
+  vTaskDelete(nullptr);
+}
+
+}  // namespace
+
+void PrefetchDnsAsync(const std::vector<std::string>& urls) {
+  auto hosts = new std::vector<std::string>();
+  for (const auto& url : urls) {
+    auto host = HostOf(url);
+    if (!host.empty() && std::find(hosts->begin(), hosts->end(), host) == hosts->end()) {
+      hosts->push_back(std::move(host));
+    }
+  }
+
+  if (hosts->empty() ||
+      xTaskCreate(PrefetchTask, "dns_prefetch", kPrefetchTaskStackSize, hosts, kPrefetchTaskPriority, nullptr) != pdPASS) {
+    delete hosts;
+  }
+}
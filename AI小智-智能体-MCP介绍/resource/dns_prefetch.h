@@ -0,0 +1,24 @@
+#pragma once
+
+#ifndef _DNS_PREFETCH_H_
+#define _DNS_PREFETCH_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * @file dns_prefetch.h
+ * @brief 在后台预先解析服务器域名
+ *
+ * 解析结果由 lwIP 的 DNS 缓存保存，之后 AI 引擎连接 OTA 和 WebSocket 服务器时直接命中缓存，
+ * 省去一次 DNS 往返。适合在 WiFi 连接成功后、引擎启动前(例如播放提示音期间)调用。
+ */
+
+/**
+ * @brief 启动一个后台任务依次解析各URL中的主机名，重复的主机名只解析一次
+ *
+ * @param urls 形如 "https://host/path" 或 "wss://host:port/path" 的URL
+ */
+void PrefetchDnsAsync(const std::vector<std::string>& urls);
+
+#endif
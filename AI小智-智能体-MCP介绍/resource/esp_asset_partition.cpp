@@ -0,0 +1,42 @@
+#include "esp_asset_partition.h"
+
+#include <cinttypes>
+#include <cstdio>
+
+EspAssetPartition::~EspAssetPartition() {
+  Unmap();
+}
+
+bool EspAssetPartition::Map(const char* label, bool verify) {
+  Unmap();
+
+  const auto partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, label);
+  if (partition == nullptr) {
+    printf("asset partition '%s' not found\n", label);
+    return false;
+  }
+
+  const void* data = nullptr;
+  const auto err = esp_partition_mmap(partition, 0, partition->size, ESP_PARTITION_MMAP_DATA, &data, &mmap_handle_);
+  if (err != ESP_OK) {
+    printf("Failed to mmap asset partition '%s': %d\n", label, err);
+    return false;
+  }
+  mapped_ = true;
+
+  if (!pack_.Open(data, partition->size) || (verify && !pack_.Verify())) {
+    Unmap();
+    return false;
+  }
+  printf("asset partition '%s': %zu assets, %zu of %" PRIu32 " bytes\n", label, pack_.asset_count(), pack_.size(),
+         partition->size);
+  return true;
+}
+
+void EspAssetPartition::Unmap() {
+  pack_ = AssetPack();
+  if (mapped_) {
+    esp_partition_munmap(mmap_handle_);
+    mapped_ = false;
+  }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#ifndef _ESP_ASSET_PARTITION_H_
+#define _ESP_ASSET_PARTITION_H_
+
+#include <esp_partition.h>
+
+#include "asset_pack.h"
+
+/**
+ * @file esp_asset_partition.h
+ * @brief 把 flash 分区中的资源包映射到数据地址空间
+ *
+ * 映射后资源数据经 MMU 和 flash cache 直接读取，不占用内存；映射在对象销毁前一直有效，
+ * 从 pack() 取得的 Asset::data 可以直接交给 PromptPlayer 播放。
+ */
+class EspAssetPartition {
+ public:
+  EspAssetPartition() = default;
+  ~EspAssetPartition();
+
+  EspAssetPartition(const EspAssetPartition&) = delete;
+  EspAssetPartition& operator=(const EspAssetPartition&) = delete;
+
+  /**
+   * @brief 查找名为 label 的数据分区，映射并检查其中的资源包
+   *
+   * @param verify 同时核对校验值，需要读取整个资源包
+   * @return 分区不存在、映射失败或资源包格式错误时返回false
+   */
+  bool Map(const char* label, bool verify);
+
+  const AssetPack& pack() const {
+    return pack_;
+  }
+
+ private:
+  void Unmap();
+
+  esp_partition_mmap_handle_t mmap_handle_ = 0;
+  bool mapped_ = false;
+  AssetPack pack_;
+};
+
+#endif
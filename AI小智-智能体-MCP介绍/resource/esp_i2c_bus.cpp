@@ -0,0 +1,64 @@
+#include "esp_i2c_bus.h"
+
+#include <esp_err.h>
+
+#include <cstdio>
+
+namespace {
+
+constexpr int kTransferTimeoutMs = 100;
+
+}  // namespace
+
+EspI2cBus::EspI2cBus(const i2c_master_bus_config_t& config, uint32_t scl_speed_hz) : scl_speed_hz_(scl_speed_hz) {
+  ESP_ERROR_CHECK(i2c_new_master_bus(&config, &handle_));
+}
+
+EspI2cBus::~EspI2cBus() {
+  for (const auto& device : devices_) {
+    i2c_master_bus_rm_device(device.second);
+  }
+  i2c_del_master_bus(handle_);
+}
+
+bool EspI2cBus::Transfer(uint16_t address, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size) {
+  const auto device = DeviceHandle(address);
+  if (device == nullptr) {
+    return false;
+  }
+  esp_err_t err = ESP_OK;
+  if (read_size == 0) {
+    err = i2c_master_transmit(device, write, write_size, kTransferTimeoutMs);
+  } else if (write_size == 0) {
+    err = i2c_master_receive(device, read, read_size, kTransferTimeoutMs);
+  } else {
+    err = i2c_master_transmit_receive(device, write, write_size, read, read_size, kTransferTimeoutMs);
+  }
+  return err == ESP_OK;
+}
+
+i2c_master_dev_handle_t EspI2cBus::DeviceHandle(uint16_t address) {
+  for (const auto& device : devices_) {
+    if (device.first == address) {
+      return device.second;
+    }
+  }
+
+  const i2c_device_config_t config = {
+      .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+      .device_address = address,
+      .scl_speed_hz = scl_speed_hz_,
+      .scl_wait_us = 0,
+      .flags = {
+          .disable_ack_check = 0,
+      },
+  };
+  i2c_master_dev_handle_t device = nullptr;
+  const auto err = i2c_master_bus_add_device(handle_, &config, &device);
+  if (err != ESP_OK) {
+    printf("Failed to add i2c device 0x%02x: %s\n", address, esp_err_to_name(err));
+    return nullptr;
+  }
+  devices_.emplace_back(address, device);
+  return device;
+}
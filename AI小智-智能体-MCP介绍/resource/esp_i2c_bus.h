@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef _ESP_I2C_BUS_H_
+#define _ESP_I2C_BUS_H_
+
+#include <driver/i2c_master.h>
+
+#include <utility>
+#include <vector>
+
+#include "i2c_bus_manager.h"
+
+/**
+ * @file esp_i2c_bus.h
+ * @brief 基于 ESP-IDF i2c_master 驱动的 I2cBus 实现
+ *
+ * 持有总线句柄，第一次访问某个地址时创建对应的设备句柄。Transfer() 只应由
+ * I2cBusManager 的工作任务调用；需要直接使用总线句柄的驱动(如 ES8311)通过 handle() 获取，
+ * 驱动内部的传输与工作任务的传输由 i2c_master 的总线锁互斥。
+ */
+class EspI2cBus : public I2cBus {
+ public:
+  EspI2cBus(const i2c_master_bus_config_t& config, uint32_t scl_speed_hz);
+  ~EspI2cBus() override;
+
+  i2c_master_bus_handle_t handle() const {
+    return handle_;
+  }
+
+  bool Transfer(uint16_t address, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size) override;
+
+ private:
+  i2c_master_dev_handle_t DeviceHandle(uint16_t address);
+
+  i2c_master_bus_handle_t handle_ = nullptr;
+  const uint32_t scl_speed_hz_;
+  std::vector<std::pair<uint16_t, i2c_master_dev_handle_t>> devices_;
+};
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @file host_benchmark.cpp
+ * @brief 在主机上运行固件代码的基准测试
+ *
+ * 硬件由 host/fakes 模拟，结果只用于比较改动前后的相对开销，不代表设备上的绝对耗时。
+ * 结果输出到 stderr，设备日志和 BenchmarkPcmDsp() 的结果输出到 stdout。
+ */
+
+#include <Arduino.h>
+#include <audio_device/audio_device_es8311.h>
+#include <esp_timer.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ai_vox3_device.h"
+#include "ai_vox_engine.h"
+#include "host_fakes.h"
+#include "json_writer.h"
+#include "mcp_batch.h"
+#include "pcm_dsp.h"
+#include "prompt_player.h"
+
+namespace {
+
+constexpr int kEventsPerIteration = 64;
+
+void Report(const char* name, double value, const char* unit) {
+  fprintf(stderr, "%-50s %14.3f %s\n", name, value, unit);
+}
+
+ai_vox::Engine& engine() {
+  return ai_vox::Engine::GetInstance();
+}
+
+// ==================== 提示音解码 ====================
+
+// 主机上的解码器是模拟的，这里测量的是解码之外的流水线(格式转换、增益、队列和写入)
+void BenchmarkPromptDecode() {
+  auto audio_device = std::make_shared<ai_vox::AudioDeviceEs8311>(nullptr, 0, I2C_NUM_0, 16000, GPIO_NUM_NC,
+                                                                  GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC);
+  // 与固件一样不销毁，后台任务一直存在
+  auto player = new PromptPlayer(audio_device, 16000);
+
+  std::vector<uint8_t> mp3(144 * 2000, 0xff);
+  const auto start_us = esp_timer_get_time();
+  player->Enqueue(mp3.data(), mp3.size());
+  player->WaitIdle();
+  const auto elapsed_us = esp_timer_get_time() - start_us;
+  const auto stats = player->TakeStats();
+  Report("prompt mp3 pipeline: samples/sec", stats.decoded_samples * 1e6 / elapsed_us, "samples/s");
+
+  // 24kHz 双声道 PCM 提示音，经过降混和重采样
+  std::vector<int16_t> pcm(24000 * 2 * 10);
+  for (size_t i = 0; i < pcm.size(); i++) {
+    pcm[i] = static_cast<int16_t>(i * 37);
+  }
+  const auto pcm_start_us = esp_timer_get_time();
+  player->EnqueuePcm(pcm.data(), pcm.size(), 24000, 2);
+  player->WaitIdle();
+  const auto pcm_elapsed_us = esp_timer_get_time() - pcm_start_us;
+  Report("prompt pcm 24k stereo -> 16k mono: samples/sec", pcm.size() * 1e6 / pcm_elapsed_us, "samples/s");
+  player->Release();
+}
+
+// ==================== 主循环 ====================
+
+void BenchmarkMainLoop() {
+  constexpr int kEvents = 200000;
+  auto observer = engine().observer();
+  const auto before = host::GetAllocationStats();
+  const auto start_us = esp_timer_get_time();
+  for (int i = 0; i < kEvents; i += kEventsPerIteration) {
+    for (int j = 0; j < kEventsPerIteration; j++) {
+      if (j % 2 == 0) {
+        observer->Push(ai_vox::StateChangedEvent{ai_vox::ChatState::kListening, ai_vox::ChatState::kSpeaking});
+      } else {
+        observer->Push(ai_vox::EmotionEvent{"happy"});
+      }
+    }
+    ProcessMainLoop(0);
+  }
+  const auto elapsed_us = esp_timer_get_time() - start_us;
+  const auto after = host::GetAllocationStats();
+  Report("main loop: events/sec (state + emotion)", kEvents * 1e6 / elapsed_us, "events/s");
+  // 包括测试注入事件时的分配
+  Report("main loop: heap allocations per event", static_cast<double>(after.allocations - before.allocations) / kEvents,
+         "allocs");
+}
+
+// ==================== MCP 分发 ====================
+
+// 每次调用的耗时包括分摊到每个事件的主循环开销，应与工具数量无关
+void BenchmarkMcpDispatch() {
+  constexpr int kCalls = 100000;
+  int registered = 0;
+  for (const int tools : {16, 64, 256, 1024}) {
+    for (; registered < tools; registered++) {
+      RegisterUserMcpHandler("bench.tool_" + std::to_string(registered),
+                             [](const ai_vox::McpToolCallEvent& event) { SendMcpResult(event.id, true); });
+    }
+
+    auto observer = engine().observer();
+    std::vector<ai_vox::McpToolCallEvent> calls;
+    for (int i = 0; i < kEventsPerIteration; i++) {
+      calls.push_back({i, "bench.tool_" + std::to_string(i * 7919 % tools), {}});
+    }
+    int64_t elapsed_us = 0;
+    for (int i = 0; i < kCalls; i += kEventsPerIteration) {
+      for (const auto& call : calls) {
+        observer->Push(call);
+      }
+      const auto start_us = esp_timer_get_time();
+      ProcessMainLoop(0);
+      elapsed_us += esp_timer_get_time() - start_us;
+      engine().TakeMcpResponses();
+    }
+    char name[64];
+    snprintf(name, sizeof(name), "mcp dispatch: %4d tools, per call", tools);
+    Report(name, elapsed_us * 1000.0 / kCalls, "ns");
+  }
+}
+
+// ==================== JSON 响应 ====================
+
+constexpr int kMetricFields = 40;
+
+// 与指标名一样，键在写入前就已存在
+const std::vector<std::string>& MetricKeys() {
+  static const auto keys = [] {
+    std::vector<std::string> keys;
+    for (int i = 0; i < kMetricFields; i++) {
+      keys.push_back("metric.value_" + std::to_string(i));
+    }
+    return keys;
+  }();
+  return keys;
+}
+
+void WriteWithJsonWriter(JsonWriter& writer) {
+  const auto& keys = MetricKeys();
+  writer.Reset();
+  writer.BeginObject();
+  for (int i = 0; i < kMetricFields; i++) {
+    writer.Field(keys[i], static_cast<int64_t>(i) * 1234567);
+  }
+  writer.EndObject();
+}
+
+// 改动之前的写法：String 逐段拼接后再转换为 std::string 交给引擎
+std::string WriteWithString() {
+  const auto& keys = MetricKeys();
+  String json = "{";
+  for (int i = 0; i < kMetricFields; i++) {
+    if (i > 0) {
+      json += ",";
+    }
+    json += String("\"" + keys[i] + "\":");
+    json += String(std::to_string(static_cast<int64_t>(i) * 1234567));
+  }
+  json += "}";
+  return std::string(json.c_str());
+}
+
+void BenchmarkJsonResponse() {
+  constexpr int kDocuments = 20000;
+  static char buffer[4096];
+  JsonWriter writer(buffer, sizeof(buffer));
+  MetricKeys();
+
+  auto before = host::GetAllocationStats();
+  auto start_us = esp_timer_get_time();
+  size_t size = 0;
+  for (int i = 0; i < kDocuments; i++) {
+    WriteWithJsonWriter(writer);
+    size = writer.size();
+  }
+  auto elapsed_us = esp_timer_get_time() - start_us;
+  auto after = host::GetAllocationStats();
+  Report("json JsonWriter: time per response", elapsed_us * 1000.0 / kDocuments, "ns");
+  Report("json JsonWriter: allocations per response",
+         static_cast<double>(after.allocations - before.allocations) / kDocuments, "allocs");
+  Report("json JsonWriter: bytes allocated per response",
+         static_cast<double>(after.bytes - before.bytes) / kDocuments, "bytes");
+
+  before = host::GetAllocationStats();
+  start_us = esp_timer_get_time();
+  for (int i = 0; i < kDocuments; i++) {
+    const auto json = WriteWithString();
+    if (json.size() != size) {
+      fprintf(stderr, "json output differs: %zu vs %zu bytes\n", json.size(), size);
+      return;
+    }
+  }
+  elapsed_us = esp_timer_get_time() - start_us;
+  after = host::GetAllocationStats();
+  Report("json String concat: time per response", elapsed_us * 1000.0 / kDocuments, "ns");
+  Report("json String concat: allocations per response",
+         static_cast<double>(after.allocations - before.allocations) / kDocuments, "allocs");
+  Report("json String concat: bytes allocated per response",
+         static_cast<double>(after.bytes - before.bytes) / kDocuments, "bytes");
+}
+
+}  // namespace
+
+int main() {
+  InitializeDevice();
+
+  BenchmarkMainLoop();
+  BenchmarkMcpDispatch();
+  BenchmarkPromptDecode();
+  if (!BenchmarkPcmDsp("host")) {
+    fprintf(stderr, "pcm dsp results differ from scalar implementation\n");
+  }
+  BenchmarkJsonResponse();
+
+  // 设备的后台任务仍在运行，不执行静态析构
+  fflush(stdout);
+  fflush(stderr);
+  _exit(0);
+}
@@ -0,0 +1,278 @@
+#include <ai_vox_engine.h>
+#include <audio_device/audio_device_es8311.h>
+#include <components/espressif/esp_audio_codec/esp_audio_simple_dec.h>
+#include <components/espressif/esp_audio_codec/esp_mp3_dec.h>
+#include <display.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+constexpr uint32_t kDecoderFrameBytes = 144;
+constexpr uint32_t kDecoderFrameSamples = 576;
+constexpr uint32_t kDecoderSampleRate = 16000;
+
+struct FakeDecoder {
+  uint32_t frames = 0;
+};
+
+// 最近创建的设备和显示对象，固件中它们都只有一个
+std::atomic<ai_vox::AudioDeviceEs8311*> g_audio_device{nullptr};
+std::atomic<Display*> g_display{nullptr};
+
+}  // namespace
+
+// ==================== ai_vox 引擎 ====================
+
+namespace ai_vox {
+
+std::string McpToolCallEvent::ToString() const {
+  std::string text = "id: " + std::to_string(id) + ", name: " + name + ", params: {";
+  for (const auto& [key, value] : params) {
+    if (text.back() != '{') {
+      text += ", ";
+    }
+    text += key + ": ";
+    if (const auto b = std::get_if<bool>(&value)) {
+      text += *b ? "true" : "false";
+    } else if (const auto i = std::get_if<int64_t>(&value)) {
+      text += std::to_string(*i);
+    } else {
+      text += std::get<std::string>(value);
+    }
+  }
+  return text + "}";
+}
+
+std::list<Event> Observer::PopEvents() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::move(events_);
+}
+
+void Observer::Push(Event event) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  events_.push_back(std::move(event));
+}
+
+Engine& Engine::GetInstance() {
+  static auto* engine = new Engine();
+  return *engine;
+}
+
+void Engine::SetObserver(std::shared_ptr<Observer> observer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  observer_ = std::move(observer);
+}
+
+void Engine::SetOtaUrl(const std::string&) {
+}
+
+void Engine::ConfigWebsocket(const std::string&, const std::map<std::string, std::string>&) {
+}
+
+void Engine::AddMcpTool(const std::string& name,
+                        const std::string&,
+                        const std::map<std::string, ParamSchemaVariant>&) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  declared_tools_.push_back(name);
+}
+
+void Engine::Start(std::shared_ptr<AudioInputDevice>, std::shared_ptr<AudioOutputDevice>) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  started_ = true;
+}
+
+void Engine::Advance() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  advance_count_++;
+}
+
+void Engine::SendMcpCallResponse(int64_t id, bool result) {
+  AddResponse({id, false, result});
+}
+
+void Engine::SendMcpCallResponse(int64_t id, int64_t result) {
+  AddResponse({id, false, result});
+}
+
+void Engine::SendMcpCallResponse(int64_t id, const std::string& result) {
+  AddResponse({id, false, result});
+}
+
+void Engine::SendMcpCallResponse(int64_t id, const char* result) {
+  AddResponse({id, false, std::string(result)});
+}
+
+void Engine::SendMcpCallError(int64_t id, const std::string& message) {
+  AddResponse({id, true, message});
+}
+
+std::shared_ptr<Observer> Engine::observer() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return observer_;
+}
+
+std::vector<std::string> Engine::declared_tools() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return declared_tools_;
+}
+
+std::vector<Engine::McpResponse> Engine::TakeMcpResponses() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::move(responses_);
+}
+
+bool Engine::started() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return started_;
+}
+
+uint32_t Engine::advance_count() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return advance_count_;
+}
+
+void Engine::AddResponse(McpResponse response) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  responses_.push_back(std::move(response));
+}
+
+// ==================== ES8311 ====================
+
+AudioDeviceEs8311::AudioDeviceEs8311(i2c_master_bus_handle_t,
+                                     uint8_t,
+                                     i2c_port_t,
+                                     uint32_t,
+                                     gpio_num_t,
+                                     gpio_num_t,
+                                     gpio_num_t,
+                                     gpio_num_t,
+                                     gpio_num_t) {
+  g_audio_device = this;
+}
+
+bool AudioDeviceEs8311::OpenOutput(uint32_t) {
+  output_opened_ = true;
+  return true;
+}
+
+void AudioDeviceEs8311::CloseOutput() {
+  output_opened_ = false;
+}
+
+size_t AudioDeviceEs8311::Write(int16_t*, size_t samples) {
+  written_samples_ += samples;
+  return samples;
+}
+
+void AudioDeviceEs8311::set_volume(uint16_t volume) {
+  volume_ = volume;
+}
+
+uint16_t AudioDeviceEs8311::volume() const {
+  return volume_;
+}
+
+AudioDeviceEs8311* AudioDeviceEs8311::instance() {
+  return g_audio_device;
+}
+
+}  // namespace ai_vox
+
+// ==================== 显示 ====================
+
+Display::Display(esp_lcd_panel_io_handle_t,
+                 esp_lcd_panel_handle_t,
+                 int,
+                 int,
+                 int,
+                 int,
+                 bool,
+                 bool,
+                 bool) {
+  g_display = this;
+}
+
+Display::~Display() {
+  Display* self = this;
+  g_display.compare_exchange_strong(self, nullptr);
+}
+
+Display* Display::instance() {
+  return g_display;
+}
+
+void Display::Start() {
+}
+
+void Display::SetChatMessage(const Role, const std::string& content) {
+  chat_message_ = content;
+  chat_message_count_++;
+}
+
+void Display::ShowStatus(const char* status) {
+  status_ = status;
+}
+
+void Display::SetEmotion(const std::string& emotion) {
+  emotion_ = emotion;
+}
+
+// ==================== 音频解码器 ====================
+
+esp_audio_err_t esp_mp3_dec_register() {
+  return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_dec_unregister(esp_audio_type_t) {
+  return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_simple_dec_open(esp_audio_simple_dec_cfg_t* config, esp_audio_simple_dec_handle_t* decoder) {
+  if (config == nullptr || decoder == nullptr || config->dec_type != ESP_AUDIO_SIMPLE_DEC_TYPE_MP3) {
+    return ESP_AUDIO_ERR_INVALID_PARAMETER;
+  }
+  *decoder = new FakeDecoder();
+  return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_simple_dec_process(esp_audio_simple_dec_handle_t decoder,
+                                             esp_audio_simple_dec_raw_t* raw,
+                                             esp_audio_simple_dec_out_t* frame) {
+  constexpr uint32_t kFrameBytesOut = kDecoderFrameSamples * sizeof(int16_t);
+  raw->consumed = 0;
+  frame->decoded_size = 0;
+  if (raw->len == 0) {
+    return raw->eos ? ESP_AUDIO_ERR_OK : ESP_AUDIO_ERR_DATA_LACK;
+  }
+  if (frame->len < kFrameBytesOut) {
+    frame->needed_size = kFrameBytesOut;
+    return ESP_AUDIO_ERR_BUFF_NOT_ENOUGH;
+  }
+  raw->consumed = std::min(raw->len, kDecoderFrameBytes);
+  // 输出一个低幅度的锯齿波，便于检查数据经过了格式转换和写入
+  auto samples = reinterpret_cast<int16_t*>(frame->buffer);
+  for (uint32_t i = 0; i < kDecoderFrameSamples; i++) {
+    samples[i] = static_cast<int16_t>((i % 64) * 16 - 512);
+  }
+  frame->decoded_size = kFrameBytesOut;
+  static_cast<FakeDecoder*>(decoder)->frames++;
+  return ESP_AUDIO_ERR_OK;
+}
+
+esp_audio_err_t esp_audio_simple_dec_get_info(esp_audio_simple_dec_handle_t, esp_audio_simple_dec_info_t* info) {
+  memset(info, 0, sizeof(*info));
+  info->sample_rate = kDecoderSampleRate;
+  info->bits_per_sample = 16;
+  info->channel = 1;
+  info->bitrate = kDecoderFrameBytes * 8 * kDecoderSampleRate / kDecoderFrameSamples;
+  info->frame_size = kDecoderFrameSamples * sizeof(int16_t);
+  return ESP_AUDIO_ERR_OK;
+}
+
+void esp_audio_simple_dec_close(esp_audio_simple_dec_handle_t decoder) {
+  delete static_cast<FakeDecoder*>(decoder);
+}
@@ -0,0 +1,406 @@
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <WiFi.h>
+#include <components/wifi_configurator/wifi_configurator.h>
+#include <esp_wifi.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "host_fakes.h"
+
+HardwareSerial Serial;
+WiFiClass WiFi;
+
+namespace {
+
+constexpr size_t kPinCount = 49;
+constexpr uint32_t kConfiguratorConnectTimeoutMs = 10000;
+
+struct PinState {
+  std::mutex mutex;
+  uint8_t digital[kPinCount] = {};
+  int analog[kPinCount] = {};
+};
+
+PinState& Pins() {
+  static auto* state = new PinState();
+  return *state;
+}
+
+struct WifiState {
+  std::mutex mutex;
+  host::AccessPoint access_point;
+  host::WifiBeginCall last_begin;
+  // 与ESP32相同，WiFi.begin() 的凭据会被保存，配网流程的 Start() 使用它们
+  std::string stored_ssid = host::AccessPoint().ssid;
+  std::string stored_password = host::AccessPoint().password;
+  std::string ssid;
+  std::string password;
+  wl_status_t status = WL_IDLE_STATUS;
+  wl_status_t pending_status = WL_IDLE_STATUS;
+  int64_t connect_done_us = 0;
+  bool connecting = false;
+  uint32_t static_ip = 0;
+  uint32_t static_gateway = 0;
+  uint32_t static_subnet = 0;
+  uint32_t static_dns = 0;
+  uint8_t bssid[6] = {};
+  std::vector<std::string> resolved_hosts;
+};
+
+WifiState& Wifi() {
+  static auto* state = new WifiState();
+  return *state;
+}
+
+// 调用者持有 mutex
+void UpdateWifiStatus(WifiState& wifi) {
+  if (wifi.connecting && esp_timer_get_time() >= wifi.connect_done_us) {
+    wifi.connecting = false;
+    wifi.status = wifi.pending_status;
+  }
+}
+
+bool WifiConnected(WifiState& wifi) {
+  UpdateWifiStatus(wifi);
+  return wifi.status == WL_CONNECTED;
+}
+
+std::mutex g_configurator_mutex;
+
+}  // namespace
+
+// ==================== Arduino 核心 ====================
+
+void pinMode(uint8_t, uint8_t) {
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  auto& pins = Pins();
+  std::lock_guard<std::mutex> lock(pins.mutex);
+  if (pin < kPinCount) {
+    pins.digital[pin] = value;
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  auto& pins = Pins();
+  std::lock_guard<std::mutex> lock(pins.mutex);
+  return pin < kPinCount ? pins.digital[pin] : LOW;
+}
+
+void analogWrite(uint8_t pin, int value) {
+  auto& pins = Pins();
+  std::lock_guard<std::mutex> lock(pins.mutex);
+  if (pin < kPinCount) {
+    pins.analog[pin] = value;
+  }
+}
+
+unsigned long millis() {
+  return static_cast<unsigned long>(esp_timer_get_time() / 1000);
+}
+
+unsigned long micros() {
+  return static_cast<unsigned long>(esp_timer_get_time());
+}
+
+void delay(uint32_t ms) {
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void HardwareSerial::begin(unsigned long) {
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+  return String(text);
+}
+
+// ==================== WiFi ====================
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* passphrase, int32_t channel, const uint8_t* bssid, bool) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  const auto& ap = wifi.access_point;
+  wifi.ssid = ssid != nullptr ? ssid : "";
+  wifi.password = passphrase != nullptr ? passphrase : "";
+  wifi.stored_ssid = wifi.ssid;
+  wifi.stored_password = wifi.password;
+
+  auto& call = wifi.last_begin;
+  call.count++;
+  call.ssid = wifi.ssid;
+  call.password = wifi.password;
+  call.channel = channel;
+  call.has_bssid = bssid != nullptr;
+  call.static_ip = wifi.static_ip != 0;
+
+  // 指定了信道或BSSID时只在该信道上找该AP，不符时与SSID不存在相同
+  const bool found = ap.present && wifi.ssid == ap.ssid && (channel == 0 || channel == ap.channel) &&
+                     (bssid == nullptr || memcmp(bssid, ap.bssid, sizeof(ap.bssid)) == 0);
+  uint32_t connect_ms = ap.connect_ms;
+  if (!found) {
+    wifi.pending_status = WL_NO_SSID_AVAIL;
+  } else if (wifi.password != ap.password) {
+    wifi.pending_status = WL_CONNECT_FAILED;
+  } else {
+    wifi.pending_status = WL_CONNECTED;
+    if (channel != 0 && bssid != nullptr) {
+      connect_ms = ap.fast_connect_ms;
+    }
+  }
+  memcpy(wifi.bssid, ap.bssid, sizeof(wifi.bssid));
+  wifi.status = WL_DISCONNECTED;
+  wifi.connecting = true;
+  wifi.connect_done_us = esp_timer_get_time() + static_cast<int64_t>(connect_ms) * 1000;
+  return wifi.status;
+}
+
+bool WiFiClass::config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1, IPAddress) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  wifi.static_ip = local_ip;
+  wifi.static_gateway = gateway;
+  wifi.static_subnet = subnet;
+  wifi.static_dns = dns1;
+  return true;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  wifi.connecting = false;
+  wifi.status = WL_DISCONNECTED;
+  return true;
+}
+
+bool WiFiClass::mode(wifi_mode_t) {
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  UpdateWifiStatus(wifi);
+  return wifi.status;
+}
+
+String WiFiClass::SSID() const {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return String(wifi.ssid);
+}
+
+String WiFiClass::psk() const {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return String(wifi.password);
+}
+
+uint8_t* WiFiClass::BSSID() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return WifiConnected(wifi) ? wifi.bssid : nullptr;
+}
+
+String WiFiClass::BSSIDstr() {
+  const uint8_t* bssid = BSSID();
+  if (bssid == nullptr) {
+    return String();
+  }
+  char text[18];
+  snprintf(text, sizeof(text), "%02X:%02X:%02X:%02X:%02X:%02X", bssid[0], bssid[1], bssid[2], bssid[3], bssid[4],
+           bssid[5]);
+  return String(text);
+}
+
+int32_t WiFiClass::channel() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return WifiConnected(wifi) ? wifi.access_point.channel : 0;
+}
+
+String WiFiClass::macAddress() {
+  return String("02:00:00:00:00:AA");
+}
+
+IPAddress WiFiClass::localIP() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  if (!WifiConnected(wifi)) {
+    return IPAddress();
+  }
+  return IPAddress(wifi.static_ip != 0 ? wifi.static_ip : wifi.access_point.ip);
+}
+
+IPAddress WiFiClass::gatewayIP() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  if (!WifiConnected(wifi)) {
+    return IPAddress();
+  }
+  return IPAddress(wifi.static_ip != 0 ? wifi.static_gateway : wifi.access_point.gateway);
+}
+
+IPAddress WiFiClass::subnetMask() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  if (!WifiConnected(wifi)) {
+    return IPAddress();
+  }
+  return IPAddress(wifi.static_ip != 0 ? wifi.static_subnet : wifi.access_point.subnet);
+}
+
+IPAddress WiFiClass::dnsIP(uint8_t) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  if (!WifiConnected(wifi)) {
+    return IPAddress();
+  }
+  return IPAddress(wifi.static_ip != 0 ? wifi.static_dns : wifi.access_point.dns);
+}
+
+int WiFiClass::hostByName(const char* host, IPAddress& result) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  wifi.resolved_hosts.push_back(host);
+  if (!WifiConnected(wifi)) {
+    return 0;
+  }
+  result = IPAddress(10, 0, 0, 1);
+  return 1;
+}
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf) {
+  if (interface != WIFI_IF_STA || conf == nullptr) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  memset(conf, 0, sizeof(*conf));
+  memcpy(conf->sta.ssid, wifi.stored_ssid.data(), std::min(wifi.stored_ssid.size(), sizeof(conf->sta.ssid)));
+  memcpy(conf->sta.password, wifi.stored_password.data(),
+         std::min(wifi.stored_password.size(), sizeof(conf->sta.password)));
+  return ESP_OK;
+}
+
+// ==================== 配网流程 ====================
+
+WifiConfigurator::WifiConfigurator(WiFiClass& wifi, smartconfig_type_t) : wifi_(wifi) {
+}
+
+void WifiConfigurator::Start() {
+  std::string ssid;
+  std::string password;
+  {
+    auto& wifi = Wifi();
+    std::lock_guard<std::mutex> lock(wifi.mutex);
+    ssid = wifi.stored_ssid;
+    password = wifi.stored_password;
+  }
+  if (ssid.empty()) {
+    StartSmartConfig();
+    return;
+  }
+  Start(ssid.c_str(), password.c_str());
+}
+
+void WifiConfigurator::Start(const char* ssid, const char* password) {
+  std::lock_guard<std::mutex> lock(g_configurator_mutex);
+  state_ = State::kConnecting;
+  wifi_.begin(ssid, password);
+}
+
+void WifiConfigurator::StartSmartConfig() {
+  std::lock_guard<std::mutex> lock(g_configurator_mutex);
+  wifi_.disconnect();
+  state_ = State::kSmartConfiguring;
+}
+
+WifiConfigurator::State WifiConfigurator::WaitStateChanged() {
+  const auto start_time = millis();
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(g_configurator_mutex);
+      if (state_ != reported_state_) {
+        reported_state_ = state_;
+        return state_;
+      }
+      if (state_ == State::kSmartConfiguring) {
+        // 模拟用户通过手机下发了模拟AP的凭据
+        std::string ssid;
+        std::string password;
+        {
+          auto& wifi = Wifi();
+          std::lock_guard<std::mutex> wifi_lock(wifi.mutex);
+          ssid = wifi.access_point.ssid;
+          password = wifi.access_point.password;
+        }
+        state_ = State::kConnecting;
+        wifi_.begin(ssid.c_str(), password.c_str());
+        continue;
+      }
+      if (state_ == State::kConnecting) {
+        const auto status = wifi_.status();
+        if (status == WL_CONNECTED) {
+          state_ = State::kFinished;
+          continue;
+        }
+        if (status == WL_NO_SSID_AVAIL || status == WL_CONNECT_FAILED ||
+            millis() - start_time >= kConfiguratorConnectTimeoutMs) {
+          wifi_.disconnect();
+          state_ = State::kSmartConfiguring;
+          continue;
+        }
+      }
+    }
+    delay(1);
+  }
+}
+
+// ==================== 测试接口 ====================
+
+namespace host {
+
+int AnalogValue(uint8_t pin) {
+  auto& pins = Pins();
+  std::lock_guard<std::mutex> lock(pins.mutex);
+  return pin < kPinCount ? pins.analog[pin] : 0;
+}
+
+void SetAccessPoint(const AccessPoint& access_point) {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  wifi.access_point = access_point;
+  wifi.connecting = false;
+  wifi.status = WL_DISCONNECTED;
+}
+
+WifiBeginCall LastWifiBegin() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return wifi.last_begin;
+}
+
+std::vector<std::string> ResolvedHosts() {
+  auto& wifi = Wifi();
+  std::lock_guard<std::mutex> lock(wifi.mutex);
+  return wifi.resolved_hosts;
+}
+
+}  // namespace host
@@ -0,0 +1,441 @@
+#include <components/espressif/button/button_gpio.h>
+#include <components/espressif/button/iot_button.h>
+#include <driver/i2c_master.h>
+#include <driver/spi_common.h>
+#include <esp_lcd_panel_io.h>
+#include <esp_lcd_panel_io_interface.h>
+#include <esp_lcd_panel_ops.h>
+#include <esp_lcd_panel_vendor.h>
+#include <led_strip.h>
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "host_fakes.h"
+
+struct i2c_master_bus_t {
+  i2c_master_bus_config_t config;
+};
+
+struct i2c_master_dev_t {
+  i2c_master_bus_t* bus;
+  i2c_device_config_t config;
+};
+
+struct esp_lcd_panel_t {
+  esp_lcd_panel_io_handle_t io;
+  uint32_t bytes_per_pixel;
+};
+
+struct led_strip_t {
+  std::vector<uint8_t> pixels;
+  uint32_t refresh_count = 0;
+};
+
+struct button_dev_t {
+  std::pair<button_cb_t, void*> callbacks[BUTTON_EVENT_MAX] = {};
+};
+
+namespace {
+
+constexpr int kLcdCmdCaset = 0x2A;
+constexpr int kLcdCmdRaset = 0x2B;
+constexpr int kLcdCmdRamwr = 0x2C;
+constexpr int kLcdCmdRamwrc = 0x3C;
+
+// 模拟的 SPI panel IO，base 必须是第一个成员
+struct SpiPanelIo {
+  esp_lcd_panel_io_t base;
+  esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done = nullptr;
+  void* user_ctx = nullptr;
+  // CASET/RASET 设置的写入窗口(含结束坐标)和窗口内的下一个像素
+  int x_start = 0;
+  int x_end = host::kLcdFramebufferWidth - 1;
+  int y_start = 0;
+  int y_end = host::kLcdFramebufferHeight - 1;
+  size_t cursor = 0;
+};
+
+struct DriverState {
+  std::mutex mutex;
+  std::map<spi_host_device_t, spi_bus_config_t> spi_buses;
+  host::LcdStats lcd_stats;
+  host::LedStripFrame led_frame;
+  std::vector<uint16_t> lcd_framebuffer =
+      std::vector<uint16_t>(host::kLcdFramebufferWidth * host::kLcdFramebufferHeight);
+  uint32_t lcd_failures = 0;
+  button_dev_t* button = nullptr;
+};
+
+DriverState& Drivers() {
+  static auto* state = new DriverState();
+  return *state;
+}
+
+esp_err_t SpiRxParam(esp_lcd_panel_io_t*, int, void*, size_t) {
+  return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t SpiTxParam(esp_lcd_panel_io_t* base, int lcd_cmd, const void* param, size_t param_size) {
+  auto io = reinterpret_cast<SpiPanelIo*>(base);
+  if ((lcd_cmd == kLcdCmdCaset || lcd_cmd == kLcdCmdRaset) && param_size == 4) {
+    const auto data = static_cast<const uint8_t*>(param);
+    const int start = data[0] << 8 | data[1];
+    const int end = data[2] << 8 | data[3];
+    if (lcd_cmd == kLcdCmdCaset) {
+      io->x_start = start;
+      io->x_end = end;
+    } else {
+      io->y_start = start;
+      io->y_end = end;
+    }
+  }
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  drivers.lcd_stats.tx_param_calls++;
+  return ESP_OK;
+}
+
+// 与 ST7789 相同，RAMWR 从窗口起点开始写，RAMWRC 接着上次的位置写，按行依次填满窗口
+void WriteFramebuffer(DriverState& drivers, SpiPanelIo* io, int lcd_cmd, const void* color, size_t color_size) {
+  if (lcd_cmd == kLcdCmdRamwr) {
+    io->cursor = 0;
+  } else if (lcd_cmd != kLcdCmdRamwrc) {
+    return;
+  }
+  const int width = io->x_end - io->x_start + 1;
+  const int height = io->y_end - io->y_start + 1;
+  if (width <= 0 || height <= 0) {
+    return;
+  }
+  const auto pixels = static_cast<const uint8_t*>(color);
+  for (size_t i = 0; i + 1 < color_size; i += 2, io->cursor++) {
+    const int x = io->x_start + static_cast<int>(io->cursor % width);
+    const int y = io->y_start + static_cast<int>(io->cursor / width % height);
+    if (x < host::kLcdFramebufferWidth && y < host::kLcdFramebufferHeight) {
+      memcpy(&drivers.lcd_framebuffer[y * host::kLcdFramebufferWidth + x], pixels + i, sizeof(uint16_t));
+    }
+  }
+}
+
+esp_err_t SpiTxColor(esp_lcd_panel_io_t* base, int lcd_cmd, const void* color, size_t color_size) {
+  auto io = reinterpret_cast<SpiPanelIo*>(base);
+  {
+    auto& drivers = Drivers();
+    std::lock_guard<std::mutex> lock(drivers.mutex);
+    if (drivers.lcd_failures > 0) {
+      drivers.lcd_failures--;
+      drivers.lcd_stats.failed_color_calls++;
+      return ESP_FAIL;
+    }
+    drivers.lcd_stats.tx_color_calls++;
+    drivers.lcd_stats.color_bytes += color_size;
+    drivers.lcd_stats.max_color_size = std::max<uint64_t>(drivers.lcd_stats.max_color_size, color_size);
+    WriteFramebuffer(drivers, io, lcd_cmd, color, color_size);
+  }
+  if (io->on_color_trans_done != nullptr) {
+    esp_lcd_panel_io_event_data_t event_data = {};
+    io->on_color_trans_done(base, &event_data, io->user_ctx);
+  }
+  return ESP_OK;
+}
+
+esp_err_t SpiDel(esp_lcd_panel_io_t* base) {
+  delete reinterpret_cast<SpiPanelIo*>(base);
+  return ESP_OK;
+}
+
+esp_err_t SpiRegisterEventCallbacks(esp_lcd_panel_io_t* base, const esp_lcd_panel_io_callbacks_t* cbs, void* user_ctx) {
+  auto io = reinterpret_cast<SpiPanelIo*>(base);
+  io->on_color_trans_done = cbs->on_color_trans_done;
+  io->user_ctx = user_ctx;
+  return ESP_OK;
+}
+
+void PutCoordinates(uint8_t* data, int start, int end) {
+  data[0] = static_cast<uint8_t>(start >> 8);
+  data[1] = static_cast<uint8_t>(start);
+  data[2] = static_cast<uint8_t>((end - 1) >> 8);
+  data[3] = static_cast<uint8_t>(end - 1);
+}
+
+}  // namespace
+
+// ==================== I2C ====================
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* bus_config, i2c_master_bus_handle_t* ret_bus_handle) {
+  *ret_bus_handle = new i2c_master_bus_t{*bus_config};
+  return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle) {
+  delete bus_handle;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle,
+                                    const i2c_device_config_t* dev_config,
+                                    i2c_master_dev_handle_t* ret_handle) {
+  *ret_handle = new i2c_master_dev_t{bus_handle, *dev_config};
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle) {
+  delete handle;
+  return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t, const uint8_t*, size_t, int) {
+  return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t, uint8_t*, size_t, int) {
+  return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t, const uint8_t*, size_t, uint8_t*, size_t, int) {
+  return ESP_ERR_TIMEOUT;
+}
+
+// ==================== SPI 和 LCD ====================
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t* bus_config, spi_common_dma_t) {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  if (drivers.spi_buses.count(host_id) != 0) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  drivers.spi_buses[host_id] = *bus_config;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t,
+                                   const esp_lcd_panel_io_spi_config_t* io_config,
+                                   esp_lcd_panel_io_handle_t* ret_io) {
+  auto io = new SpiPanelIo();
+  io->base.rx_param = SpiRxParam;
+  io->base.tx_param = SpiTxParam;
+  io->base.tx_color = SpiTxColor;
+  io->base.del = SpiDel;
+  io->base.register_event_callbacks = SpiRegisterEventCallbacks;
+  io->on_color_trans_done = io_config->on_color_trans_done;
+  io->user_ctx = io_config->user_ctx;
+  *ret_io = &io->base;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void* param, size_t param_size) {
+  return io->rx_param(io, lcd_cmd, param, param_size);
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void* param, size_t param_size) {
+  return io->tx_param(io, lcd_cmd, param, param_size);
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void* color, size_t color_size) {
+  return io->tx_color(io, lcd_cmd, color, color_size);
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io,
+                                                    const esp_lcd_panel_io_callbacks_t* cbs,
+                                                    void* user_ctx) {
+  return io->register_event_callbacks(io, cbs, user_ctx);
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io) {
+  return io->del(io);
+}
+
+esp_err_t esp_lcd_new_panel_st7789(esp_lcd_panel_io_handle_t io,
+                                   const esp_lcd_panel_dev_config_t* panel_dev_config,
+                                   esp_lcd_panel_handle_t* ret_panel) {
+  *ret_panel = new esp_lcd_panel_t{io, panel_dev_config->bits_per_pixel / 8};
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t) {
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) {
+  delete panel;
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end,
+                                    const void* color_data) {
+  if (x_start >= x_end || y_start >= y_end) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  uint8_t coordinates[4];
+  PutCoordinates(coordinates, x_start, x_end);
+  esp_lcd_panel_io_tx_param(panel->io, kLcdCmdCaset, coordinates, sizeof(coordinates));
+  PutCoordinates(coordinates, y_start, y_end);
+  esp_lcd_panel_io_tx_param(panel->io, kLcdCmdRaset, coordinates, sizeof(coordinates));
+  const size_t size = static_cast<size_t>(x_end - x_start) * (y_end - y_start) * panel->bytes_per_pixel;
+  return esp_lcd_panel_io_tx_color(panel->io, kLcdCmdRamwr, color_data, size);
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t, bool, bool) {
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t, bool) {
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t, bool) {
+  return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t, bool) {
+  return ESP_OK;
+}
+
+// ==================== LED 灯带 ====================
+
+esp_err_t led_strip_new_rmt_device(const led_strip_config_t* led_config,
+                                   const led_strip_rmt_config_t*,
+                                   led_strip_handle_t* ret_strip) {
+  auto strip = new led_strip_t();
+  strip->pixels.resize(led_config->max_leds * 3);
+  *ret_strip = strip;
+  return ESP_OK;
+}
+
+esp_err_t led_strip_set_pixel(led_strip_handle_t strip, uint32_t index, uint32_t red, uint32_t green, uint32_t blue) {
+  if (index * 3 >= strip->pixels.size()) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  strip->pixels[index * 3] = static_cast<uint8_t>(red);
+  strip->pixels[index * 3 + 1] = static_cast<uint8_t>(green);
+  strip->pixels[index * 3 + 2] = static_cast<uint8_t>(blue);
+  return ESP_OK;
+}
+
+esp_err_t led_strip_refresh(led_strip_handle_t strip) {
+  strip->refresh_count++;
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  drivers.led_frame.pixels = strip->pixels;
+  drivers.led_frame.refresh_count++;
+  return ESP_OK;
+}
+
+esp_err_t led_strip_clear(led_strip_handle_t strip) {
+  std::fill(strip->pixels.begin(), strip->pixels.end(), 0);
+  return led_strip_refresh(strip);
+}
+
+esp_err_t led_strip_del(led_strip_handle_t strip) {
+  delete strip;
+  return ESP_OK;
+}
+
+// ==================== 按键 ====================
+
+esp_err_t iot_button_new_gpio_device(const button_config_t*, const button_gpio_config_t*, button_handle_t* ret_button) {
+  auto button = new button_dev_t();
+  {
+    auto& drivers = Drivers();
+    std::lock_guard<std::mutex> lock(drivers.mutex);
+    drivers.button = button;
+  }
+  *ret_button = button;
+  return ESP_OK;
+}
+
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, void*, button_cb_t cb,
+                                 void* usr_data) {
+  if (event >= BUTTON_EVENT_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  btn_handle->callbacks[event] = {cb, usr_data};
+  return ESP_OK;
+}
+
+esp_err_t iot_button_unregister_cb(button_handle_t btn_handle, button_event_t event, void*) {
+  if (event >= BUTTON_EVENT_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  btn_handle->callbacks[event] = {nullptr, nullptr};
+  return ESP_OK;
+}
+
+esp_err_t iot_button_delete(button_handle_t btn_handle) {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  if (drivers.button == btn_handle) {
+    drivers.button = nullptr;
+  }
+  delete btn_handle;
+  return ESP_OK;
+}
+
+// ==================== 测试接口 ====================
+
+namespace host {
+
+bool PressButton(button_event_t event) {
+  button_dev_t* button = nullptr;
+  std::pair<button_cb_t, void*> callback;
+  {
+    auto& drivers = Drivers();
+    std::lock_guard<std::mutex> lock(drivers.mutex);
+    button = drivers.button;
+    if (button == nullptr || event >= BUTTON_EVENT_MAX) {
+      return false;
+    }
+    callback = button->callbacks[event];
+  }
+  if (callback.first == nullptr) {
+    return false;
+  }
+  callback.first(button, callback.second);
+  return true;
+}
+
+LedStripFrame LastLedStripFrame() {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  return drivers.led_frame;
+}
+
+LcdStats GetLcdStats() {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  return drivers.lcd_stats;
+}
+
+std::vector<uint16_t> LcdFramebuffer() {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  return drivers.lcd_framebuffer;
+}
+
+void FailNextLcdTransfers(uint32_t count) {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  drivers.lcd_failures = count;
+}
+
+spi_bus_config_t SpiBusConfig(spi_host_device_t host) {
+  auto& drivers = Drivers();
+  std::lock_guard<std::mutex> lock(drivers.mutex);
+  const auto it = drivers.spi_buses.find(host);
+  return it != drivers.spi_buses.end() ? it->second : spi_bus_config_t{};
+}
+
+}  // namespace host
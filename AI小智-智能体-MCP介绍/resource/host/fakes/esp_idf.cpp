@@ -0,0 +1,522 @@
+#include <esp_err.h>
+#include <esp_heap_caps.h>
+#include <esp_memory_utils.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
+#include <malloc.h>
+#include <nvs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "host_fakes.h"
+
+namespace {
+
+// ==================== 分配统计 ====================
+
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_allocated_bytes{0};
+std::atomic<int64_t> g_live_bytes{0};
+
+void CountAllocation(void* ptr) {
+  const size_t size = malloc_usable_size(ptr);
+  g_allocations.fetch_add(1, std::memory_order_relaxed);
+  g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  g_live_bytes.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+void CountFree(void* ptr) {
+  g_live_bytes.fetch_sub(static_cast<int64_t>(malloc_usable_size(ptr)), std::memory_order_relaxed);
+}
+
+void* CountedNew(size_t size, size_t alignment) {
+  void* ptr = alignment <= alignof(std::max_align_t)
+                  ? malloc(size != 0 ? size : 1)
+                  : aligned_alloc(alignment, (std::max<size_t>(size, 1) + alignment - 1) / alignment * alignment);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  CountAllocation(ptr);
+  return ptr;
+}
+
+void CountedDelete(void* ptr) {
+  if (ptr != nullptr) {
+    CountFree(ptr);
+    free(ptr);
+  }
+}
+
+// ==================== heap_caps ====================
+
+// 每个 heap_caps 块前面的记录，offset 是用户指针到 malloc 返回地址的距离
+struct HeapBlockHeader {
+  size_t size;
+  uint32_t caps;
+  uint32_t offset;
+};
+
+constexpr size_t kHeapBlockHeaderSize = 32;
+
+struct HeapRegion {
+  size_t total;
+  size_t used = 0;
+  size_t minimum_free;
+};
+
+struct HeapState {
+  std::mutex mutex;
+  HeapRegion internal{512 * 1024, 0, 512 * 1024};
+  HeapRegion spiram{8 * 1024 * 1024, 0, 8 * 1024 * 1024};
+  std::map<uintptr_t, size_t> non_dma_ranges;  // 起始地址 -> 长度
+};
+
+HeapState& Heap() {
+  static auto* state = new HeapState();
+  return *state;
+}
+
+HeapRegion& RegionFor(HeapState& heap, uint32_t caps) {
+  return (caps & MALLOC_CAP_SPIRAM) ? heap.spiram : heap.internal;
+}
+
+HeapBlockHeader* HeaderOf(void* ptr) {
+  return reinterpret_cast<HeapBlockHeader*>(static_cast<uint8_t*>(ptr) - sizeof(HeapBlockHeader));
+}
+
+void* HeapAllocate(size_t alignment, size_t size, uint32_t caps) {
+  alignment = std::max<size_t>(alignment, 16);
+  if ((alignment & (alignment - 1)) != 0) {
+    return nullptr;
+  }
+  auto& heap = Heap();
+  {
+    std::lock_guard<std::mutex> lock(heap.mutex);
+    auto& region = RegionFor(heap, caps);
+    if (region.total - region.used < size) {
+      return nullptr;
+    }
+    region.used += size;
+    region.minimum_free = std::min(region.minimum_free, region.total - region.used);
+  }
+
+  const size_t offset = std::max(kHeapBlockHeaderSize, alignment);
+  auto base = static_cast<uint8_t*>(aligned_alloc(alignment, (offset + size + alignment - 1) / alignment * alignment));
+  if (base == nullptr) {
+    std::lock_guard<std::mutex> lock(heap.mutex);
+    RegionFor(heap, caps).used -= size;
+    return nullptr;
+  }
+  CountAllocation(base);
+  void* ptr = base + offset;
+  *HeaderOf(ptr) = {size, caps, static_cast<uint32_t>(offset)};
+  if (caps & MALLOC_CAP_SPIRAM) {
+    std::lock_guard<std::mutex> lock(heap.mutex);
+    heap.non_dma_ranges[reinterpret_cast<uintptr_t>(ptr)] = size;
+  }
+  return ptr;
+}
+
+// ==================== flash 分区和 NVS ====================
+
+struct PartitionData {
+  esp_partition_t partition;
+  std::unique_ptr<uint8_t, decltype(&free)> data{nullptr, &free};
+};
+
+struct FlashState {
+  std::mutex mutex;
+  std::map<std::string, std::unique_ptr<PartitionData>> partitions;
+  std::map<std::string, std::map<std::string, std::vector<uint8_t>>> nvs;
+  std::map<nvs_handle_t, std::pair<std::string, nvs_open_mode_t>> nvs_handles;
+  nvs_handle_t next_nvs_handle = 1;
+  esp_partition_mmap_handle_t next_mmap_handle = 1;
+};
+
+FlashState& Flash() {
+  static auto* state = new FlashState();
+  return *state;
+}
+
+constexpr size_t kMmapPageSize = 0x10000;
+
+}  // namespace
+
+// ==================== new/delete ====================
+
+void* operator new(size_t size) {
+  return CountedNew(size, 0);
+}
+
+void* operator new[](size_t size) {
+  return CountedNew(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+  return CountedNew(size, static_cast<size_t>(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+  return CountedNew(size, static_cast<size_t>(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return CountedNew(size, 0);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return CountedNew(size, 0);
+  } catch (const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* ptr) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  CountedDelete(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+  CountedDelete(ptr);
+}
+
+// ==================== esp_timer 和 esp_err ====================
+
+int64_t esp_timer_get_time() {
+  // 设备上读到的是启动以来的时间，第一次读取时不会为0
+  static const auto start = std::chrono::steady_clock::now() - std::chrono::milliseconds(1);
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+  switch (code) {
+    case ESP_OK:
+      return "ESP_OK";
+    case ESP_FAIL:
+      return "ESP_FAIL";
+    case ESP_ERR_NO_MEM:
+      return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG:
+      return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE:
+      return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_INVALID_SIZE:
+      return "ESP_ERR_INVALID_SIZE";
+    case ESP_ERR_NOT_FOUND:
+      return "ESP_ERR_NOT_FOUND";
+    case ESP_ERR_NOT_SUPPORTED:
+      return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT:
+      return "ESP_ERR_TIMEOUT";
+    case ESP_ERR_INVALID_CRC:
+      return "ESP_ERR_INVALID_CRC";
+    case ESP_ERR_NVS_NOT_FOUND:
+      return "ESP_ERR_NVS_NOT_FOUND";
+    case ESP_ERR_NVS_INVALID_LENGTH:
+      return "ESP_ERR_NVS_INVALID_LENGTH";
+    default:
+      return "UNKNOWN ERROR";
+  }
+}
+
+// ==================== heap_caps ====================
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+  return HeapAllocate(16, size, caps);
+}
+
+void* heap_caps_calloc(size_t count, size_t size, uint32_t caps) {
+  if (size != 0 && count > SIZE_MAX / size) {
+    return nullptr;
+  }
+  void* ptr = HeapAllocate(16, count * size, caps);
+  if (ptr != nullptr) {
+    memset(ptr, 0, count * size);
+  }
+  return ptr;
+}
+
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+  return HeapAllocate(alignment, size, caps);
+}
+
+void heap_caps_free(void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  const HeapBlockHeader header = *HeaderOf(ptr);
+  auto& heap = Heap();
+  {
+    std::lock_guard<std::mutex> lock(heap.mutex);
+    RegionFor(heap, header.caps).used -= header.size;
+    heap.non_dma_ranges.erase(reinterpret_cast<uintptr_t>(ptr));
+  }
+  void* base = static_cast<uint8_t*>(ptr) - header.offset;
+  CountFree(base);
+  free(base);
+}
+
+void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps) {
+  if (ptr == nullptr) {
+    return heap_caps_malloc(size, caps);
+  }
+  if (size == 0) {
+    heap_caps_free(ptr);
+    return nullptr;
+  }
+  void* new_ptr = heap_caps_malloc(size, caps);
+  if (new_ptr == nullptr) {
+    return nullptr;
+  }
+  memcpy(new_ptr, ptr, std::min(size, HeaderOf(ptr)->size));
+  heap_caps_free(ptr);
+  return new_ptr;
+}
+
+size_t heap_caps_get_total_size(uint32_t caps) {
+  auto& heap = Heap();
+  std::lock_guard<std::mutex> lock(heap.mutex);
+  return RegionFor(heap, caps).total;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+  auto& heap = Heap();
+  std::lock_guard<std::mutex> lock(heap.mutex);
+  const auto& region = RegionFor(heap, caps);
+  return region.total - region.used;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  auto& heap = Heap();
+  std::lock_guard<std::mutex> lock(heap.mutex);
+  return RegionFor(heap, caps).minimum_free;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+  return heap_caps_get_free_size(caps);
+}
+
+bool esp_ptr_dma_capable(const void* ptr) {
+  const auto address = reinterpret_cast<uintptr_t>(ptr);
+  {
+    auto& heap = Heap();
+    std::lock_guard<std::mutex> lock(heap.mutex);
+    auto it = heap.non_dma_ranges.upper_bound(address);
+    if (it != heap.non_dma_ranges.begin() && address < std::prev(it)->first + std::prev(it)->second) {
+      return false;
+    }
+  }
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  for (const auto& [label, partition] : flash.partitions) {
+    const auto start = reinterpret_cast<uintptr_t>(partition->data.get());
+    if (address >= start && address < start + partition->partition.size) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// ==================== flash 分区 ====================
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type,
+                                                esp_partition_subtype_t subtype,
+                                                const char* label) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  for (const auto& [name, partition] : flash.partitions) {
+    if ((type == ESP_PARTITION_TYPE_ANY || partition->partition.type == type) &&
+        (subtype == ESP_PARTITION_SUBTYPE_ANY || partition->partition.subtype == subtype) &&
+        (label == nullptr || name == label)) {
+      return &partition->partition;
+    }
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition,
+                             size_t offset,
+                             size_t size,
+                             esp_partition_mmap_memory_t memory,
+                             const void** out_ptr,
+                             esp_partition_mmap_handle_t* out_handle) {
+  if (partition == nullptr || out_ptr == nullptr || out_handle == nullptr || offset + size > partition->size) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  for (const auto& [name, data] : flash.partitions) {
+    if (&data->partition == partition) {
+      *out_ptr = data->data.get() + offset;
+      *out_handle = flash.next_mmap_handle++;
+      return ESP_OK;
+    }
+  }
+  return ESP_ERR_NOT_FOUND;
+}
+
+void esp_partition_munmap(esp_partition_mmap_handle_t) {
+}
+
+// ==================== NVS ====================
+
+esp_err_t nvs_open(const char* name, nvs_open_mode_t open_mode, nvs_handle_t* out_handle) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  if (open_mode == NVS_READONLY && flash.nvs.count(name) == 0) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  flash.nvs[name];
+  *out_handle = flash.next_nvs_handle++;
+  flash.nvs_handles[*out_handle] = {name, open_mode};
+  return ESP_OK;
+}
+
+void nvs_close(nvs_handle_t handle) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  flash.nvs_handles.erase(handle);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char* key, void* out_value, size_t* length) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  const auto handle_it = flash.nvs_handles.find(handle);
+  if (handle_it == flash.nvs_handles.end()) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const auto& entries = flash.nvs[handle_it->second.first];
+  const auto it = entries.find(key);
+  if (it == entries.end()) {
+    return ESP_ERR_NVS_NOT_FOUND;
+  }
+  if (out_value == nullptr) {
+    *length = it->second.size();
+    return ESP_OK;
+  }
+  if (*length < it->second.size()) {
+    return ESP_ERR_NVS_INVALID_LENGTH;
+  }
+  memcpy(out_value, it->second.data(), it->second.size());
+  *length = it->second.size();
+  return ESP_OK;
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char* key, const void* value, size_t length) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  const auto handle_it = flash.nvs_handles.find(handle);
+  if (handle_it == flash.nvs_handles.end() || handle_it->second.second != NVS_READWRITE) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  const auto bytes = static_cast<const uint8_t*>(value);
+  flash.nvs[handle_it->second.first][key].assign(bytes, bytes + length);
+  return ESP_OK;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char* key) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  const auto handle_it = flash.nvs_handles.find(handle);
+  if (handle_it == flash.nvs_handles.end() || handle_it->second.second != NVS_READWRITE) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  return flash.nvs[handle_it->second.first].erase(key) > 0 ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+esp_err_t nvs_commit(nvs_handle_t) {
+  return ESP_OK;
+}
+
+// ==================== 测试接口 ====================
+
+namespace host {
+
+void SetHeapTotalSize(uint32_t caps, size_t size) {
+  auto& heap = Heap();
+  std::lock_guard<std::mutex> lock(heap.mutex);
+  auto& region = RegionFor(heap, caps);
+  region.total = size;
+  region.minimum_free = size >= region.used ? size - region.used : 0;
+}
+
+AllocationStats GetAllocationStats() {
+  AllocationStats stats;
+  stats.allocations = g_allocations.load();
+  stats.bytes = g_allocated_bytes.load();
+  stats.live_bytes = g_live_bytes.load();
+  return stats;
+}
+
+void SetPartition(const char* label, const std::vector<uint8_t>& data) {
+  auto partition = std::make_unique<PartitionData>();
+  const size_t size = std::max<size_t>((data.size() + kMmapPageSize - 1) / kMmapPageSize * kMmapPageSize, kMmapPageSize);
+  partition->data.reset(static_cast<uint8_t*>(aligned_alloc(kMmapPageSize, size)));
+  memset(partition->data.get(), 0xff, size);
+  if (!data.empty()) {
+    memcpy(partition->data.get(), data.data(), data.size());
+  }
+  partition->partition.type = ESP_PARTITION_TYPE_DATA;
+  partition->partition.subtype = static_cast<esp_partition_subtype_t>(0x40);
+  partition->partition.address = 0x400000;
+  partition->partition.size = static_cast<uint32_t>(size);
+  snprintf(partition->partition.label, sizeof(partition->partition.label), "%s", label);
+
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  flash.partitions[label] = std::move(partition);
+}
+
+void RemovePartition(const char* label) {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  flash.partitions.erase(label);
+}
+
+void ClearNvs() {
+  auto& flash = Flash();
+  std::lock_guard<std::mutex> lock(flash.mutex);
+  flash.nvs.clear();
+}
+
+}  // namespace host
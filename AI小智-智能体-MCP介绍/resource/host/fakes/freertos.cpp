@@ -0,0 +1,414 @@
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct tskTaskControlBlock {
+  std::string name;
+  uint32_t stack_depth = 0;
+  UBaseType_t priority = 0;
+  BaseType_t core_id = 0;
+  TaskFunction_t function = nullptr;
+  void* arg = nullptr;
+  std::atomic<bool> deleted{false};
+  std::mutex mutex;
+  std::condition_variable cv;
+  uint32_t notify_value = 0;
+};
+
+struct QueueDefinition {
+  std::mutex mutex;
+  std::condition_variable cv;
+  UBaseType_t length = 0;
+  UBaseType_t item_size = 0;
+  std::deque<std::vector<uint8_t>> items;
+};
+
+struct EventGroupDef_t {
+  std::mutex mutex;
+  std::condition_variable cv;
+  EventBits_t bits = 0;
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 等待中的任务按这个间隔检查自己是否已被其它任务删除
+constexpr auto kDeletePollInterval = std::chrono::milliseconds(5);
+
+thread_local tskTaskControlBlock* t_current_task = nullptr;
+
+std::recursive_mutex g_critical_mutex;
+
+// 不是通过 xTaskCreate 创建的线程(如 main)在第一次调用时得到自己的任务记录
+tskTaskControlBlock* CurrentTask() {
+  if (t_current_task == nullptr) {
+    t_current_task = new tskTaskControlBlock();
+    t_current_task->name = "main";
+    t_current_task->priority = 1;
+    t_current_task->core_id = 1;
+  }
+  return t_current_task;
+}
+
+[[noreturn]] void ExitTask() {
+  pthread_exit(nullptr);
+}
+
+void ExitIfDeleted() {
+  if (CurrentTask()->deleted.load()) {
+    ExitTask();
+  }
+}
+
+// 等待 ready() 成立，ticks 为0时只检查一次；等待期间任务被删除时退出线程
+template <typename Ready>
+bool WaitFor(std::unique_lock<std::mutex>& lock, std::condition_variable& cv, TickType_t ticks, Ready ready) {
+  if (ready()) {
+    return true;
+  }
+  if (ticks == 0) {
+    return false;
+  }
+  const auto deadline =
+      ticks == portMAX_DELAY ? Clock::time_point::max() : Clock::now() + std::chrono::milliseconds(ticks);
+  while (!ready()) {
+    if (CurrentTask()->deleted.load()) {
+      lock.unlock();
+      ExitTask();
+    }
+    const auto now = Clock::now();
+    if (now >= deadline) {
+      return false;
+    }
+    cv.wait_until(lock, std::min(deadline, now + kDeletePollInterval));
+  }
+  return true;
+}
+
+void* TaskEntry(void* arg) {
+  auto task = static_cast<tskTaskControlBlock*>(arg);
+  t_current_task = task;
+  task->function(task->arg);
+  // 与 ESP-IDF 相同，任务函数不能返回，必须调用 vTaskDelete(nullptr)
+  printf("Task %s should not return, aborting now!\n", task->name.c_str());
+  abort();
+}
+
+QueueHandle_t NewQueue(UBaseType_t length, UBaseType_t item_size) {
+  if (length == 0) {
+    return nullptr;
+  }
+  auto queue = new QueueDefinition();
+  queue->length = length;
+  queue->item_size = item_size;
+  return queue;
+}
+
+BaseType_t QueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait, bool front) {
+  ExitIfDeleted();
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!WaitFor(lock, queue->cv, ticks_to_wait, [queue] { return queue->items.size() < queue->length; })) {
+    return pdFALSE;
+  }
+  const auto bytes = static_cast<const uint8_t*>(item);
+  std::vector<uint8_t> copy(bytes, bytes + (item != nullptr ? queue->item_size : 0));
+  if (front) {
+    queue->items.push_front(std::move(copy));
+  } else {
+    queue->items.push_back(std::move(copy));
+  }
+  queue->cv.notify_all();
+  return pdTRUE;
+}
+
+}  // namespace
+
+// ==================== 任务 ====================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created_task,
+                                   BaseType_t core_id) {
+  auto task = new tskTaskControlBlock();
+  task->name = name != nullptr ? name : "";
+  task->stack_depth = stack_depth;
+  task->priority = priority;
+  task->core_id = core_id == tskNO_AFFINITY ? 0 : core_id;
+  task->function = function;
+  task->arg = arg;
+  if (created_task != nullptr) {
+    *created_task = task;
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_t thread;
+  const int err = pthread_create(&thread, &attr, TaskEntry, task);
+  pthread_attr_destroy(&attr);
+  if (err != 0) {
+    if (created_task != nullptr) {
+      *created_task = nullptr;
+    }
+    delete task;
+    return pdFAIL;
+  }
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stack_depth,
+                       void* arg,
+                       UBaseType_t priority,
+                       TaskHandle_t* created_task) {
+  return xTaskCreatePinnedToCore(function, name, stack_depth, arg, priority, created_task, tskNO_AFFINITY);
+}
+
+// 任务记录不释放，删除后句柄仍可安全地传给 UnregisterMetricTask() 等函数
+void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == CurrentTask()) {
+    ExitTask();
+  }
+  task->deleted.store(true);
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->cv.notify_all();
+}
+
+void vTaskDelay(TickType_t ticks) {
+  auto task = CurrentTask();
+  if (ticks == 0) {
+    ExitIfDeleted();
+    std::this_thread::yield();
+    return;
+  }
+  std::unique_lock<std::mutex> lock(task->mutex);
+  WaitFor(lock, task->cv, ticks, [] { return false; });
+}
+
+void vTaskDelayUntil(TickType_t* previous_wake_time, TickType_t increment) {
+  const TickType_t wake_time = *previous_wake_time + increment;
+  const TickType_t now = xTaskGetTickCount();
+  if (static_cast<int32_t>(wake_time - now) > 0) {
+    vTaskDelay(wake_time - now);
+  } else {
+    ExitIfDeleted();
+  }
+  *previous_wake_time = wake_time;
+}
+
+TickType_t xTaskGetTickCount() {
+  return static_cast<TickType_t>(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+  return CurrentTask();
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+  return (task != nullptr ? task : CurrentTask())->name.c_str();
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task) {
+  return (task != nullptr ? task : CurrentTask())->priority;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return (task != nullptr ? task : CurrentTask())->stack_depth;
+}
+
+void xTaskNotifyGive(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(task->mutex);
+  task->notify_value++;
+  task->cv.notify_all();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait) {
+  auto task = CurrentTask();
+  std::unique_lock<std::mutex> lock(task->mutex);
+  WaitFor(lock, task->cv, ticks_to_wait, [task] { return task->notify_value > 0; });
+  const uint32_t value = task->notify_value;
+  if (value > 0) {
+    task->notify_value = clear_count_on_exit ? 0 : value - 1;
+  }
+  return value;
+}
+
+void portENTER_CRITICAL(portMUX_TYPE*) {
+  g_critical_mutex.lock();
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE*) {
+  g_critical_mutex.unlock();
+}
+
+BaseType_t xPortGetCoreID() {
+  return CurrentTask()->core_id;
+}
+
+// ==================== 队列和信号量 ====================
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+  return NewQueue(length, item_size);
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+  delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+  return QueueSend(queue, item, ticks_to_wait, false);
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+  return QueueSend(queue, item, ticks_to_wait, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+  return QueueSend(queue, item, ticks_to_wait, true);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item) {
+  {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+  }
+  return QueueSend(queue, item, 0, false);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait) {
+  ExitIfDeleted();
+  std::unique_lock<std::mutex> lock(queue->mutex);
+  if (!WaitFor(lock, queue->cv, ticks_to_wait, [queue] { return !queue->items.empty(); })) {
+    return pdFALSE;
+  }
+  if (item != nullptr && queue->item_size > 0) {
+    memcpy(item, queue->items.front().data(), queue->item_size);
+  }
+  queue->items.pop_front();
+  queue->cv.notify_all();
+  return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  queue->items.clear();
+  queue->cv.notify_all();
+  return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+  std::lock_guard<std::mutex> lock(queue->mutex);
+  return static_cast<UBaseType_t>(queue->items.size());
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+  return NewQueue(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  auto semaphore = NewQueue(1, 0);
+  xSemaphoreGive(semaphore);
+  return semaphore;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+  auto semaphore = NewQueue(max_count, 0);
+  for (UBaseType_t i = 0; semaphore != nullptr && i < initial_count; i++) {
+    xSemaphoreGive(semaphore);
+  }
+  return semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+  return xQueueReceive(semaphore, nullptr, ticks_to_wait);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  return QueueSend(semaphore, nullptr, 0, false);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higher_priority_task_woken) {
+  if (higher_priority_task_woken != nullptr) {
+    *higher_priority_task_woken = pdFALSE;
+  }
+  std::lock_guard<std::mutex> lock(semaphore->mutex);
+  if (semaphore->items.size() >= semaphore->length) {
+    return pdFALSE;
+  }
+  semaphore->items.emplace_back();
+  semaphore->cv.notify_all();
+  return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+  delete semaphore;
+}
+
+// ==================== 事件组 ====================
+
+EventGroupHandle_t xEventGroupCreate() {
+  return new EventGroupDef_t();
+}
+
+void vEventGroupDelete(EventGroupHandle_t group) {
+  delete group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+  std::lock_guard<std::mutex> lock(group->mutex);
+  group->bits |= bits;
+  group->cv.notify_all();
+  return group->bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+  std::lock_guard<std::mutex> lock(group->mutex);
+  const EventBits_t previous = group->bits;
+  group->bits &= ~bits;
+  return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+  std::lock_guard<std::mutex> lock(group->mutex);
+  return group->bits;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                EventBits_t bits,
+                                BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all,
+                                TickType_t ticks_to_wait) {
+  ExitIfDeleted();
+  std::unique_lock<std::mutex> lock(group->mutex);
+  const auto satisfied = [group, bits, wait_for_all] {
+    return wait_for_all ? (group->bits & bits) == bits : (group->bits & bits) != 0;
+  };
+  const bool ok = WaitFor(lock, group->cv, ticks_to_wait, satisfied);
+  const EventBits_t result = group->bits;
+  if (ok && clear_on_exit) {
+    group->bits &= ~bits;
+  }
+  return result;
+}
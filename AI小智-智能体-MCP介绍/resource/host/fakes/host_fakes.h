@@ -0,0 +1,141 @@
+#pragma once
+
+#ifndef _HOST_FAKES_H_
+#define _HOST_FAKES_H_
+
+/**
+ * @file host_fakes.h
+ * @brief 主机构建中模拟硬件的设置和统计接口，只在测试和基准程序中使用
+ *
+ * host/stubs 下的头文件声明 ESP-IDF/Arduino/ai_vox 的接口，host/fakes 下是它们在 Linux 上的实现：
+ * FreeRTOS 任务对应线程，堆、NVS、flash 分区、WiFi、按键和 LCD 都是进程内的模拟。
+ */
+
+#include <components/espressif/button/iot_button.h>
+#include <driver/spi_common.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace host {
+
+// ==================== 堆 ====================
+
+/**
+ * @brief 设置某类内存(MALLOC_CAP_INTERNAL 或 MALLOC_CAP_SPIRAM)的总容量，SPIRAM 设为0模拟没有PSRAM
+ */
+void SetHeapTotalSize(uint32_t caps, size_t size);
+
+/**
+ * @brief 进程内所有 new/delete 和 heap_caps 分配的累计统计
+ */
+struct AllocationStats {
+  uint64_t allocations = 0;  // 分配次数
+  uint64_t bytes = 0;        // 累计分配的字节数
+  int64_t live_bytes = 0;    // 当前未释放的字节数
+};
+
+AllocationStats GetAllocationStats();
+
+// ==================== flash 分区和 NVS ====================
+
+/**
+ * @brief 添加或替换一个数据分区，esp_partition_mmap() 返回 data 的副本(按页对齐)
+ */
+void SetPartition(const char* label, const std::vector<uint8_t>& data);
+void RemovePartition(const char* label);
+
+void ClearNvs();
+
+// ==================== WiFi ====================
+
+/**
+ * @brief 模拟的AP，WiFi.begin() 按它决定连接结果
+ */
+struct AccessPoint {
+  bool present = true;
+  std::string ssid = "host_ap";
+  std::string password = "host_password";
+  uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  uint8_t channel = 6;
+  uint32_t ip = 0x6401A8C0;  // 192.168.1.100
+  uint32_t gateway = 0x0101A8C0;
+  uint32_t subnet = 0x00FFFFFF;
+  uint32_t dns = 0x0101A8C0;
+  uint32_t connect_ms = 5;        // 未指定信道和BSSID时的连接耗时，含扫描
+  uint32_t fast_connect_ms = 1;   // 指定了正确的信道和BSSID时的连接耗时
+};
+
+void SetAccessPoint(const AccessPoint& access_point);
+
+/**
+ * @brief 最近一次 WiFi.begin() 的参数
+ */
+struct WifiBeginCall {
+  uint32_t count = 0;
+  std::string ssid;
+  std::string password;
+  int32_t channel = 0;
+  bool has_bssid = false;
+  bool static_ip = false;
+};
+
+WifiBeginCall LastWifiBegin();
+
+/**
+ * @brief 按调用顺序返回 WiFi.hostByName() 解析过的主机名
+ */
+std::vector<std::string> ResolvedHosts();
+
+// ==================== 按键、GPIO、LCD ====================
+
+/**
+ * @brief 在调用者的线程中执行为该事件注册的回调，没有回调时返回false
+ */
+bool PressButton(button_event_t event);
+
+int AnalogValue(uint8_t pin);
+
+/**
+ * @brief 最近一次 led_strip_refresh()/led_strip_clear() 发送的RGB数据和累计刷新次数
+ */
+struct LedStripFrame {
+  std::vector<uint8_t> pixels;
+  uint32_t refresh_count = 0;
+};
+
+LedStripFrame LastLedStripFrame();
+
+struct LcdStats {
+  uint64_t tx_param_calls = 0;
+  uint64_t tx_color_calls = 0;
+  uint64_t color_bytes = 0;
+  uint64_t max_color_size = 0;
+  uint64_t failed_color_calls = 0;
+};
+
+LcdStats GetLcdStats();
+
+// 模拟的显存大小与 ST7789 相同
+constexpr int kLcdFramebufferWidth = 240;
+constexpr int kLcdFramebufferHeight = 320;
+
+/**
+ * @brief 读取模拟的显存，按行存放，每个像素的两个字节保持发送时的顺序
+ *
+ * SPI panel IO 按 CASET/RASET 设置的窗口把 RAMWR/RAMWRC 的数据写入显存，所有面板共用同一块显存。
+ */
+std::vector<uint16_t> LcdFramebuffer();
+
+/**
+ * @brief 之后的 count 次 tx_color 返回 ESP_FAIL，不写入显存，也不调用传输完成回调
+ */
+void FailNextLcdTransfers(uint32_t count);
+
+spi_bus_config_t SpiBusConfig(spi_host_device_t host);
+
+}  // namespace host
+
+#endif
@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+/**
+ * @file Arduino.h
+ * @brief 主机构建用的 Arduino 核心桩，只包含本工程用到的部分
+ */
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <cinttypes>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "IPAddress.h"
+
+#define LOW 0x0
+#define HIGH 0x1
+#define INPUT 0x01
+#define OUTPUT 0x03
+
+// GPIO 的状态保存在内存中，digitalRead() 读回最后一次 digitalWrite() 的值
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+
+unsigned long millis();
+unsigned long micros();
+void delay(uint32_t ms);
+
+class String {
+ public:
+  String() = default;
+  String(const char* value) : value_(value != nullptr ? value : "") {
+  }
+  String(std::string value) : value_(std::move(value)) {
+  }
+
+  const char* c_str() const {
+    return value_.c_str();
+  }
+
+  unsigned int length() const {
+    return static_cast<unsigned int>(value_.size());
+  }
+
+  String& operator+=(const String& other) {
+    value_ += other.value_;
+    return *this;
+  }
+
+  bool operator==(const String& other) const {
+    return value_ == other.value_;
+  }
+
+ private:
+  std::string value_;
+};
+
+class HardwareSerial {
+ public:
+  void begin(unsigned long baud);
+  size_t write(const uint8_t* buffer, size_t size);
+  void flush();
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef _HOST_IPADDRESS_H_
+#define _HOST_IPADDRESS_H_
+
+#include <cstdint>
+#include <cstdio>
+
+class String;
+
+// 与 Arduino 相同，uint32_t 形式的地址第一个字节在最低位
+class IPAddress {
+ public:
+  IPAddress() = default;
+  IPAddress(uint32_t address) : address_(address) {
+  }
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+      : address_(a | (b << 8) | (c << 16) | (static_cast<uint32_t>(d) << 24)) {
+  }
+
+  operator uint32_t() const {
+    return address_;
+  }
+
+  uint8_t operator[](int index) const {
+    return static_cast<uint8_t>(address_ >> (index * 8));
+  }
+
+  String toString() const;
+
+ private:
+  uint32_t address_ = 0;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef _HOST_WIFI_H_
+#define _HOST_WIFI_H_
+
+/**
+ * @file WiFi.h
+ * @brief 主机构建用的 Arduino WiFi 桩
+ *
+ * 连接结果由 host::SetAccessPoint() 设置的模拟AP决定：SSID不存在时状态变为 WL_NO_SSID_AVAIL，
+ * 密码错误时变为 WL_CONNECT_FAILED，否则经过AP的连接耗时后变为 WL_CONNECTED。
+ */
+
+#include <cstdint>
+
+#include "Arduino.h"
+#include "IPAddress.h"
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_SCAN_COMPLETED = 2,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA = 1,
+} wifi_mode_t;
+
+#define WIFI_OFF WIFI_MODE_NULL
+#define WIFI_STA WIFI_MODE_STA
+
+typedef enum {
+  SC_TYPE_ESPTOUCH = 0,
+  SC_TYPE_AIRKISS,
+  SC_TYPE_ESPTOUCH_AIRKISS,
+  SC_TYPE_ESPTOUCH_V2,
+} smartconfig_type_t;
+
+class WiFiClass {
+ public:
+  wl_status_t begin(const char* ssid, const char* passphrase = nullptr, int32_t channel = 0,
+                    const uint8_t* bssid = nullptr, bool connect = true);
+  bool config(IPAddress local_ip, IPAddress gateway, IPAddress subnet, IPAddress dns1 = IPAddress(),
+              IPAddress dns2 = IPAddress());
+  bool disconnect(bool wifi_off = false, bool erase_ap = false);
+  bool mode(wifi_mode_t mode);
+  wl_status_t status();
+
+  String SSID() const;
+  String psk() const;
+  uint8_t* BSSID();
+  String BSSIDstr();
+  int32_t channel();
+  String macAddress();
+  IPAddress localIP();
+  IPAddress gatewayIP();
+  IPAddress subnetMask();
+  IPAddress dnsIP(uint8_t index = 0);
+
+  int hostByName(const char* host, IPAddress& result);
+};
+
+extern WiFiClass WiFi;
+
+#endif
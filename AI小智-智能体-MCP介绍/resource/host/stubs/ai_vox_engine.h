@@ -0,0 +1,179 @@
+#pragma once
+
+#ifndef _HOST_AI_VOX_ENGINE_H_
+#define _HOST_AI_VOX_ENGINE_H_
+
+/**
+ * @file ai_vox_engine.h
+ * @brief 主机构建用的 ai_vox 引擎桩
+ *
+ * 接口与固件使用的 ai_vox 库相同。引擎不连接服务器：Observer 的事件由测试通过 Observer::Push() 注入，
+ * 工具声明和调用结果记录在 Engine 中供测试检查。
+ */
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+namespace ai_vox {
+
+class AudioInputDevice {
+ public:
+  virtual ~AudioInputDevice() = default;
+};
+
+class AudioOutputDevice {
+ public:
+  virtual ~AudioOutputDevice() = default;
+};
+
+template <typename T>
+struct ParamSchema;
+
+template <>
+struct ParamSchema<bool> {
+  std::optional<bool> default_value;
+};
+
+template <>
+struct ParamSchema<int64_t> {
+  std::optional<int64_t> default_value;
+  std::optional<int64_t> min;
+  std::optional<int64_t> max;
+};
+
+template <>
+struct ParamSchema<std::string> {
+  std::optional<std::string> default_value;
+};
+
+using ParamSchemaVariant = std::variant<ParamSchema<bool>, ParamSchema<int64_t>, ParamSchema<std::string>>;
+
+enum class ChatState {
+  kIdle,
+  kInitted,
+  kLoading,
+  kLoadingFailed,
+  kStandby,
+  kConnecting,
+  kListening,
+  kSpeaking,
+};
+
+enum class ChatRole {
+  kAssistant,
+  kUser,
+};
+
+struct TextReceivedEvent {
+  std::string content;
+};
+
+struct ActivationEvent {
+  std::string code;
+  std::string message;
+};
+
+struct StateChangedEvent {
+  ChatState old_state;
+  ChatState new_state;
+};
+
+struct EmotionEvent {
+  std::string emotion;
+};
+
+struct ChatMessageEvent {
+  ChatRole role;
+  std::string content;
+};
+
+struct McpToolCallEvent {
+  int64_t id = 0;
+  std::string name;
+  std::map<std::string, std::variant<bool, int64_t, std::string>> params;
+
+  template <typename T>
+  const T* param(const std::string& key) const {
+    const auto it = params.find(key);
+    return it != params.end() ? std::get_if<T>(&it->second) : nullptr;
+  }
+
+  std::string ToString() const;
+};
+
+using Event =
+    std::variant<TextReceivedEvent, ActivationEvent, StateChangedEvent, EmotionEvent, ChatMessageEvent, McpToolCallEvent>;
+
+class Observer {
+ public:
+  std::list<Event> PopEvents();
+
+  // 以下仅用于主机测试
+  void Push(Event event);
+
+ private:
+  std::mutex mutex_;
+  std::list<Event> events_;
+};
+
+class Engine {
+ public:
+  // 记录的一次调用结果，error 为true时 value 为错误信息
+  struct McpResponse {
+    int64_t id;
+    bool error;
+    std::variant<bool, int64_t, std::string> value;
+  };
+
+  static Engine& GetInstance();
+
+  void SetObserver(std::shared_ptr<Observer> observer);
+  void SetOtaUrl(const std::string& url);
+  void ConfigWebsocket(const std::string& url, const std::map<std::string, std::string>& headers);
+  void AddMcpTool(const std::string& name,
+                  const std::string& description,
+                  const std::map<std::string, ParamSchemaVariant>& schema);
+  void Start(std::shared_ptr<AudioInputDevice> audio_input_device,
+             std::shared_ptr<AudioOutputDevice> audio_output_device);
+  void Advance();
+
+  void SendMcpCallResponse(int64_t id, bool result);
+  void SendMcpCallResponse(int64_t id, int64_t result);
+  void SendMcpCallResponse(int64_t id, const std::string& result);
+  void SendMcpCallResponse(int64_t id, const char* result);
+  // 其他整数类型与库一样按 int64_t 处理
+  template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>>
+  void SendMcpCallResponse(int64_t id, T result) {
+    SendMcpCallResponse(id, static_cast<int64_t>(result));
+  }
+  void SendMcpCallError(int64_t id, const std::string& message);
+
+  // 以下仅用于主机测试
+  std::shared_ptr<Observer> observer();
+  std::vector<std::string> declared_tools();
+  std::vector<McpResponse> TakeMcpResponses();
+  bool started();
+  uint32_t advance_count();
+
+ private:
+  void AddResponse(McpResponse response);
+
+  std::mutex mutex_;
+  std::shared_ptr<Observer> observer_;
+  std::vector<std::string> declared_tools_;
+  std::vector<McpResponse> responses_;
+  bool started_ = false;
+  uint32_t advance_count_ = 0;
+};
+
+}  // namespace ai_vox
+
+#endif
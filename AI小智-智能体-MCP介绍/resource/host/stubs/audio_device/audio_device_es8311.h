@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef _HOST_AUDIO_DEVICE_ES8311_H_
+#define _HOST_AUDIO_DEVICE_ES8311_H_
+
+#include <driver/gpio.h>
+#include <driver/i2c_master.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ai_vox_engine.h"
+
+namespace ai_vox {
+
+/**
+ * @brief 主机构建用的 ES8311 桩：写入的样本直接丢弃，只统计样本数
+ */
+class AudioDeviceEs8311 : public AudioInputDevice, public AudioOutputDevice {
+ public:
+  AudioDeviceEs8311(i2c_master_bus_handle_t i2c_master_handle,
+                    uint8_t i2c_address,
+                    i2c_port_t i2c_port,
+                    uint32_t sample_rate,
+                    gpio_num_t mclk,
+                    gpio_num_t bclk,
+                    gpio_num_t ws,
+                    gpio_num_t dout,
+                    gpio_num_t din);
+
+  bool OpenOutput(uint32_t sample_rate);
+  void CloseOutput();
+  size_t Write(int16_t* data, size_t samples);
+  void set_volume(uint16_t volume);
+  uint16_t volume() const;
+
+  // 以下仅用于主机测试
+  static AudioDeviceEs8311* instance();
+
+  bool output_opened() const {
+    return output_opened_;
+  }
+
+  uint64_t written_samples() const {
+    return written_samples_;
+  }
+
+ private:
+  std::atomic<bool> output_opened_{false};
+  std::atomic<uint64_t> written_samples_{0};
+  std::atomic<uint16_t> volume_{70};
+};
+
+}  // namespace ai_vox
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef _HOST_IOT_BUTTON_H_
+#define _HOST_IOT_BUTTON_H_
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+typedef struct button_dev_t* button_handle_t;
+
+typedef enum {
+  BUTTON_PRESS_DOWN = 0,
+  BUTTON_PRESS_UP,
+  BUTTON_SINGLE_CLICK,
+  BUTTON_LONG_PRESS_START,
+  BUTTON_EVENT_MAX,
+} button_event_t;
+
+typedef struct {
+  uint16_t long_press_time;
+  uint16_t short_press_time;
+} button_config_t;
+
+typedef void (*button_cb_t)(void* button_handle, void* usr_data);
+
+/**
+ * 按键由 host::PressButton() 触发，回调在调用者的线程中执行
+ */
+esp_err_t iot_button_register_cb(button_handle_t btn_handle, button_event_t event, void* event_args, button_cb_t cb,
+                                 void* usr_data);
+esp_err_t iot_button_unregister_cb(button_handle_t btn_handle, button_event_t event, void* event_args);
+esp_err_t iot_button_delete(button_handle_t btn_handle);
+
+#endif
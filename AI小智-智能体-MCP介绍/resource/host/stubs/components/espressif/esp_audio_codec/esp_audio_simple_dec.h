@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef _HOST_ESP_AUDIO_SIMPLE_DEC_H_
+#define _HOST_ESP_AUDIO_SIMPLE_DEC_H_
+
+/**
+ * @file esp_audio_simple_dec.h
+ * @brief 主机构建用的音频解码器桩
+ *
+ * 不做真正的 MP3 解码：每次处理消耗最多 144 字节输入，输出 576 个 16kHz 单声道样本。
+ * 用于测量提示音播放流水线(队列、格式转换、写入)本身的开销，不代表真实解码器的耗时。
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+typedef enum {
+  ESP_AUDIO_ERR_OK = 0,
+  ESP_AUDIO_ERR_FAIL = -1,
+  ESP_AUDIO_ERR_MEM_LACK = -2,
+  ESP_AUDIO_ERR_DATA_LACK = -3,
+  ESP_AUDIO_ERR_INVALID_PARAMETER = -4,
+  ESP_AUDIO_ERR_BUFF_NOT_ENOUGH = -5,
+} esp_audio_err_t;
+
+typedef enum {
+  ESP_AUDIO_TYPE_UNSUPPORT = 0,
+  ESP_AUDIO_TYPE_MP3 = 2,
+} esp_audio_type_t;
+
+typedef enum {
+  ESP_AUDIO_SIMPLE_DEC_TYPE_NONE = 0,
+  ESP_AUDIO_SIMPLE_DEC_TYPE_MP3 = 2,
+} esp_audio_simple_dec_type_t;
+
+typedef enum {
+  ESP_AUDIO_SIMPLE_DEC_RECOVERY_NONE = 0,
+  ESP_AUDIO_SIMPLE_DEC_RECOVERY_PLC = 1,
+} esp_audio_simple_dec_recovery_t;
+
+typedef void* esp_audio_simple_dec_handle_t;
+
+typedef struct {
+  esp_audio_simple_dec_type_t dec_type;
+  void* dec_cfg;
+  int cfg_size;
+} esp_audio_simple_dec_cfg_t;
+
+typedef struct {
+  uint8_t* buffer;
+  uint32_t len;
+  bool eos;
+  uint32_t consumed;
+  esp_audio_simple_dec_recovery_t frame_recover;
+} esp_audio_simple_dec_raw_t;
+
+typedef struct {
+  uint8_t* buffer;
+  uint32_t len;
+  uint32_t needed_size;
+  uint32_t decoded_size;
+} esp_audio_simple_dec_out_t;
+
+typedef struct {
+  uint32_t sample_rate;
+  uint8_t bits_per_sample;
+  uint8_t channel;
+  uint32_t bitrate;
+  uint32_t frame_size;
+} esp_audio_simple_dec_info_t;
+
+esp_audio_err_t esp_audio_simple_dec_open(esp_audio_simple_dec_cfg_t* config, esp_audio_simple_dec_handle_t* decoder);
+esp_audio_err_t esp_audio_simple_dec_process(esp_audio_simple_dec_handle_t decoder,
+                                             esp_audio_simple_dec_raw_t* raw,
+                                             esp_audio_simple_dec_out_t* frame);
+esp_audio_err_t esp_audio_simple_dec_get_info(esp_audio_simple_dec_handle_t decoder,
+                                              esp_audio_simple_dec_info_t* info);
+void esp_audio_simple_dec_close(esp_audio_simple_dec_handle_t decoder);
+esp_audio_err_t esp_audio_dec_unregister(esp_audio_type_t type);
+
+#endif
@@ -0,0 +1,10 @@
+#pragma once
+
+#ifndef _HOST_ESP_MP3_DEC_H_
+#define _HOST_ESP_MP3_DEC_H_
+
+#include "esp_audio_simple_dec.h"
+
+esp_audio_err_t esp_mp3_dec_register();
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef _HOST_WIFI_CONFIGURATOR_H_
+#define _HOST_WIFI_CONFIGURATOR_H_
+
+#include <WiFi.h>
+
+/**
+ * @brief 主机构建用的配网流程桩
+ *
+ * Start() 用WiFi中保存的凭据(没有时进入配网)连接，Start(ssid, password) 用给定凭据连接，
+ * 依次报告 kConnecting 和 kFinished。连接失败或调用 StartSmartConfig() 时报告 kSmartConfiguring，
+ * 随后模拟用户通过手机下发模拟AP的凭据并重新连接。
+ */
+class WifiConfigurator {
+ public:
+  enum class State {
+    kIdle,
+    kConnecting,
+    kSmartConfiguring,
+    kFinished,
+  };
+
+  WifiConfigurator(WiFiClass& wifi, smartconfig_type_t smartconfig_type);
+
+  void Start();
+  void Start(const char* ssid, const char* password);
+  void StartSmartConfig();
+  State WaitStateChanged();
+
+ private:
+  WiFiClass& wifi_;
+  State state_ = State::kIdle;
+  State reported_state_ = State::kIdle;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#ifndef _HOST_DISPLAY_H_
+#define _HOST_DISPLAY_H_
+
+/**
+ * @file display.h
+ * @brief 主机构建用的显示库桩，与固件的 Display 接口相同，只记录最近一次显示的内容
+ */
+
+#include <esp_lcd_panel_ops.h>
+
+#include <cstdint>
+#include <string>
+
+class Display {
+ public:
+  enum class Role : uint8_t {
+    kSystem,
+    kAssistant,
+    kUser,
+  };
+
+  Display(esp_lcd_panel_io_handle_t panel_io,
+          esp_lcd_panel_handle_t panel,
+          int width,
+          int height,
+          int offset_x,
+          int offset_y,
+          bool mirror_x,
+          bool mirror_y,
+          bool swap_xy);
+  ~Display();
+
+  void Start();
+  void SetChatMessage(const Role role, const std::string& content);
+  void ShowStatus(const char* status);
+  void SetEmotion(const std::string& emotion);
+
+  // 以下仅用于主机测试
+  static Display* instance();
+
+  const std::string& status() const {
+    return status_;
+  }
+
+  const std::string& emotion() const {
+    return emotion_;
+  }
+
+  const std::string& chat_message() const {
+    return chat_message_;
+  }
+
+  uint32_t chat_message_count() const {
+    return chat_message_count_;
+  }
+
+ private:
+  std::string status_;
+  std::string emotion_;
+  std::string chat_message_;
+  uint32_t chat_message_count_ = 0;
+};
+
+#endif
@@ -0,0 +1,37 @@
+#pragma once
+
+#ifndef _HOST_DRIVER_GPIO_H_
+#define _HOST_DRIVER_GPIO_H_
+
+typedef enum {
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0,
+  GPIO_NUM_1 = 1,
+  GPIO_NUM_2 = 2,
+  GPIO_NUM_3 = 3,
+  GPIO_NUM_4 = 4,
+  GPIO_NUM_5 = 5,
+  GPIO_NUM_6 = 6,
+  GPIO_NUM_7 = 7,
+  GPIO_NUM_8 = 8,
+  GPIO_NUM_9 = 9,
+  GPIO_NUM_10 = 10,
+  GPIO_NUM_11 = 11,
+  GPIO_NUM_12 = 12,
+  GPIO_NUM_13 = 13,
+  GPIO_NUM_14 = 14,
+  GPIO_NUM_15 = 15,
+  GPIO_NUM_16 = 16,
+  GPIO_NUM_17 = 17,
+  GPIO_NUM_18 = 18,
+  GPIO_NUM_21 = 21,
+  GPIO_NUM_38 = 38,
+  GPIO_NUM_39 = 39,
+  GPIO_NUM_40 = 40,
+  GPIO_NUM_41 = 41,
+  GPIO_NUM_42 = 42,
+  GPIO_NUM_47 = 47,
+  GPIO_NUM_48 = 48,
+} gpio_num_t;
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#ifndef _HOST_DRIVER_SPI_COMMON_H_
+#define _HOST_DRIVER_SPI_COMMON_H_
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+typedef enum {
+  SPI1_HOST = 0,
+  SPI2_HOST = 1,
+  SPI3_HOST = 2,
+} spi_host_device_t;
+
+typedef enum {
+  SPI_DMA_DISABLED = 0,
+  SPI_DMA_CH_AUTO = 3,
+} spi_common_dma_t;
+
+typedef enum {
+  ESP_INTR_CPU_AFFINITY_AUTO,
+  ESP_INTR_CPU_AFFINITY_0,
+  ESP_INTR_CPU_AFFINITY_1,
+} esp_intr_cpu_affinity_t;
+
+typedef struct {
+  int mosi_io_num;
+  int miso_io_num;
+  int sclk_io_num;
+  int quadwp_io_num;
+  int quadhd_io_num;
+  int data4_io_num;
+  int data5_io_num;
+  int data6_io_num;
+  int data7_io_num;
+  bool data_io_default_level;
+  int max_transfer_sz;
+  uint32_t flags;
+  esp_intr_cpu_affinity_t isr_cpu_id;
+  int intr_flags;
+} spi_bus_config_t;
+
+/**
+ * 只记录配置，通过 host::SpiBusConfig() 读取
+ */
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t* bus_config, spi_common_dma_t dma_chan);
+
+#endif
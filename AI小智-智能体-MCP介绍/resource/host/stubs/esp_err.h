@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef _HOST_ESP_ERR_H_
+#define _HOST_ESP_ERR_H_
+
+#include <cstdio>
+#include <cstdlib>
+
+typedef int esp_err_t;
+
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+#define ESP_ERR_INVALID_CRC 0x109
+
+const char* esp_err_to_name(esp_err_t code);
+
+// 与 ESP-IDF 相同，出错时打印位置后终止
+#define ESP_ERROR_CHECK(x)                                                                                   \
+  do {                                                                                                       \
+    const esp_err_t err_rc_ = (x);                                                                           \
+    if (err_rc_ != ESP_OK) {                                                                                 \
+      printf("ESP_ERROR_CHECK failed: %s (0x%x) at %s:%d\n", esp_err_to_name(err_rc_), err_rc_, __FILE__, \
+             __LINE__);                                                                                      \
+      abort();                                                                                               \
+    }                                                                                                        \
+  } while (0)
+
+#endif
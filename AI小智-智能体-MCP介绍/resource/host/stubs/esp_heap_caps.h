@@ -0,0 +1,35 @@
+#pragma once
+
+#ifndef _HOST_ESP_HEAP_CAPS_H_
+#define _HOST_ESP_HEAP_CAPS_H_
+
+/**
+ * @file esp_heap_caps.h
+ * @brief 主机构建用的 heap_caps 桩
+ *
+ * 分配转给 malloc，按内存类型(内部RAM/PSRAM)分别统计使用量，容量见 host/fakes/host_fakes.h。
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#define MALLOC_CAP_EXEC (1 << 0)
+#define MALLOC_CAP_32BIT (1 << 1)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+void* heap_caps_malloc(size_t size, uint32_t caps);
+void* heap_caps_calloc(size_t count, size_t size, uint32_t caps);
+void* heap_caps_realloc(void* ptr, size_t size, uint32_t caps);
+void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+void heap_caps_free(void* ptr);
+
+size_t heap_caps_get_total_size(uint32_t caps);
+size_t heap_caps_get_free_size(uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+size_t heap_caps_get_largest_free_block(uint32_t caps);
+
+#endif
@@ -0,0 +1,57 @@
+#pragma once
+
+#ifndef _HOST_ESP_LCD_PANEL_IO_H_
+#define _HOST_ESP_LCD_PANEL_IO_H_
+
+/**
+ * @file esp_lcd_panel_io.h
+ * @brief 主机构建用的 LCD panel IO 桩
+ *
+ * SPI panel IO 只统计收到的数据(host/fakes/host_fakes.h)，传输在调用返回前完成，
+ * 并在返回前调用传输完成回调。
+ */
+
+#include <cstddef>
+
+#include "driver/spi_common.h"
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+typedef struct {
+  void* user_data;
+} esp_lcd_panel_io_event_data_t;
+
+typedef bool (*esp_lcd_panel_io_color_trans_done_cb_t)(esp_lcd_panel_io_handle_t panel_io,
+                                                       esp_lcd_panel_io_event_data_t* edata,
+                                                       void* user_ctx);
+
+typedef struct {
+  esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+} esp_lcd_panel_io_callbacks_t;
+
+typedef struct {
+  int cs_gpio_num;
+  int dc_gpio_num;
+  int spi_mode;
+  unsigned int pclk_hz;
+  size_t trans_queue_depth;
+  esp_lcd_panel_io_color_trans_done_cb_t on_color_trans_done;
+  void* user_ctx;
+  int lcd_cmd_bits;
+  int lcd_param_bits;
+} esp_lcd_panel_io_spi_config_t;
+
+esp_err_t esp_lcd_new_panel_io_spi(spi_host_device_t bus,
+                                   const esp_lcd_panel_io_spi_config_t* io_config,
+                                   esp_lcd_panel_io_handle_t* ret_io);
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void* param, size_t param_size);
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void* param,
+                                    size_t param_size);
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void* color,
+                                    size_t color_size);
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io,
+                                                    const esp_lcd_panel_io_callbacks_t* cbs,
+                                                    void* user_ctx);
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io);
+
+#endif
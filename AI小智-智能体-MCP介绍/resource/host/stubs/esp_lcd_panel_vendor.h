@@ -0,0 +1,24 @@
+#pragma once
+
+#ifndef _HOST_ESP_LCD_PANEL_VENDOR_H_
+#define _HOST_ESP_LCD_PANEL_VENDOR_H_
+
+#include <cstdint>
+
+#include "esp_err.h"
+#include "esp_lcd_types.h"
+
+typedef struct {
+  int reset_gpio_num;
+  lcd_rgb_element_order_t rgb_ele_order;
+  uint32_t bits_per_pixel;
+} esp_lcd_panel_dev_config_t;
+
+/**
+ * 面板按 ST7789 的 CASET/RASET/RAMWR 命令序列通过 panel IO 发送 draw_bitmap 的数据
+ */
+esp_err_t esp_lcd_new_panel_st7789(esp_lcd_panel_io_handle_t io,
+                                   const esp_lcd_panel_dev_config_t* panel_dev_config,
+                                   esp_lcd_panel_handle_t* ret_panel);
+
+#endif
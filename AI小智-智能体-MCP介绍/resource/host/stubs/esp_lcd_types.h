@@ -0,0 +1,14 @@
+#pragma once
+
+#ifndef _HOST_ESP_LCD_TYPES_H_
+#define _HOST_ESP_LCD_TYPES_H_
+
+typedef struct esp_lcd_panel_io_t* esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t* esp_lcd_panel_handle_t;
+
+typedef enum {
+  LCD_RGB_ELEMENT_ORDER_RGB,
+  LCD_RGB_ELEMENT_ORDER_BGR,
+} lcd_rgb_element_order_t;
+
+#endif
@@ -0,0 +1,12 @@
+#pragma once
+
+#ifndef _HOST_ESP_MEMORY_UTILS_H_
+#define _HOST_ESP_MEMORY_UTILS_H_
+
+/**
+ * 与 ESP32-S3 相同，PSRAM(以 MALLOC_CAP_SPIRAM 从 heap_caps 分配)和映射的flash分区不是DMA内存，
+ * 其它内存(普通堆、栈、全局变量)视为内部RAM，都是DMA内存
+ */
+bool esp_ptr_dma_capable(const void* ptr);
+
+#endif
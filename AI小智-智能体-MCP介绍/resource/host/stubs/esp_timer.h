@@ -0,0 +1,13 @@
+#pragma once
+
+#ifndef _HOST_ESP_TIMER_H_
+#define _HOST_ESP_TIMER_H_
+
+#include <cstdint>
+
+/**
+ * 进程启动以来的微秒数(单调时钟)
+ */
+int64_t esp_timer_get_time();
+
+#endif
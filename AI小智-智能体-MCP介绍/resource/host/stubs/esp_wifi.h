@@ -0,0 +1,33 @@
+#pragma once
+
+#ifndef _HOST_ESP_WIFI_H_
+#define _HOST_ESP_WIFI_H_
+
+/**
+ * @file esp_wifi.h
+ * @brief 主机构建用的 esp_wifi 桩，只提供读取驱动保存的 STA 配置
+ *
+ * 与ESP32相同，保存的是最近一次 WiFi.begin() 使用的SSID和密码。
+ */
+
+#include <cstdint>
+
+#include "esp_err.h"
+
+typedef enum {
+  WIFI_IF_STA = 0,
+  WIFI_IF_AP = 1,
+} wifi_interface_t;
+
+typedef struct {
+  uint8_t ssid[32];      // 不一定以'\0'结尾
+  uint8_t password[64];  // 不一定以'\0'结尾
+} wifi_sta_config_t;
+
+typedef union {
+  wifi_sta_config_t sta;
+} wifi_config_t;
+
+esp_err_t esp_wifi_get_config(wifi_interface_t interface, wifi_config_t* conf);
+
+#endif
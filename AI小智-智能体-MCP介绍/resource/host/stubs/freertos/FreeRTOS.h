@@ -0,0 +1,52 @@
+#pragma once
+
+#ifndef _HOST_FREERTOS_H_
+#define _HOST_FREERTOS_H_
+
+/**
+ * @file FreeRTOS.h
+ * @brief 主机构建用的 FreeRTOS 桩，只声明本工程用到的部分，实现在 host/fakes/freertos.cpp 中
+ *
+ * 任务对应线程，1 tick 为 1 毫秒。
+ */
+
+#include <cstdint>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint8_t StackType_t;
+typedef void (*TaskFunction_t)(void*);
+
+typedef struct tskTaskControlBlock* TaskHandle_t;
+typedef struct QueueDefinition* QueueHandle_t;
+typedef QueueHandle_t SemaphoreHandle_t;
+typedef struct EventGroupDef_t* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdFAIL 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define portNUM_PROCESSORS 2
+#define configMAX_PRIORITIES 25
+#define tskIDLE_PRIORITY 0
+#define tskNO_AFFINITY 0x7fffffff
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks) ((uint32_t)(ticks))
+
+struct portMUX_TYPE {
+  uint32_t owner;
+  uint32_t count;
+};
+#define portMUX_INITIALIZER_UNLOCKED \
+  { 0, 0 }
+
+// 临界区用一把全局递归锁实现
+void portENTER_CRITICAL(portMUX_TYPE* mux);
+void portEXIT_CRITICAL(portMUX_TYPE* mux);
+BaseType_t xPortGetCoreID();
+
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#ifndef _HOST_FREERTOS_EVENT_GROUPS_H_
+#define _HOST_FREERTOS_EVENT_GROUPS_H_
+
+#include "freertos/FreeRTOS.h"
+
+EventGroupHandle_t xEventGroupCreate();
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group,
+                                EventBits_t bits,
+                                BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all,
+                                TickType_t ticks_to_wait);
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#ifndef _HOST_FREERTOS_QUEUE_H_
+#define _HOST_FREERTOS_QUEUE_H_
+
+#include "freertos/FreeRTOS.h"
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueReset(QueueHandle_t queue);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+
+#ifndef _HOST_FREERTOS_SEMPHR_H_
+#define _HOST_FREERTOS_SEMPHR_H_
+
+#include "freertos/queue.h"
+
+// 与 FreeRTOS 相同，信号量是元素大小为0的队列
+SemaphoreHandle_t xSemaphoreCreateBinary();
+SemaphoreHandle_t xSemaphoreCreateMutex();
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higher_priority_task_woken);
+void vSemaphoreDelete(SemaphoreHandle_t semaphore);
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifndef _HOST_FREERTOS_TASK_H_
+#define _HOST_FREERTOS_TASK_H_
+
+#include "freertos/FreeRTOS.h"
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function,
+                                   const char* name,
+                                   uint32_t stack_depth,
+                                   void* arg,
+                                   UBaseType_t priority,
+                                   TaskHandle_t* created_task,
+                                   BaseType_t core_id);
+BaseType_t xTaskCreate(TaskFunction_t function,
+                       const char* name,
+                       uint32_t stack_depth,
+                       void* arg,
+                       UBaseType_t priority,
+                       TaskHandle_t* created_task);
+
+/**
+ * 删除当前任务时退出线程；删除其它任务时做标记，该任务下次调用 FreeRTOS 函数时退出
+ */
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+void vTaskDelayUntil(TickType_t* previous_wake_time, TickType_t increment);
+TickType_t xTaskGetTickCount();
+TaskHandle_t xTaskGetCurrentTaskHandle();
+const char* pcTaskGetName(TaskHandle_t task);
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+
+/**
+ * 线程栈的实际使用量无法得到，返回创建任务时指定的栈大小
+ */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+void xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait);
+
+#endif
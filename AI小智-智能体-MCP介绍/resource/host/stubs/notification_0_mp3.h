@@ -0,0 +1,4 @@
+#pragma once
+
+// 主机构建用的提示音占位数据，由 esp_audio_simple_dec 桩按 144 字节一帧"解码"
+constexpr unsigned char kNotification0mp3[144 * 20] = {0x49, 0x44, 0x33};
@@ -0,0 +1,3 @@
+#pragma once
+
+// 主机构建不编译进WiFi账号，连接流程由模拟的AP和配网流程决定
@@ -0,0 +1,110 @@
+#include "arena.h"
+
+#include <esp_heap_caps.h>
+#include <gtest/gtest.h>
+#include <malloc.h>
+
+#include <string>
+
+#include "host_fakes.h"
+
+namespace {
+
+TEST(ArenaTest, AllocatesSequentiallyWithAlignment) {
+  Arena arena(256, MALLOC_CAP_SPIRAM);
+  auto a = static_cast<uint8_t*>(arena.Allocate(1, 1));
+  auto b = static_cast<uint8_t*>(arena.Allocate(1, 1));
+  EXPECT_EQ(b, a + 1);
+
+  auto c = arena.Allocate(8, 16);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 16, 0u);
+  EXPECT_LE(arena.used(), 32u);
+  EXPECT_EQ(arena.overflows(), 0u);
+}
+
+TEST(ArenaTest, TakesTheBlockFromTheRequestedHeap) {
+  const size_t free_before = heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+  {
+    Arena arena(4096, MALLOC_CAP_SPIRAM);
+    EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_SPIRAM), free_before - 4096);
+  }
+  EXPECT_EQ(heap_caps_get_free_size(MALLOC_CAP_SPIRAM), free_before);
+}
+
+TEST(ArenaTest, OverflowsToHeapAndResetReclaimsEverything) {
+  Arena arena(64, MALLOC_CAP_INTERNAL);
+  arena.Allocate(48);
+  auto big = static_cast<uint8_t*>(arena.Allocate(1000));
+  memset(big, 0xab, 1000);
+  EXPECT_EQ(arena.overflows(), 1u);
+  EXPECT_EQ(arena.high_water(), 48u);
+
+  arena.Reset();
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.high_water(), 48u);
+  // 复位后块内空间重新可用
+  arena.Allocate(64, 1);
+  EXPECT_EQ(arena.overflows(), 1u);
+}
+
+TEST(ArenaTest, RewindReturnsTailOfBlock) {
+  Arena arena(128, MALLOC_CAP_INTERNAL);
+  arena.Allocate(16);
+  const size_t mark = arena.used();
+  arena.Allocate(32);
+  arena.Rewind(mark);
+  EXPECT_EQ(arena.used(), mark);
+  // 不会前移
+  arena.Rewind(mark + 100);
+  EXPECT_EQ(arena.used(), mark);
+}
+
+TEST(ArenaTest, StringsAndContainersUseTheArena) {
+  Arena arena(1024, MALLOC_CAP_SPIRAM);
+  const auto before = host::GetAllocationStats();
+  {
+    ArenaString text(arena);
+    text += "temperature: ";
+    text += "25 degrees, humidity 40 percent";
+    ArenaVector<int> values(arena);
+    for (int i = 0; i < 20; i++) {
+      values.push_back(i);
+    }
+    EXPECT_EQ(text, "temperature: 25 degrees, humidity 40 percent");
+    EXPECT_EQ(values[19], 19);
+  }
+  EXPECT_STREQ(arena.CopyString("copy"), "copy");
+  EXPECT_EQ(host::GetAllocationStats().allocations, before.allocations);
+  EXPECT_EQ(arena.overflows(), 0u);
+}
+
+// 长时间反复使用(包括溢出到堆)后堆上没有净增长
+TEST(ArenaTest, SoakHasNoNetHeapGrowth) {
+  Arena arena(2048, MALLOC_CAP_SPIRAM);
+  const auto run_iteration = [&arena](int i) {
+    ArenaString text(arena);
+    for (int j = 0; j < 8 + i % 32; j++) {
+      text += "log line ";
+    }
+    arena.CopyString(text);
+    if (i % 7 == 0) {
+      arena.Allocate(4096);
+    }
+    arena.Reset();
+  };
+  for (int i = 0; i < 100; i++) {
+    run_iteration(i);
+  }
+
+  // 溢出块通过 aligned_alloc 分配，用 malloc 的统计检查
+  const auto counted_before = host::GetAllocationStats();
+  const size_t malloc_before = mallinfo2().uordblks;
+  for (int i = 0; i < 100000; i++) {
+    run_iteration(i);
+  }
+  EXPECT_EQ(mallinfo2().uordblks, malloc_before);
+  EXPECT_EQ(host::GetAllocationStats().live_bytes, counted_before.live_bytes);
+  EXPECT_GT(arena.overflows(), 0u);
+}
+
+}  // namespace
@@ -0,0 +1,214 @@
+#include "asset_pack.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+#include "esp_asset_partition.h"
+#include "host_fakes.h"
+
+namespace {
+
+struct TestAsset {
+  uint16_t id;
+  AssetEncoding encoding;
+  uint8_t channels;
+  uint32_t sample_rate;
+  std::vector<uint8_t> data;
+};
+
+// 按 tools/asset_pack_tool.cpp 的格式生成资源包
+std::vector<uint8_t> BuildPack(const std::vector<TestAsset>& assets) {
+  size_t offset = sizeof(AssetPackHeader) + assets.size() * sizeof(AssetPackEntry);
+  std::vector<AssetPackEntry> entries;
+  for (const auto& asset : assets) {
+    offset = (offset + kAssetPackAlignment - 1) / kAssetPackAlignment * kAssetPackAlignment;
+    entries.push_back({asset.id, static_cast<uint8_t>(asset.encoding), asset.channels, asset.sample_rate,
+                       static_cast<uint32_t>(offset), static_cast<uint32_t>(asset.data.size())});
+    offset += asset.data.size();
+  }
+
+  std::vector<uint8_t> pack(offset);
+  memcpy(pack.data() + sizeof(AssetPackHeader), entries.data(), entries.size() * sizeof(AssetPackEntry));
+  for (size_t i = 0; i < assets.size(); i++) {
+    memcpy(pack.data() + entries[i].offset, assets[i].data.data(), assets[i].data.size());
+  }
+  AssetPackHeader header;
+  memcpy(header.magic, kAssetPackMagic, sizeof(header.magic));
+  header.version = kAssetPackVersion;
+  header.asset_count = static_cast<uint16_t>(assets.size());
+  header.size = static_cast<uint32_t>(pack.size());
+  header.checksum = AssetPackChecksum(pack.data() + sizeof(header), pack.size() - sizeof(header));
+  memcpy(pack.data(), &header, sizeof(header));
+  return pack;
+}
+
+std::vector<uint8_t> DefaultPack() {
+  return BuildPack({
+      {1, AssetEncoding::kMp3, 0, 0, {0x49, 0x44, 0x33, 0x04, 0x00}},
+      {3, AssetEncoding::kPcm16, 1, 16000, {1, 0, 2, 0, 3, 0}},
+      {7, AssetEncoding::kPcm16, 2, 24000, {1, 0, 2, 0, 3, 0, 4, 0}},
+  });
+}
+
+AssetPackEntry* EntryAt(std::vector<uint8_t>& pack, size_t index) {
+  return reinterpret_cast<AssetPackEntry*>(pack.data() + sizeof(AssetPackHeader) + index * sizeof(AssetPackEntry));
+}
+
+// 改动偏移表后重新计算校验值，只让 Open() 的格式检查发现问题
+void Reseal(std::vector<uint8_t>& pack) {
+  const uint32_t checksum =
+      AssetPackChecksum(pack.data() + sizeof(AssetPackHeader), pack.size() - sizeof(AssetPackHeader));
+  memcpy(pack.data() + offsetof(AssetPackHeader, checksum), &checksum, sizeof(checksum));
+}
+
+TEST(AssetPackTest, OpensAndFindsAssets) {
+  const auto data = DefaultPack();
+  AssetPack pack;
+  ASSERT_TRUE(pack.Open(data.data(), data.size()));
+  EXPECT_TRUE(pack.Verify());
+  EXPECT_EQ(pack.asset_count(), 3u);
+  EXPECT_EQ(pack.size(), data.size());
+
+  const auto mp3 = pack.Find(1);
+  ASSERT_TRUE(mp3.has_value());
+  EXPECT_EQ(mp3->encoding, AssetEncoding::kMp3);
+  EXPECT_EQ(mp3->size, 5u);
+  EXPECT_EQ(mp3->data[0], 0x49);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(mp3->data) % kAssetPackAlignment, 0u);
+
+  const auto stereo = pack.Find(7);
+  ASSERT_TRUE(stereo.has_value());
+  EXPECT_EQ(stereo->channels, 2);
+  EXPECT_EQ(stereo->sample_rate, 24000u);
+  EXPECT_EQ(pack.at(1).id, 3);
+
+  EXPECT_FALSE(pack.Find(0).has_value());
+  EXPECT_FALSE(pack.Find(2).has_value());
+  EXPECT_FALSE(pack.Find(8).has_value());
+}
+
+TEST(AssetPackTest, AcceptsMappingLargerThanPack) {
+  auto data = DefaultPack();
+  const size_t pack_size = data.size();
+  data.resize(pack_size + 4096, 0xff);
+  AssetPack pack;
+  ASSERT_TRUE(pack.Open(data.data(), data.size()));
+  EXPECT_EQ(pack.size(), pack_size);
+  EXPECT_TRUE(pack.Verify());
+}
+
+TEST(AssetPackTest, RejectsTruncatedPack) {
+  const auto data = DefaultPack();
+  AssetPack pack;
+  EXPECT_FALSE(pack.Open(data.data(), sizeof(AssetPackHeader) - 1));
+  EXPECT_FALSE(pack.Open(data.data(), data.size() - 1));
+
+  // 头部声明的大小装不下偏移表
+  auto small = data;
+  const uint32_t size = sizeof(AssetPackHeader) + sizeof(AssetPackEntry);
+  memcpy(small.data() + offsetof(AssetPackHeader, size), &size, sizeof(size));
+  EXPECT_FALSE(pack.Open(small.data(), small.size()));
+  EXPECT_EQ(pack.asset_count(), 0u);
+}
+
+TEST(AssetPackTest, RejectsBadHeader) {
+  AssetPack pack;
+  auto magic = DefaultPack();
+  magic[0] = 'X';
+  EXPECT_FALSE(pack.Open(magic.data(), magic.size()));
+
+  auto version = DefaultPack();
+  const uint16_t next_version = kAssetPackVersion + 1;
+  memcpy(version.data() + offsetof(AssetPackHeader, version), &next_version, sizeof(next_version));
+  EXPECT_FALSE(pack.Open(version.data(), version.size()));
+
+  std::vector<uint8_t> unaligned(DefaultPack().size() + 1);
+  const auto data = DefaultPack();
+  memcpy(unaligned.data() + 1, data.data(), data.size());
+  EXPECT_FALSE(pack.Open(unaligned.data() + 1, data.size()));
+}
+
+TEST(AssetPackTest, RejectsDuplicateAndUnsortedIds) {
+  AssetPack pack;
+  auto duplicate = DefaultPack();
+  EntryAt(duplicate, 1)->id = 1;
+  Reseal(duplicate);
+  EXPECT_FALSE(pack.Open(duplicate.data(), duplicate.size()));
+
+  auto unsorted = DefaultPack();
+  EntryAt(unsorted, 2)->id = 2;
+  Reseal(unsorted);
+  EXPECT_FALSE(pack.Open(unsorted.data(), unsorted.size()));
+}
+
+TEST(AssetPackTest, RejectsBadEntries) {
+  AssetPack pack;
+  auto out_of_range = DefaultPack();
+  EntryAt(out_of_range, 2)->size += 1;
+  Reseal(out_of_range);
+  EXPECT_FALSE(pack.Open(out_of_range.data(), out_of_range.size()));
+
+  auto overlaps_table = DefaultPack();
+  EntryAt(overlaps_table, 0)->offset = sizeof(AssetPackHeader);
+  Reseal(overlaps_table);
+  EXPECT_FALSE(pack.Open(overlaps_table.data(), overlaps_table.size()));
+
+  auto misaligned = DefaultPack();
+  EntryAt(misaligned, 0)->offset += 1;
+  EntryAt(misaligned, 0)->size -= 1;
+  Reseal(misaligned);
+  EXPECT_FALSE(pack.Open(misaligned.data(), misaligned.size()));
+
+  auto odd_pcm = DefaultPack();
+  EntryAt(odd_pcm, 2)->size = 6;  // 双声道需要4字节的整数倍
+  Reseal(odd_pcm);
+  EXPECT_FALSE(pack.Open(odd_pcm.data(), odd_pcm.size()));
+
+  auto encoding = DefaultPack();
+  EntryAt(encoding, 0)->encoding = 9;
+  Reseal(encoding);
+  EXPECT_FALSE(pack.Open(encoding.data(), encoding.size()));
+}
+
+// 数据损坏不影响 Open()(只读头部和偏移表)，由 Verify() 发现
+TEST(AssetPackTest, VerifyDetectsCorruptData) {
+  auto data = DefaultPack();
+  data.back() ^= 0x01;
+  AssetPack pack;
+  ASSERT_TRUE(pack.Open(data.data(), data.size()));
+  EXPECT_FALSE(pack.Verify());
+
+  auto table = DefaultPack();
+  EntryAt(table, 0)->sample_rate = 1;
+  ASSERT_TRUE(pack.Open(table.data(), table.size()));
+  EXPECT_FALSE(pack.Verify());
+}
+
+TEST(EspAssetPartitionTest, MapsPartitionAndChecksPack) {
+  host::SetPartition("assets_test", DefaultPack());
+  {
+    EspAssetPartition partition;
+    ASSERT_TRUE(partition.Map("assets_test", true));
+    EXPECT_EQ(partition.pack().asset_count(), 3u);
+    EXPECT_TRUE(partition.pack().Find(3).has_value());
+    EXPECT_FALSE(partition.Map("missing", false));
+    EXPECT_EQ(partition.pack().asset_count(), 0u);
+  }
+
+  auto corrupt = DefaultPack();
+  corrupt.back() ^= 0x01;
+  host::SetPartition("assets_test", corrupt);
+  EspAssetPartition partition;
+  EXPECT_TRUE(partition.Map("assets_test", false));
+  EXPECT_FALSE(partition.Map("assets_test", true));
+
+  // 擦除后的分区(全 0xff)
+  host::SetPartition("assets_test", {});
+  EXPECT_FALSE(partition.Map("assets_test", false));
+  host::RemovePartition("assets_test");
+}
+
+}  // namespace
@@ -0,0 +1,62 @@
+#include "boot_graph.h"
+
+#include <Arduino.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace {
+
+class BootGraphTest : public testing::Test {
+ protected:
+  std::function<void()> Record(const char* name, uint32_t duration_ms = 0) {
+    return [this, name, duration_ms] {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_.push_back(name);
+      }
+      delay(duration_ms);
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_.push_back(name);
+    };
+  }
+
+  size_t IndexOf(const std::vector<std::string>& names, const std::string& name) {
+    return std::find(names.begin(), names.end(), name) - names.begin();
+  }
+
+  std::mutex mutex_;
+  std::vector<std::string> started_;
+  std::vector<std::string> finished_;
+};
+
+TEST_F(BootGraphTest, StartsStageOnlyAfterItsDependencies) {
+  BootGraph graph;
+  const auto i2c = graph.Add("i2c", Record("i2c", 20));
+  const auto button = graph.Add("button", Record("button", 5));
+  graph.Add("es8311", Record("es8311"), {i2c});
+  graph.Add("wifi_start", Record("wifi_start"), {button, i2c});
+  graph.Run();
+
+  ASSERT_EQ(finished_.size(), 4u);
+  EXPECT_LT(IndexOf(finished_, "i2c"), IndexOf(started_, "es8311"));
+  EXPECT_LT(IndexOf(finished_, "i2c"), IndexOf(started_, "wifi_start"));
+  EXPECT_LT(IndexOf(finished_, "button"), IndexOf(started_, "wifi_start"));
+}
+
+TEST_F(BootGraphTest, RunsIndependentStagesInParallel) {
+  BootGraph graph;
+  for (const char* name : {"led", "display", "i2c", "mcp_tools"}) {
+    graph.Add(name, Record(name, 100));
+  }
+  const auto start = millis();
+  graph.Run();
+  EXPECT_EQ(finished_.size(), 4u);
+  EXPECT_LT(millis() - start, 300u);
+}
+
+}  // namespace
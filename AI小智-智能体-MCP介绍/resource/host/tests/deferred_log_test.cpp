@@ -0,0 +1,55 @@
+#include "deferred_log.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+
+// 不启动日志任务，由测试调用 FlushDeferredLog() 输出
+std::string Flush() {
+  testing::internal::CaptureStdout();
+  FlushDeferredLog();
+  return testing::internal::GetCapturedStdout();
+}
+
+TEST(DeferredLogTest, FormatsArgumentsWhenFlushed) {
+  const std::string name = "self.led.set";
+  DLOGI("call %s id=%lld volume=%u ratio=%.2f c=%c %s\n", name, static_cast<long long>(-42), 35u, 0.5, 'x', "end");
+  EXPECT_EQ(Flush(), "call self.led.set id=-42 volume=35 ratio=0.50 c=x end\n");
+  EXPECT_EQ(Flush(), "");
+}
+
+TEST(DeferredLogTest, CopiesStringArguments) {
+  std::string text = "before";
+  DLOGI("%s\n", text);
+  text = "after";
+  EXPECT_EQ(Flush(), "before\n");
+}
+
+TEST(DeferredLogTest, TruncatesLongStrings) {
+  DLOGI("%s\n", std::string(kDeferredLogMaxStringLength + 50, 'a'));
+  EXPECT_EQ(Flush(), std::string(kDeferredLogMaxStringLength, 'a') + "\n");
+}
+
+TEST(DeferredLogTest, DropsRecordsWhenRingIsFull) {
+  const std::string text(kDeferredLogMaxStringLength, 'b');
+  const auto dropped = DeferredLogDroppedCount();
+  for (int i = 0; i < 200; i++) {
+    DLOGI("%d %s\n", i, text);
+  }
+  EXPECT_GT(DeferredLogDroppedCount(), dropped);
+
+  // 环绕写入后仍按顺序输出，并报告丢弃的条数
+  const auto output = Flush();
+  EXPECT_EQ(output.rfind("0 bbb", 0), 0u);
+  EXPECT_NE(output.find("messages dropped"), std::string::npos);
+  for (int i = 0; i < 200; i++) {
+    DLOGI("%d\n", i);
+  }
+  const auto wrapped = Flush();
+  EXPECT_EQ(wrapped.rfind("0\n1\n", 0), 0u);
+  EXPECT_NE(wrapped.find("199\n"), std::string::npos);
+}
+
+}  // namespace
@@ -0,0 +1,337 @@
+#include "ai_vox3_device.h"
+
+#include <Arduino.h>
+#include <audio_device/audio_device_es8311.h>
+#include <display.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "ai_vox_engine.h"
+#include "host_fakes.h"
+#include "latency_trace.h"
+#include "mcp_batch.h"
+
+namespace {
+
+std::atomic<uint32_t> g_user_handler_calls{0};
+
+// 每个测试在单独的进程中运行(gtest_discover_tests)，设备只初始化一次
+class DeviceTest : public testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    // 与 main.cpp 相同，在 InitializeDevice() 之前注册用户工具
+    RegisterUserMcpHandler("user.count", [](const ai_vox::McpToolCallEvent& event) {
+      SendMcpResult(event.id, static_cast<int64_t>(++g_user_handler_calls));
+    });
+    // 教程中的写法：直接调用引擎返回结果
+    RegisterUserMcpHandler("user.legacy", [](const ai_vox::McpToolCallEvent& event) {
+      ai_vox::Engine::GetInstance().SendMcpCallResponse(event.id, true);
+    });
+    RegisterUserMcpAsyncHandler(
+        "user.slow_echo",
+        [](const ai_vox::McpToolCallEvent& event, McpCallResponder& responder) {
+          delay(2);
+          const auto text = event.param<std::string>("text");
+          responder.Respond(text != nullptr ? *text : std::string());
+        },
+        1000);
+    RegisterUserMcpAsyncHandler(
+        "user.stuck",
+        [](const ai_vox::McpToolCallEvent&, McpCallResponder& responder) {
+          delay(300);
+          responder.Respond(true);
+        },
+        50, 1);
+    InitializeDevice();
+  }
+
+  static ai_vox::Engine& engine() {
+    return ai_vox::Engine::GetInstance();
+  }
+
+  static void Push(ai_vox::Event event) {
+    engine().observer()->Push(std::move(event));
+  }
+
+  static void CallTool(int64_t id, const std::string& name, decltype(ai_vox::McpToolCallEvent::params) params = {}) {
+    Push(ai_vox::McpToolCallEvent{id, name, std::move(params)});
+  }
+
+  // 运行主循环直到条件成立或超时
+  static bool RunLoopUntil(const std::function<bool()>& done, uint32_t timeout_ms = 2000) {
+    const auto start = millis();
+    while (!done()) {
+      if (millis() - start >= timeout_ms) {
+        return false;
+      }
+      ProcessMainLoop(5);
+    }
+    return true;
+  }
+
+  // 运行主循环直到收到指定调用的结果
+  static ai_vox::Engine::McpResponse WaitResponse(int64_t id) {
+    ai_vox::Engine::McpResponse response{-1, true, std::string("no response")};
+    RunLoopUntil([&] {
+      for (auto& item : engine().TakeMcpResponses()) {
+        if (item.id == id) {
+          response = std::move(item);
+        }
+      }
+      return response.id == id;
+    });
+    return response;
+  }
+};
+
+TEST_F(DeviceTest, StartsEngineAndDeclaresTools) {
+  EXPECT_TRUE(engine().started());
+  const auto tools = engine().declared_tools();
+  for (const char* name : {"self.audio_speaker.set_volume", "self.audio_speaker.get_volume",
+                           "self.led_strip.set_effect", "self.system.get_metrics", "self.batch"}) {
+    EXPECT_NE(std::find(tools.begin(), tools.end(), name), tools.end()) << name;
+  }
+  // LED 工具只处理调用，不向引擎声明
+  EXPECT_EQ(std::find(tools.begin(), tools.end(), "self.led.set"), tools.end());
+  EXPECT_EQ(host::LastWifiBegin().ssid, "host_ap");
+}
+
+TEST_F(DeviceTest, PrefetchesServerHostOnce) {
+  EXPECT_TRUE(RunLoopUntil([] { return !host::ResolvedHosts().empty(); }));
+  delay(50);
+  // OTA 和 WebSocket 使用同一个主机
+  EXPECT_EQ(host::ResolvedHosts(), std::vector<std::string>{"api.tenclass.net"});
+}
+
+TEST_F(DeviceTest, PlaysPromptsDuringInitialization) {
+  ASSERT_NE(ai_vox::AudioDeviceEs8311::instance(), nullptr);
+  EXPECT_GT(ai_vox::AudioDeviceEs8311::instance()->written_samples(), 0u);
+}
+
+// 显示库每次刷新10行(240 * 10 * 2 字节)，SPI 总线一次传输即可发送，且不按整帧分配DMA描述符
+TEST_F(DeviceTest, SizesDisplayBusForOneTransferPerFlush) {
+  const auto config = host::SpiBusConfig(SPI3_HOST);
+  EXPECT_GE(config.max_transfer_sz, 240 * 10 * 2);
+  EXPECT_LT(config.max_transfer_sz, 240 * 240 * 2);
+}
+
+TEST_F(DeviceTest, ShowsStateAndChatMessage) {
+  auto display = Display::instance();
+  ASSERT_NE(display, nullptr);
+
+  Push(ai_vox::StateChangedEvent{ai_vox::ChatState::kInitted, ai_vox::ChatState::kStandby});
+  Push(ai_vox::ChatMessageEvent{ai_vox::ChatRole::kAssistant, "你好，我是小智"});
+  EXPECT_TRUE(RunLoopUntil([&] { return display->chat_message() == "你好，我是小智"; }));
+  EXPECT_EQ(display->status(), "待命");
+
+  // 同一帧内的多条消息只刷新最后一条，且总是传递完整的消息
+  const auto count = display->chat_message_count();
+  delay(100);
+  Push(ai_vox::ChatMessageEvent{ai_vox::ChatRole::kAssistant, "你好"});
+  Push(ai_vox::ChatMessageEvent{ai_vox::ChatRole::kAssistant, "你好，今天天气很好"});
+  EXPECT_TRUE(RunLoopUntil([&] { return display->chat_message() == "你好，今天天气很好"; }));
+  EXPECT_EQ(display->chat_message_count(), count + 1);
+
+  // 不是上一条消息延续的新消息也完整显示
+  Push(ai_vox::ChatMessageEvent{ai_vox::ChatRole::kAssistant, "再见"});
+  EXPECT_TRUE(RunLoopUntil([&] { return display->chat_message() == "再见"; }));
+}
+
+TEST_F(DeviceTest, DispatchesBuiltinTools) {
+  CallTool(1, "self.audio_speaker.set_volume", {{"volume", int64_t{35}}});
+  auto response = WaitResponse(1);
+  EXPECT_FALSE(response.error);
+  EXPECT_EQ(response.value, (decltype(response.value){true}));
+  EXPECT_EQ(ai_vox::AudioDeviceEs8311::instance()->volume(), 35);
+
+  CallTool(2, "self.audio_speaker.get_volume");
+  response = WaitResponse(2);
+  EXPECT_EQ(response.value, (decltype(response.value){int64_t{35}}));
+
+  CallTool(3, "self.led.set", {{"state", true}});
+  EXPECT_FALSE(WaitResponse(3).error);
+  EXPECT_EQ(digitalRead(1), HIGH);
+
+  CallTool(4, "self.led_strip.set_effect", {{"effect", std::string("solid")}, {"color", int64_t{0xFF0000}}});
+  EXPECT_FALSE(WaitResponse(4).error);
+  EXPECT_TRUE(RunLoopUntil([] {
+    const auto pixels = host::LastLedStripFrame().pixels;
+    return pixels.size() >= 3 && pixels[0] == 255 && pixels[1] == 0 && pixels[2] == 0;
+  }));
+}
+
+TEST_F(DeviceTest, RejectsInvalidArguments) {
+  CallTool(1, "self.audio_speaker.set_volume", {{"volume", int64_t{101}}});
+  EXPECT_TRUE(WaitResponse(1).error);
+
+  CallTool(2, "self.led_strip.set_effect", {{"effect", std::string("sparkle")}});
+  EXPECT_TRUE(WaitResponse(2).error);
+}
+
+TEST_F(DeviceTest, ReportsUnknownTool) {
+  CallTool(1, "self.no_such_tool");
+  // 未知工具只记录错误，不发送响应
+  EXPECT_FALSE(RunLoopUntil([] { return !engine().TakeMcpResponses().empty(); }, 100));
+}
+
+TEST_F(DeviceTest, ReturnsMetricsJson) {
+  CallTool(1, "self.system.get_metrics");
+  const auto response = WaitResponse(1);
+  ASSERT_FALSE(response.error);
+  const auto json = std::get_if<std::string>(&response.value);
+  ASSERT_NE(json, nullptr);
+  EXPECT_EQ(json->front(), '{');
+  EXPECT_EQ(json->back(), '}');
+  EXPECT_NE(json->find("main_loop.iterations"), std::string::npos);
+  EXPECT_NE(json->find("mcp.calls.self.system.get_metrics"), std::string::npos);
+}
+
+// 每个工具都有一个调用计数，工具很多时输出超过默认的4KB缓冲区
+TEST_F(DeviceTest, ReturnsMetricsJsonWithManyTools) {
+  char name[32];
+  for (int i = 0; i < 200; i++) {
+    snprintf(name, sizeof(name), "user.tool_%03d", i);
+    RegisterUserMcpHandler(name, [](const ai_vox::McpToolCallEvent& event) { SendMcpResult(event.id, true); });
+  }
+  CallTool(1, "self.system.get_metrics");
+  const auto response = WaitResponse(1);
+  ASSERT_FALSE(response.error) << std::get<std::string>(response.value);
+  const auto json = std::get<std::string>(response.value);
+  EXPECT_GT(json.size(), 4096u);
+  EXPECT_EQ(json.back(), '}');
+  EXPECT_NE(json.find("\"mcp.calls.user.tool_199\":0"), std::string::npos);
+}
+
+TEST_F(DeviceTest, RunsBatchOfBuiltinAndUserTools) {
+  CallTool(1, "self.batch",
+           {{"calls",
+             std::string(R"([{"name":"self.led.set","arguments":{"state":false}},)"
+                         R"({"name":"user.count"},)"
+                         R"({"name":"user.slow_echo","arguments":{"text":"hi"}}])")}});
+  const auto response = WaitResponse(1);
+  ASSERT_FALSE(response.error);
+  const auto json = std::get_if<std::string>(&response.value);
+  ASSERT_NE(json, nullptr);
+  EXPECT_EQ(*json,
+            R"({"results":[{"name":"self.led.set","ok":true,"result":true},)"
+            R"({"name":"user.count","ok":true,"result":1},)"
+            R"({"name":"user.slow_echo","ok":true,"result":"hi"}]})");
+  EXPECT_EQ(digitalRead(1), LOW);
+}
+
+// 直接调用引擎的工具在批量调用中立即得到错误，不会等到批量调用超时
+TEST_F(DeviceTest, BatchReportsHandlersThatCallEngineDirectly) {
+  CallTool(1, "self.batch", {{"calls", std::string(R"([{"name":"user.legacy"},{"name":"user.count"}])")}});
+  const auto start = millis();
+  const auto response = WaitResponse(1);
+  EXPECT_LT(millis() - start, 1000u);
+  ASSERT_FALSE(response.error);
+  EXPECT_EQ(std::get<std::string>(response.value),
+            R"({"results":[{"name":"user.legacy","ok":false,"error":"Tool does not support self.batch"},)"
+            R"({"name":"user.count","ok":true,"result":1}]})");
+
+  // 批量调用之外照常工作
+  CallTool(2, "user.legacy");
+  EXPECT_EQ(WaitResponse(2).value, (decltype(response.value){true}));
+}
+
+// 含异步子调用的批量调用，追踪区间在发送汇总结果时才结束
+TEST_F(DeviceTest, TracesBatchUntilLastSubResult) {
+  CallTool(1, "self.batch", {{"calls", std::string(R"([{"name":"user.slow_echo","arguments":{"text":"a"}}])")}});
+  ASSERT_FALSE(WaitResponse(1).error);
+
+  testing::internal::CaptureStdout();
+  DumpChromeTrace();
+  const auto trace = testing::internal::GetCapturedStdout();
+  const auto record = trace.rfind(R"({"name":"self.batch","cat":"mcp")");
+  ASSERT_NE(record, std::string::npos) << trace;
+  const auto duration = trace.find("\"dur\":", record);
+  ASSERT_NE(duration, std::string::npos);
+  // user.slow_echo 在工作任务中至少执行2毫秒
+  EXPECT_GE(std::stoll(trace.substr(duration + 6)), 2000);
+}
+
+TEST_F(DeviceTest, DispatchesUserToolsRegisteredBeforeInit) {
+  const auto calls = g_user_handler_calls.load();
+  CallTool(7, "user.count");
+  EXPECT_EQ(WaitResponse(7).value, (decltype(ai_vox::Engine::McpResponse::value){int64_t{calls + 1}}));
+
+  CallTool(8, "user.slow_echo", {{"text", std::string("async")}});
+  EXPECT_EQ(WaitResponse(8).value, (decltype(ai_vox::Engine::McpResponse::value){std::string("async")}));
+}
+
+TEST_F(DeviceTest, AsyncToolTimesOutAndRejectsOverCap) {
+  CallTool(1, "user.stuck");
+  CallTool(2, "user.stuck");
+  // 超出同时执行的上限时立即返回错误
+  const auto busy = WaitResponse(2);
+  EXPECT_TRUE(busy.error);
+
+  const auto start = millis();
+  const auto timed_out = WaitResponse(1);
+  EXPECT_TRUE(timed_out.error);
+  EXPECT_LT(millis() - start, 250u);
+
+  // 超时之后的应答被忽略
+  EXPECT_FALSE(RunLoopUntil([] { return !engine().TakeMcpResponses().empty(); }, 400));
+}
+
+TEST_F(DeviceTest, MainLoopSleepsOnlyWhileIdle) {
+  engine().observer()->PopEvents();
+  auto start = millis();
+  ProcessMainLoop(50);
+  EXPECT_GE(millis() - start, 50u);
+
+  // 有事件时不等待
+  Push(ai_vox::EmotionEvent{"happy"});
+  start = millis();
+  ProcessMainLoop(1000);
+  EXPECT_LT(millis() - start, 500u);
+
+  start = millis();
+  ProcessMainLoop(0);
+  EXPECT_LT(millis() - start, 500u);
+
+  // 没有事件时默认也不等待，与加入空闲等待之前的调用方式行为相同
+  start = millis();
+  ProcessMainLoop();
+  EXPECT_LT(millis() - start, 20u);
+}
+
+// 长时间运行主循环(包括使用循环内存池的 JSON 响应和批量调用)后堆上没有净增长
+TEST_F(DeviceTest, MainLoopSoakHasNoNetHeapGrowth) {
+  const auto run_iterations = [](int count) {
+    for (int i = 0; i < count; i++) {
+      Push(ai_vox::StateChangedEvent{ai_vox::ChatState::kListening, ai_vox::ChatState::kSpeaking});
+      Push(ai_vox::ChatMessageEvent{ai_vox::ChatRole::kAssistant, "message " + std::to_string(i % 10)});
+      CallTool(i, i % 2 == 0 ? "self.system.get_metrics" : "self.led.get");
+      CallTool(i, "self.batch", {{"calls", std::string(R"([{"name":"self.led.get"},{"name":"user.count"}])")}});
+      ProcessMainLoop(0);
+      engine().TakeMcpResponses();
+    }
+  };
+  run_iterations(200);
+
+  const auto before = host::GetAllocationStats();
+  run_iterations(20000);
+  // 其它任务会周期性地短暂持有几百字节，取样时可能正好落在其中，等这部分释放后再比较；
+  // 主循环每次迭代哪怕只泄漏1字节，两万次后也不会回落
+  RunLoopUntil([&] { return host::GetAllocationStats().live_bytes <= before.live_bytes; }, 1000);
+  const auto after = host::GetAllocationStats();
+  EXPECT_LE(after.live_bytes, before.live_bytes);
+  EXPECT_GT(after.allocations, before.allocations);
+}
+
+TEST_F(DeviceTest, ButtonAdvancesEngine) {
+  const auto before = engine().advance_count();
+  host::PressButton(BUTTON_PRESS_DOWN);
+  EXPECT_EQ(engine().advance_count(), before + 1);
+}
+
+}  // namespace
@@ -0,0 +1,187 @@
+#include "i2c_bus_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "simulated_i2c_bus.h"
+
+namespace {
+
+constexpr uint16_t kSensorAddress = 0x23;
+constexpr uint16_t kCodecAddress = 0x18;
+
+class I2cBusManagerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    bus_.AddDevice(kSensorAddress);
+    bus_.AddDevice(kCodecAddress);
+    for (int reg = 0; reg < 256; reg++) {
+      bus_.SetRegister(kSensorAddress, static_cast<uint8_t>(reg), static_cast<uint8_t>(reg ^ 0x5a));
+    }
+    sensor_ = manager_.AddDevice({"sensor", kSensorAddress, I2cPriority::kLow, true});
+    codec_ = manager_.AddDevice({"codec", kCodecAddress, I2cPriority::kHigh, false});
+  }
+
+  void ProcessAll() {
+    while (manager_.ProcessOne()) {
+    }
+  }
+
+  SimulatedI2cBus bus_;
+  I2cBusManager manager_{bus_};
+  int sensor_ = -1;
+  int codec_ = -1;
+};
+
+TEST_F(I2cBusManagerTest, ReadsAndWritesRegisters) {
+  uint8_t data[3] = {};
+  bool done = false;
+  ASSERT_TRUE(manager_.ReadRegisters(sensor_, 0x10, data, sizeof(data), [&](bool ok) { done = ok; }));
+  ASSERT_TRUE(manager_.WriteRegister(codec_, 0x02, 0x7f));
+  ProcessAll();
+
+  EXPECT_TRUE(done);
+  EXPECT_EQ(data[0], 0x10 ^ 0x5a);
+  EXPECT_EQ(data[2], 0x12 ^ 0x5a);
+  EXPECT_EQ(bus_.GetRegister(kCodecAddress, 0x02), 0x7f);
+  EXPECT_FALSE(manager_.ProcessOne());
+}
+
+TEST_F(I2cBusManagerTest, RunsHigherPriorityDevicesFirst) {
+  std::vector<int> order;
+  uint8_t data = 0;
+  manager_.ReadRegisters(sensor_, 0x00, &data, 1, [&](bool) { order.push_back(sensor_); });
+  manager_.WriteRegister(codec_, 0x00, 1, [&](bool) { order.push_back(codec_); });
+  manager_.ReadRegisters(sensor_, 0x40, &data, 1, [&](bool) { order.push_back(sensor_); });
+  ProcessAll();
+
+  EXPECT_EQ(order, (std::vector<int>{codec_, sensor_, sensor_}));
+}
+
+TEST_F(I2cBusManagerTest, MergesAdjacentRegisterReads) {
+  uint8_t a[2] = {};
+  uint8_t b[4] = {};
+  uint8_t c[1] = {};
+  int completed = 0;
+  const auto count = [&](bool ok) { completed += ok; };
+  manager_.ReadRegisters(sensor_, 0x20, a, sizeof(a), count);
+  manager_.ReadRegisters(sensor_, 0x22, b, sizeof(b), count);
+  // 不相邻，单独传输
+  manager_.ReadRegisters(sensor_, 0x30, c, sizeof(c), count);
+  ProcessAll();
+
+  EXPECT_EQ(completed, 3);
+  EXPECT_EQ(bus_.transfers(), 2u);
+  EXPECT_EQ(a[1], 0x21 ^ 0x5a);
+  EXPECT_EQ(b[0], 0x22 ^ 0x5a);
+  EXPECT_EQ(b[3], 0x25 ^ 0x5a);
+  EXPECT_EQ(c[0], 0x30 ^ 0x5a);
+
+  I2cDeviceStats stats;
+  ASSERT_TRUE(manager_.GetStats(sensor_, &stats));
+  EXPECT_EQ(stats.transactions, 3u);
+  EXPECT_EQ(stats.transfers, 2u);
+  EXPECT_EQ(stats.errors, 0u);
+}
+
+TEST_F(I2cBusManagerTest, DoesNotMergeWithoutAutoIncrement) {
+  const int plain = manager_.AddDevice({"plain", kSensorAddress, I2cPriority::kNormal, false});
+  uint8_t a = 0;
+  uint8_t b = 0;
+  manager_.ReadRegisters(plain, 0x20, &a, 1);
+  manager_.ReadRegisters(plain, 0x21, &b, 1);
+  ProcessAll();
+
+  EXPECT_EQ(bus_.transfers(), 2u);
+  EXPECT_EQ(b, 0x21 ^ 0x5a);
+}
+
+TEST_F(I2cBusManagerTest, ReportsFailingDevice) {
+  bus_.SetFailing(kCodecAddress, true);
+  bool result = true;
+  manager_.WriteRegister(codec_, 0x00, 1, [&](bool ok) { result = ok; });
+  ProcessAll();
+
+  EXPECT_FALSE(result);
+  I2cDeviceStats stats;
+  manager_.GetStats(codec_, &stats);
+  EXPECT_EQ(stats.errors, 1u);
+}
+
+TEST_F(I2cBusManagerTest, RejectsInvalidRequestsAndFullQueue) {
+  uint8_t data[I2cBusManager::kMaxWriteSize + 1] = {};
+  EXPECT_FALSE(manager_.Write(codec_, data, sizeof(data)));
+  EXPECT_FALSE(manager_.ReadRegisters(codec_, 0, data, 0));
+  EXPECT_FALSE(manager_.WriteRegister(99, 0, 0));
+
+  for (size_t i = 0; i < I2cBusManager::kMaxQueueDepth; i++) {
+    ASSERT_TRUE(manager_.WriteRegister(codec_, 0, 0));
+  }
+  EXPECT_FALSE(manager_.WriteRegister(codec_, 0, 0));
+  I2cDeviceStats stats;
+  manager_.GetStats(codec_, &stats);
+  EXPECT_EQ(stats.dropped, 1u);
+}
+
+TEST_F(I2cBusManagerTest, SyncCallsWaitForWorker) {
+  std::thread worker([this] { manager_.Run(); });
+  uint8_t value = 0;
+  EXPECT_TRUE(manager_.WriteRegisterSync(codec_, 0x05, 0x33));
+  EXPECT_EQ(bus_.GetRegister(kCodecAddress, 0x05), 0x33);
+  EXPECT_TRUE(manager_.ReadRegistersSync(sensor_, 0x05, &value, 1));
+  EXPECT_EQ(value, 0x05 ^ 0x5a);
+
+  bus_.SetFailing(kSensorAddress, true);
+  EXPECT_FALSE(manager_.ReadRegistersSync(sensor_, 0x05, &value, 1));
+
+  manager_.Stop();
+  worker.join();
+}
+
+TEST_F(I2cBusManagerTest, StopFailsQueuedTransactionsAndRejectsNewOnes) {
+  std::vector<bool> results;
+  uint8_t data = 0;
+  manager_.ReadRegisters(sensor_, 0x00, &data, 1, [&](bool ok) { results.push_back(ok); });
+  manager_.WriteRegister(codec_, 0x00, 1, [&](bool ok) { results.push_back(ok); });
+  manager_.Stop();
+
+  EXPECT_EQ(results, (std::vector<bool>{false, false}));
+  EXPECT_EQ(bus_.transfers(), 0u);
+  EXPECT_FALSE(manager_.ProcessOne());
+  EXPECT_FALSE(manager_.WriteRegister(codec_, 0x00, 1));
+  I2cDeviceStats stats;
+  manager_.GetStats(sensor_, &stats);
+  EXPECT_EQ(stats.errors, 1u);
+}
+
+// 工作任务正在执行事务时 Stop()：当前事务正常完成，排队的事务失败，等待中的同步调用都能返回
+TEST_F(I2cBusManagerTest, StopWhileRunningReleasesSyncCallers) {
+  SimulatedI2cBus slow_bus(20000);
+  slow_bus.AddDevice(kCodecAddress);
+  I2cBusManager manager(slow_bus);
+  const int codec = manager.AddDevice({"codec", kCodecAddress, I2cPriority::kHigh, false});
+  std::thread worker([&manager] { manager.Run(); });
+
+  std::vector<std::thread> callers;
+  std::atomic<int> returned{0};
+  for (int i = 0; i < 4; i++) {
+    callers.emplace_back([&manager, &returned, codec, i] {
+      manager.WriteRegisterSync(codec, static_cast<uint8_t>(i), 1);
+      returned++;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  manager.Stop();
+  worker.join();
+  for (auto& caller : callers) {
+    caller.join();
+  }
+  EXPECT_EQ(returned, 4);
+  EXPECT_LE(slow_bus.transfers(), 1u);
+}
+
+}  // namespace
@@ -0,0 +1,134 @@
+#include "json_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "host_fakes.h"
+
+namespace {
+
+TEST(JsonWriterTest, WritesNestedObjectsWithCommas) {
+  char buffer[256];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginObject();
+  writer.Field("status", "success");
+  writer.Field("temperature", 25);
+  writer.Field("humidity", 40.5);
+  writer.Field("on", true);
+  writer.Key("list").BeginArray().Int(-1).Uint(2).Null().BeginObject().EndObject().EndArray();
+  writer.EndObject();
+
+  EXPECT_TRUE(writer.ok());
+  EXPECT_STREQ(writer.c_str(),
+               R"({"status":"success","temperature":25,"humidity":40.5,"on":true,"list":[-1,2,null,{}]})");
+  EXPECT_EQ(writer.size(), strlen(writer.c_str()));
+}
+
+TEST(JsonWriterTest, EscapesQuotesBackslashesAndControlCharacters) {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.String("a\"b\\c\nd\x01 中文");
+
+  EXPECT_TRUE(writer.ok());
+  EXPECT_STREQ(writer.c_str(), "\"a\\\"b\\\\c\\u000ad\\u0001 中文\"");
+}
+
+TEST(JsonWriterTest, WritesNonFiniteDoublesAsNull) {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginArray().Double(NAN).Double(INFINITY).Double(0.25).EndArray();
+
+  EXPECT_STREQ(writer.c_str(), "[null,null,0.25]");
+}
+
+TEST(JsonWriterTest, RawIsCopiedAsValue) {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginObject().Key("a").Raw("[1,2]").Key("b").Raw("{}").EndObject();
+
+  EXPECT_TRUE(writer.ok());
+  EXPECT_STREQ(writer.c_str(), R"({"a":[1,2],"b":{}})");
+}
+
+TEST(JsonWriterTest, OverflowStopsWritingWithoutPassingCapacity) {
+  char buffer[16];
+  memset(buffer, 'x', sizeof(buffer));
+  JsonWriter writer(buffer + 1, 8);
+  writer.BeginObject().Field("key", "a long value").EndObject();
+
+  EXPECT_TRUE(writer.overflow());
+  EXPECT_FALSE(writer.ok());
+  EXPECT_LT(writer.size(), 8u);
+  EXPECT_EQ(writer.c_str()[writer.size()], '\0');
+  EXPECT_EQ(buffer[0], 'x');
+  EXPECT_EQ(buffer[9], 'x');
+}
+
+TEST(JsonWriterTest, RequiredCountsBytesPastOverflow) {
+  JsonWriter counter(nullptr, 0);
+  counter.BeginObject().Field("key", "a long value").Field("n", 12345).EndObject();
+  EXPECT_TRUE(counter.overflow());
+
+  std::vector<char> buffer(counter.required());
+  JsonWriter writer(buffer.data(), buffer.size());
+  writer.BeginObject().Field("key", "a long value").Field("n", 12345).EndObject();
+  EXPECT_TRUE(writer.ok());
+  EXPECT_EQ(writer.required(), writer.size() + 1);
+  EXPECT_EQ(writer.required(), counter.required());
+
+  writer.Reset();
+  EXPECT_EQ(writer.required(), 1u);
+}
+
+TEST(JsonWriterTest, NotOkUntilEverythingIsClosed) {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  EXPECT_FALSE(writer.ok());
+  writer.BeginObject().Key("a");
+  EXPECT_FALSE(writer.ok());
+  writer.Int(1);
+  EXPECT_FALSE(writer.ok());
+  writer.EndObject();
+  EXPECT_TRUE(writer.ok());
+
+  writer.EndObject();
+  EXPECT_TRUE(writer.overflow());
+}
+
+TEST(JsonWriterTest, ResetReusesTheBuffer) {
+  char buffer[64];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.BeginArray().Int(1).EndArray();
+  writer.Reset();
+  writer.BeginArray().Int(2).EndArray();
+
+  EXPECT_STREQ(writer.c_str(), "[2]");
+}
+
+TEST(JsonWriterTest, RejectsNestingDeeperThanLimit) {
+  char buffer[256];
+  JsonWriter writer(buffer, sizeof(buffer));
+  for (int i = 0; i < 33; i++) {
+    writer.BeginArray();
+  }
+  EXPECT_TRUE(writer.overflow());
+}
+
+// 写入不分配内存，对比用 std::string 拼接同样的内容
+TEST(JsonWriterTest, DoesNotAllocate) {
+  char buffer[256];
+  const auto before = host::GetAllocationStats();
+  JsonWriter writer(buffer, sizeof(buffer));
+  for (int i = 0; i < 100; i++) {
+    writer.Reset();
+    writer.BeginObject().Field("status", "success").Field("temperature", i).Field("name", "sensor").EndObject();
+  }
+  const auto after = host::GetAllocationStats();
+  EXPECT_TRUE(writer.ok());
+  EXPECT_EQ(after.allocations, before.allocations);
+}
+
+}  // namespace
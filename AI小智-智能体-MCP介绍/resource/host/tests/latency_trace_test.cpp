@@ -0,0 +1,72 @@
+#include "latency_trace.h"
+
+#include <Arduino.h>
+#include <gtest/gtest.h>
+
+#include <string>
+
+namespace {
+
+// 每个测试在单独的进程中运行，追踪状态从空开始
+std::string Capture(void (*print)()) {
+  testing::internal::CaptureStdout();
+  print();
+  return testing::internal::GetCapturedStdout();
+}
+
+// 返回 Chrome trace 中名为 name 的区间的时长(微秒)，不存在时返回-1
+int64_t SpanDuration(const std::string& trace, const std::string& name) {
+  const auto record = trace.find("{\"name\":\"" + name + "\"");
+  if (record == std::string::npos) {
+    return -1;
+  }
+  const auto dur = trace.find("\"dur\":", record);
+  return dur == std::string::npos ? -1 : std::stoll(trace.substr(dur + 6));
+}
+
+TEST(LatencyTraceTest, ClosesSyncCallWhenHandlerReturns) {
+  TraceMcpCallStart(1, "tool.sync");
+  TraceMcpCallReturned(1);
+  delay(20);
+  TraceMcpCallEnd(1);
+
+  const auto trace = Capture(DumpChromeTrace);
+  EXPECT_GE(SpanDuration(trace, "tool.sync"), 0);
+  EXPECT_LT(SpanDuration(trace, "tool.sync"), 20000);
+  EXPECT_NE(Capture(PrintLatencyHistograms).find("latency mcp_call_to_response: 1 samples"), std::string::npos);
+}
+
+TEST(LatencyTraceTest, ClosesDeferredCallWhenResponseIsSent) {
+  TraceMcpCallStart(1, "tool.async");
+  TraceMcpCallDeferred(1);
+  TraceMcpCallReturned(1);
+  EXPECT_EQ(SpanDuration(Capture(DumpChromeTrace), "tool.async"), -1);
+
+  delay(20);
+  TraceMcpCallEnd(1);
+  EXPECT_GE(SpanDuration(Capture(DumpChromeTrace), "tool.async"), 20000);
+}
+
+TEST(LatencyTraceTest, RecordsConversationStagesAndStateSpans) {
+  TraceButtonPress();
+  TraceStateChanged(ai_vox::ChatState::kConnecting);
+  TraceStateChanged(ai_vox::ChatState::kListening);
+  delay(60);
+  TraceChatMessage(ai_vox::ChatRole::kUser);
+  TraceStateChanged(ai_vox::ChatState::kSpeaking);
+  TraceStateChanged(ai_vox::ChatState::kStandby);
+
+  const auto histograms = Capture(PrintLatencyHistograms);
+  EXPECT_NE(histograms.find("latency button_to_listening: 1 samples"), std::string::npos);
+  EXPECT_NE(histograms.find("latency listening_to_first_message: 1 samples"), std::string::npos);
+  EXPECT_NE(histograms.find("latency listening_to_speaking: 1 samples"), std::string::npos);
+  // 至少60ms，不落在最小的分桶中
+  EXPECT_NE(histograms.find("<=50:0 "), std::string::npos);
+
+  const auto trace = Capture(DumpChromeTrace);
+  EXPECT_GE(SpanDuration(trace, "Listening"), 60000);
+  EXPECT_NE(trace.find("\"ButtonPress\""), std::string::npos);
+  EXPECT_NE(trace.find("\"UserMessage\""), std::string::npos);
+}
+
+}  // namespace
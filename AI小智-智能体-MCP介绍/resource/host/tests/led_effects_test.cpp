@@ -0,0 +1,66 @@
+#include "led_effects.h"
+
+#include <Arduino.h>
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <vector>
+
+#include "host_fakes.h"
+
+namespace {
+
+constexpr uint32_t kLedCount = 8;
+
+bool WaitUntil(const std::function<bool()>& done, uint32_t timeout_ms = 1000) {
+  const auto start = millis();
+  while (!done()) {
+    if (millis() - start >= timeout_ms) {
+      return false;
+    }
+    delay(5);
+  }
+  return true;
+}
+
+std::vector<uint8_t> Repeat(uint8_t red, uint8_t green, uint8_t blue) {
+  std::vector<uint8_t> pixels;
+  for (uint32_t i = 0; i < kLedCount; i++) {
+    pixels.insert(pixels.end(), {red, green, blue});
+  }
+  return pixels;
+}
+
+class LedEffectsTest : public testing::Test {
+ protected:
+  // 与固件一样不销毁，动画任务一直存在
+  LedEffects* effects_ = new LedEffects(GPIO_NUM_2, kLedCount);
+};
+
+TEST_F(LedEffectsTest, ShowsSolidColorAndRefreshesOnlyOnChange) {
+  effects_->SetEffect({LedEffects::Mode::kSolid, 0xFF8000, 1000});
+  // 0x80 经过 gamma 2.2 后为 56
+  ASSERT_TRUE(WaitUntil([] { return host::LastLedStripFrame().pixels == Repeat(255, 56, 0); }));
+
+  const auto refresh_count = host::LastLedStripFrame().refresh_count;
+  delay(200);
+  EXPECT_EQ(host::LastLedStripFrame().refresh_count, refresh_count);
+}
+
+TEST_F(LedEffectsTest, ScalesByBrightness) {
+  effects_->SetEffect({LedEffects::Mode::kSolid, 0xFFFFFF, 1000});
+  ASSERT_TRUE(WaitUntil([] { return host::LastLedStripFrame().pixels == Repeat(255, 255, 255); }));
+  effects_->SetBrightness(0);
+  EXPECT_TRUE(WaitUntil([] { return host::LastLedStripFrame().pixels == Repeat(0, 0, 0); }));
+}
+
+TEST_F(LedEffectsTest, AnimatesBreatheUntilTurnedOff) {
+  effects_->SetEffect({LedEffects::Mode::kBreathe, 0x0000FF, 200});
+  const auto refresh_count = host::LastLedStripFrame().refresh_count;
+  EXPECT_TRUE(WaitUntil([&] { return host::LastLedStripFrame().refresh_count >= refresh_count + 5; }));
+
+  effects_->SetEffect({LedEffects::Mode::kOff, 0, 1000});
+  EXPECT_TRUE(WaitUntil([] { return host::LastLedStripFrame().pixels == Repeat(0, 0, 0); }));
+}
+
+}  // namespace
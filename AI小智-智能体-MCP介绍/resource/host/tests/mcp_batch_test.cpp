@@ -0,0 +1,187 @@
+#include "mcp_batch.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "ai_vox_engine.h"
+
+namespace {
+
+std::vector<ai_vox::McpToolCallEvent> g_dispatched;
+std::vector<int64_t> g_deferred;
+
+// 测试用分发表：t.echo 返回参数 v，t.json 返回 JSON，t.fail 返回错误，t.later 稍后由测试返回结果，
+// t.direct 像旧式工具一样直接调用引擎
+bool Dispatch(const ai_vox::McpToolCallEvent& event) {
+  g_dispatched.push_back(event);
+  if (event.name == "t.echo") {
+    const auto value = event.param<std::string>("v");
+    SendMcpResult(event.id, value != nullptr ? *value : std::string());
+  } else if (event.name == "t.int") {
+    const auto value = event.param<int64_t>("v");
+    SendMcpResult(event.id, value != nullptr ? *value : int64_t{0});
+  } else if (event.name == "t.json") {
+    SendMcpJsonResult(event.id, R"({"a":[1,2]})");
+  } else if (event.name == "t.fail") {
+    SendMcpErrorResult(event.id, "broken");
+  } else if (event.name == "t.later") {
+    DeferMcpResult(event.id);
+    g_deferred.push_back(event.id);
+  } else if (event.name == "t.direct") {
+    ai_vox::Engine::GetInstance().SendMcpCallResponse(event.id, true);
+  } else {
+    return false;
+  }
+  return true;
+}
+
+class McpBatchTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    g_dispatched.clear();
+    g_deferred.clear();
+    ai_vox::Engine::GetInstance().TakeMcpResponses();
+  }
+
+  std::vector<ai_vox::Engine::McpResponse> Responses() {
+    return ai_vox::Engine::GetInstance().TakeMcpResponses();
+  }
+
+  std::string RunError(const std::string& calls) {
+    std::string error;
+    EXPECT_FALSE(RunMcpBatch(1, calls, Dispatch, &error));
+    EXPECT_TRUE(g_dispatched.empty());
+    return error;
+  }
+};
+
+TEST_F(McpBatchTest, RunsEveryCallAndSendsOneCombinedResult) {
+  std::string error;
+  ASSERT_TRUE(RunMcpBatch(7,
+                          R"( [ {"name":"t.echo","arguments":{"v":"hi"}},
+                                {"name":"t.int","arguments":{"v":-42}},
+                                {"name":"t.json"},
+                                {"name":"t.fail","arguments":{}} ] )",
+                          Dispatch,
+                          &error));
+
+  ASSERT_EQ(g_dispatched.size(), 4u);
+  for (const auto& call : g_dispatched) {
+    EXPECT_LT(call.id, 0);
+  }
+  const auto responses = Responses();
+  ASSERT_EQ(responses.size(), 1u);
+  EXPECT_EQ(responses[0].id, 7);
+  EXPECT_FALSE(responses[0].error);
+  EXPECT_EQ(std::get<std::string>(responses[0].value),
+            R"({"results":[{"name":"t.echo","ok":true,"result":"hi"},)"
+            R"({"name":"t.int","ok":true,"result":-42},)"
+            R"({"name":"t.json","ok":true,"result":{"a":[1,2]}},)"
+            R"({"name":"t.fail","ok":false,"error":"broken"}]})");
+}
+
+TEST_F(McpBatchTest, ParsesArgumentTypesAndEscapes) {
+  std::string error;
+  ASSERT_TRUE(RunMcpBatch(
+      1,
+      R"([{"name":"t.echo","arguments":{"v":"a\"\\\/\n中😀","b":true,"c":false,"n":null,"i":9223372036854775807}}])",
+      Dispatch,
+      &error));
+
+  ASSERT_EQ(g_dispatched.size(), 1u);
+  const auto& call = g_dispatched[0];
+  EXPECT_EQ(*call.param<std::string>("v"), "a\"\\/\n中😀");
+  EXPECT_EQ(*call.param<bool>("b"), true);
+  EXPECT_EQ(*call.param<bool>("c"), false);
+  EXPECT_EQ(call.param<bool>("n"), nullptr);
+  EXPECT_EQ(*call.param<int64_t>("i"), INT64_MAX);
+}
+
+TEST_F(McpBatchTest, RejectsMalformedInput) {
+  EXPECT_EQ(RunError(R"({"name":"t.echo"})"), "expected an array");
+  EXPECT_EQ(RunError("[]"), "empty batch");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo"} {"name":"t.echo"}])"), "expected ',' or ']'");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo"}] x)"), "unexpected trailing characters");
+  EXPECT_EQ(RunError(R"([{"arguments":{}}])"), "missing name");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo","extra":1}])"), "unknown key in call");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo","arguments":{"v":1.5}}])"), "only integer numbers are supported");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo","arguments":{"v":9223372036854775808}}])"), "integer out of range");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo","arguments":{"v":[1]}}])"), "unsupported argument value");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo","arguments":{"v":"\ud800"}}])"), "invalid surrogate pair");
+  EXPECT_EQ(RunError(R"([{"name":"t.echo)"), "unterminated string");
+  EXPECT_TRUE(Responses().empty());
+}
+
+TEST_F(McpBatchTest, RejectsMoreThanEightCalls) {
+  std::string calls = "[";
+  for (int i = 0; i < 9; i++) {
+    calls += std::string(i > 0 ? "," : "") + R"({"name":"t.echo"})";
+  }
+  calls += "]";
+  EXPECT_EQ(RunError(calls), "too many calls");
+}
+
+TEST_F(McpBatchTest, ReportsNestedBatchAndUnknownTools) {
+  std::string error;
+  ASSERT_TRUE(RunMcpBatch(3, R"([{"name":"self.batch"},{"name":"t.missing"}])", Dispatch, &error));
+
+  const auto responses = Responses();
+  ASSERT_EQ(responses.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(responses[0].value),
+            R"({"results":[{"name":"self.batch","ok":false,"error":"Nested self.batch is not allowed"},)"
+            R"({"name":"t.missing","ok":false,"error":"Unknown tool"}]})");
+}
+
+TEST_F(McpBatchTest, WaitsForDeferredResultsInAnyOrder) {
+  std::string error;
+  ASSERT_TRUE(RunMcpBatch(5, R"([{"name":"t.later"},{"name":"t.later"},{"name":"t.int","arguments":{"v":1}}])",
+                          Dispatch, &error));
+  ASSERT_EQ(g_deferred.size(), 2u);
+  EXPECT_TRUE(Responses().empty());
+
+  SendMcpResult(g_deferred[1], true);
+  EXPECT_TRUE(Responses().empty());
+  SendMcpResult(g_deferred[0], std::string("first"));
+
+  const auto responses = Responses();
+  ASSERT_EQ(responses.size(), 1u);
+  EXPECT_EQ(std::get<std::string>(responses[0].value),
+            R"({"results":[{"name":"t.later","ok":true,"result":"first"},)"
+            R"({"name":"t.later","ok":true,"result":true},)"
+            R"({"name":"t.int","ok":true,"result":1}]})");
+
+  // 批量调用完成后迟到的结果被丢弃
+  SendMcpResult(g_deferred[0], true);
+  EXPECT_TRUE(Responses().empty());
+}
+
+TEST_F(McpBatchTest, ReportsToolsThatBypassSendMcpResultImmediately) {
+  std::string error;
+  ASSERT_TRUE(RunMcpBatch(9, R"([{"name":"t.direct"},{"name":"t.int","arguments":{"v":2}}])", Dispatch, &error));
+
+  // 工具直接发给引擎的结果带着内部 id，批量调用不等待它
+  const auto responses = Responses();
+  ASSERT_EQ(responses.size(), 2u);
+  EXPECT_LT(responses[0].id, 0);
+  EXPECT_EQ(responses[1].id, 9);
+  EXPECT_EQ(std::get<std::string>(responses[1].value),
+            R"({"results":[{"name":"t.direct","ok":false,"error":"Tool does not support self.batch"},)"
+            R"({"name":"t.int","ok":true,"result":2}]})");
+}
+
+TEST_F(McpBatchTest, ResultsOutsideBatchGoStraightToEngine) {
+  SendMcpResult(11, int64_t{3});
+  SendMcpJsonResult(12, "{}");
+  SendMcpErrorResult(13, "bad");
+
+  const auto responses = Responses();
+  ASSERT_EQ(responses.size(), 3u);
+  EXPECT_EQ(std::get<int64_t>(responses[0].value), 3);
+  EXPECT_EQ(std::get<std::string>(responses[1].value), "{}");
+  EXPECT_TRUE(responses[2].error);
+  EXPECT_EQ(std::get<std::string>(responses[2].value), "bad");
+}
+
+}  // namespace
@@ -0,0 +1,95 @@
+#include "mcp_tool.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+
+#include "ai_vox_engine.h"
+#include "metrics.h"
+
+namespace {
+
+struct MoveArgs {
+  int64_t angle = 0;
+  std::optional<int64_t> speed;
+  std::string label;
+  bool smooth = false;
+};
+
+constexpr auto kMoveTool = MakeMcpTool<MoveArgs>("test.servo.move", "Move the servo",
+                                                 McpInt("angle", &MoveArgs::angle, 0, 180),
+                                                 McpInt("speed", &MoveArgs::speed, 1, 10),
+                                                 McpString("label", &MoveArgs::label, "none"),
+                                                 McpBool("smooth", &MoveArgs::smooth, true));
+
+int g_calls = 0;
+MoveArgs g_last_args;
+
+void HandleMove(const ai_vox::McpToolCallEvent& event, const MoveArgs& args) {
+  g_calls++;
+  g_last_args = args;
+  ai_vox::Engine::GetInstance().SendMcpCallResponse(event.id, true);
+}
+
+constexpr auto kMoveEntry = McpToolEntryOf<kMoveTool, HandleMove>();
+
+class McpToolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    g_calls = 0;
+    engine().TakeMcpResponses();
+  }
+
+  static ai_vox::Engine& engine() {
+    return ai_vox::Engine::GetInstance();
+  }
+
+  static ai_vox::Engine::McpResponse Invoke(decltype(ai_vox::McpToolCallEvent::params) params) {
+    kMoveEntry.invoke(ai_vox::McpToolCallEvent{1, kMoveTool.name, std::move(params)});
+    auto responses = engine().TakeMcpResponses();
+    EXPECT_EQ(responses.size(), 1u);
+    return responses.empty() ? ai_vox::Engine::McpResponse{} : responses.front();
+  }
+};
+
+TEST_F(McpToolTest, DeclaresToolWithEngine) {
+  EXPECT_STREQ(kMoveEntry.name, "test.servo.move");
+  kMoveEntry.declare(engine());
+  const auto tools = engine().declared_tools();
+  EXPECT_NE(std::find(tools.begin(), tools.end(), "test.servo.move"), tools.end());
+}
+
+TEST_F(McpToolTest, PassesArgumentsAndDefaults) {
+  EXPECT_FALSE(Invoke({{"angle", int64_t{90}}}).error);
+  ASSERT_EQ(g_calls, 1);
+  EXPECT_EQ(g_last_args.angle, 90);
+  EXPECT_FALSE(g_last_args.speed.has_value());
+  EXPECT_EQ(g_last_args.label, "none");
+  EXPECT_TRUE(g_last_args.smooth);
+
+  EXPECT_FALSE(Invoke({{"angle", int64_t{0}}, {"speed", int64_t{3}}, {"smooth", false}}).error);
+  EXPECT_EQ(g_last_args.speed, 3);
+  EXPECT_FALSE(g_last_args.smooth);
+}
+
+TEST_F(McpToolTest, RejectsMissingAndOutOfRangeArguments) {
+  const auto errors = GetMetric("mcp.errors").value();
+
+  auto response = Invoke({});
+  EXPECT_TRUE(response.error);
+  EXPECT_EQ(response.value, (decltype(response.value){std::string("Missing valid argument: angle")}));
+
+  response = Invoke({{"angle", int64_t{181}}});
+  EXPECT_EQ(response.value, (decltype(response.value){std::string("Argument out of range: angle")}));
+
+  // 类型不符的参数视为缺失
+  response = Invoke({{"angle", std::string("90")}});
+  EXPECT_TRUE(response.error);
+
+  EXPECT_EQ(g_calls, 0);
+  EXPECT_EQ(GetMetric("mcp.errors").value(), errors + 3);
+}
+
+}  // namespace
@@ -0,0 +1,58 @@
+#include "metrics.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "json_writer.h"
+
+namespace {
+
+TEST(MetricsTest, ReturnsSameMetricForSameName) {
+  auto& metric = GetMetric("test.counter");
+  metric.Add();
+  metric.Add(4);
+  EXPECT_EQ(&GetMetric("test.counter"), &metric);
+  EXPECT_EQ(GetMetric("test.counter").value(), 5u);
+
+  metric.Set(3);
+  metric.UpdateMax(2);
+  EXPECT_EQ(metric.value(), 3u);
+  metric.UpdateMax(9);
+  EXPECT_EQ(metric.value(), 9u);
+}
+
+TEST(MetricsTest, CountsFromSeveralThreads) {
+  auto& metric = GetMetric("test.concurrent");
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&metric] {
+      for (int j = 0; j < 10000; j++) {
+        metric.Add();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(metric.value(), 40000u);
+}
+
+TEST(MetricsTest, WritesMetricsGaugesAndHeapAsJson) {
+  GetMetric("test.json_counter").Set(7);
+  RegisterMetricGauge("test.gauge", [] { return 42u; });
+  char buffer[4096];
+  JsonWriter writer(buffer, sizeof(buffer));
+  WriteMetricsJson(writer);
+  ASSERT_TRUE(writer.ok());
+  const std::string json = writer.c_str();
+  EXPECT_EQ(json.front(), '{');
+  EXPECT_EQ(json.back(), '}');
+  EXPECT_NE(json.find("\"test.json_counter\":7"), std::string::npos);
+  EXPECT_NE(json.find("\"test.gauge\":42"), std::string::npos);
+  EXPECT_NE(json.find("\"heap\":{\"internal\":{"), std::string::npos);
+}
+
+}  // namespace
@@ -0,0 +1,153 @@
+#include "pcm_dsp.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+namespace {
+
+std::vector<int16_t> RandomSamples(size_t count, unsigned seed) {
+  srand(seed);
+  std::vector<int16_t> samples(count);
+  for (auto& sample : samples) {
+    sample = static_cast<int16_t>(rand() % 65536 - 32768);
+  }
+  return samples;
+}
+
+TEST(PcmDspTest, GainRoundsTowardNegativeInfinity) {
+  const int16_t in[] = {3, -3, 32767, -32768, 1, -1};
+  int16_t out[6];
+  PcmApplyGainScalar(in, out, 6, kPcmUnityGain / 2);
+
+  EXPECT_EQ(out[0], 1);
+  EXPECT_EQ(out[1], -2);
+  EXPECT_EQ(out[2], 16383);
+  EXPECT_EQ(out[3], -16384);
+  EXPECT_EQ(out[4], 0);
+  EXPECT_EQ(out[5], -1);
+}
+
+TEST(PcmDspTest, UnityGainCopiesAndZeroGainSilences) {
+  const auto in = RandomSamples(100, 1);
+  std::vector<int16_t> out(100);
+  PcmApplyGainScalar(in.data(), out.data(), in.size(), kPcmUnityGain);
+  EXPECT_EQ(out, in);
+
+  PcmApplyGainScalar(in.data(), out.data(), in.size(), 0);
+  EXPECT_EQ(out, std::vector<int16_t>(100, 0));
+}
+
+// 在 ESP32-S3 以外的平台上向量版本就是标量实现，这里核对未对齐的头尾部分与就地处理
+TEST(PcmDspTest, DispatchingVersionsMatchScalarForAnyAlignment) {
+  const auto a = RandomSamples(203, 2);
+  for (size_t offset = 0; offset < 8; offset++) {
+    const size_t count = a.size() - offset;
+    std::vector<int16_t> expected(count);
+    std::vector<int16_t> actual(count);
+
+    PcmApplyGainScalar(a.data() + offset, expected.data(), count, 12345);
+    PcmApplyGain(a.data() + offset, actual.data(), count, 12345);
+    EXPECT_EQ(actual, expected);
+
+    std::vector<int16_t> in_place(a.begin() + offset, a.end());
+    PcmApplyGain(in_place.data(), in_place.data(), count, 12345);
+    PcmApplyGainScalar(a.data() + offset, expected.data(), count, 12345);
+    EXPECT_EQ(in_place, expected);
+  }
+}
+
+TEST(PcmDspTest, SelfTestPasses) {
+  EXPECT_TRUE(PcmDspSelfTest());
+}
+
+TEST(PcmDspTest, BenchmarkReportsBitExactResults) {
+  EXPECT_TRUE(BenchmarkPcmDsp("host"));
+}
+
+TEST(PcmDspTest, DownmixAveragesChannelsInPlace) {
+  std::vector<int16_t> samples = {100, 200, -100, -201, 32767, 32767, -32768, -32768};
+  PcmDownmixStereo(samples.data(), 4, samples.data());
+
+  EXPECT_EQ(samples[0], 150);
+  EXPECT_EQ(samples[1], -151);
+  EXPECT_EQ(samples[2], 32767);
+  EXPECT_EQ(samples[3], -32768);
+}
+
+TEST(PcmResamplerTest, SameRateIsPassthrough) {
+  PcmResampler resampler;
+  resampler.Reset(16000, 16000);
+  EXPECT_TRUE(resampler.passthrough());
+
+  const auto in = RandomSamples(50, 4);
+  std::vector<int16_t> out(resampler.MaxOutput(in.size()));
+  ASSERT_EQ(resampler.Process(in.data(), in.size(), out.data()), in.size());
+  EXPECT_TRUE(std::equal(in.begin(), in.end(), out.begin()));
+}
+
+TEST(PcmResamplerTest, UpsamplesWithLinearInterpolation) {
+  PcmResampler resampler;
+  resampler.Reset(8000, 16000);
+  const int16_t in[] = {0, 100, 200, 300};
+  int16_t out[16];
+  const size_t written = resampler.Process(in, 4, out);
+
+  ASSERT_LE(written, resampler.MaxOutput(4));
+  ASSERT_GE(written, 7u);
+  // 第一块以第一个样本为起点
+  EXPECT_EQ(out[0], 0);
+  EXPECT_EQ(out[1], 0);
+  EXPECT_EQ(out[2], 0);
+  EXPECT_EQ(out[3], 50);
+  EXPECT_EQ(out[4], 100);
+  EXPECT_EQ(out[5], 150);
+}
+
+TEST(PcmResamplerTest, ChunkedProcessingMatchesSinglePass) {
+  const auto in = RandomSamples(4800, 5);
+  for (const auto [in_rate, out_rate] : {std::pair{16000u, 24000u}, {24000u, 16000u}, {44100u, 16000u}}) {
+    PcmResampler whole;
+    whole.Reset(in_rate, out_rate);
+    std::vector<int16_t> expected(whole.MaxOutput(in.size()));
+    expected.resize(whole.Process(in.data(), in.size(), expected.data()));
+
+    PcmResampler chunked;
+    chunked.Reset(in_rate, out_rate);
+    std::vector<int16_t> actual;
+    size_t offset = 0;
+    for (size_t chunk = 1; offset < in.size(); chunk = chunk * 3 % 577 + 1) {
+      const size_t count = std::min(chunk, in.size() - offset);
+      std::vector<int16_t> out(chunked.MaxOutput(count));
+      const size_t written = chunked.Process(in.data() + offset, count, out.data());
+      ASSERT_LE(written, out.size());
+      actual.insert(actual.end(), out.begin(), out.begin() + written);
+      offset += count;
+    }
+    EXPECT_EQ(actual, expected) << in_rate << " -> " << out_rate;
+    // 输出样本数与采样率之比一致(误差不超过一个样本)
+    EXPECT_NEAR(static_cast<double>(expected.size()), in.size() * static_cast<double>(out_rate) / in_rate, 1.0);
+  }
+}
+
+TEST(PcmConverterTest, DownmixesResamplesAndAppliesGain) {
+  PcmConverter converter;
+  converter.Configure(16000, 2, 16000);
+  EXPECT_FALSE(converter.passthrough(kPcmUnityGain));
+
+  std::vector<int16_t> in = {1000, 3000, -1000, -3000, 400, 400};
+  std::vector<int16_t> out(converter.MaxOutput(in.size()));
+  const size_t written = converter.Process(in.data(), in.size(), out.data(), kPcmUnityGain / 2);
+
+  ASSERT_EQ(written, 3u);
+  EXPECT_EQ(out[0], 1000);
+  EXPECT_EQ(out[1], -1000);
+  EXPECT_EQ(out[2], 200);
+
+  converter.Configure(24000, 1, 24000);
+  EXPECT_TRUE(converter.passthrough(kPcmUnityGain));
+  EXPECT_FALSE(converter.passthrough(kPcmUnityGain - 1));
+}
+
+}  // namespace
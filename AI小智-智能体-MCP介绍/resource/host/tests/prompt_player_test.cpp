@@ -0,0 +1,53 @@
+#include "prompt_player.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+namespace {
+
+class PromptPlayerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    audio_device_ = std::make_shared<ai_vox::AudioDeviceEs8311>(nullptr, 0, I2C_NUM_0, 16000, GPIO_NUM_NC, GPIO_NUM_NC,
+                                                                GPIO_NUM_NC, GPIO_NUM_NC, GPIO_NUM_NC);
+    // 与固件一样不销毁，后台任务一直存在
+    player_ = new PromptPlayer(audio_device_, 16000);
+  }
+
+  // 播放一段提示音，返回写入的采样数
+  uint64_t PlayAndWait(const std::vector<uint8_t>& mp3) {
+    const auto before = audio_device_->written_samples();
+    EXPECT_TRUE(player_->Enqueue(mp3.data(), mp3.size()));
+    EXPECT_TRUE(player_->WaitIdle(pdMS_TO_TICKS(2000)));
+    return audio_device_->written_samples() - before;
+  }
+
+  std::shared_ptr<ai_vox::AudioDeviceEs8311> audio_device_;
+  PromptPlayer* player_ = nullptr;
+};
+
+TEST_F(PromptPlayerTest, DecodesEveryPlaybackWithoutCache) {
+  const std::vector<uint8_t> mp3(144 * 20, 0xff);
+  const auto first = PlayAndWait(mp3);
+  EXPECT_GT(first, 0u);
+  EXPECT_EQ(player_->TakeStats().decoded_samples, first);
+
+  EXPECT_EQ(PlayAndWait(mp3), first);
+  EXPECT_EQ(player_->TakeStats().decoded_samples, first);
+}
+
+TEST_F(PromptPlayerTest, ReplaysCachedPcmWithoutDecoding) {
+  const std::vector<uint8_t> mp3(144 * 20, 0xff);
+  player_->EnablePcmCache(mp3.data());
+  const auto first = PlayAndWait(mp3);
+  EXPECT_GT(first, 0u);
+  EXPECT_EQ(player_->TakeStats().decoded_samples, first);
+
+  // 第二次从PSRAM缓存写入相同的采样，不经过解码器
+  EXPECT_EQ(PlayAndWait(mp3), first);
+  EXPECT_EQ(player_->TakeStats().decoded_samples, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,170 @@
+#include "sensor_sampler.h"
+
+#include <Arduino.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include "metrics.h"
+
+namespace {
+
+// 一次读取的结果，ok 为false时模拟读取失败
+struct ScriptedRead {
+  bool ok;
+  float value;
+};
+
+// 按脚本依次返回读取结果，脚本用完后阻塞采样任务，使窗口内容保持确定
+class ScriptedSensor {
+ public:
+  explicit ScriptedSensor(std::vector<ScriptedRead> script) : script_(std::move(script)) {
+  }
+
+  SensorReadFunction Read() {
+    return [this](float* values) {
+      const auto index = next_.load();
+      if (index >= script_.size()) {
+        done_ = true;
+        while (true) {
+          delay(1000);
+        }
+      }
+      values[0] = script_[index].value;
+      values[1] = script_[index].value * 2;
+      next_++;
+      return script_[index].ok;
+    };
+  }
+
+  bool WaitDone() {
+    for (int i = 0; i < 1000 && !done_; i++) {
+      delay(5);
+    }
+    return done_;
+  }
+
+ private:
+  const std::vector<ScriptedRead> script_;
+  std::atomic<size_t> next_{0};
+  std::atomic<bool> done_{false};
+};
+
+// 每个测试在单独的进程中运行，采样任务只采样本测试注册的传感器
+int Register(const char* name, uint32_t window, ScriptedSensor& sensor) {
+  const int id = RegisterSensor(name, 1, 2, window, sensor.Read());
+  StartSensorSampler();
+  return id;
+}
+
+TEST(SensorSamplerTest, RejectsInvalidConfig) {
+  const auto read = [](float*) { return true; };
+  EXPECT_EQ(RegisterSensor("bad", 0, 1, 4, read), -1);
+  EXPECT_EQ(RegisterSensor("bad", 100, 0, 4, read), -1);
+  EXPECT_EQ(RegisterSensor("bad", 100, kMaxSensorChannels + 1, 4, read), -1);
+  EXPECT_EQ(RegisterSensor("bad", 100, 1, 0, read), -1);
+  EXPECT_EQ(RegisterSensor("bad", 100, 1, 4, nullptr), -1);
+
+  SensorReading reading;
+  EXPECT_FALSE(GetSensorLatest(0, &reading));
+}
+
+TEST(SensorSamplerTest, ReportsMinMaxAvgOverPartialWindow) {
+  ScriptedSensor sensor({{true, 5}, {true, 1}, {true, 3}, {true, 8}});
+  const int id = Register("partial", 8, sensor);
+  ASSERT_TRUE(sensor.WaitDone());
+
+  SensorStats stats;
+  ASSERT_TRUE(GetSensorStats(id, 0, &stats));
+  EXPECT_EQ(stats.count, 4u);
+  EXPECT_FLOAT_EQ(stats.min, 1);
+  EXPECT_FLOAT_EQ(stats.max, 8);
+  EXPECT_FLOAT_EQ(stats.avg, 4.25f);
+
+  // 每个通道单独统计
+  ASSERT_TRUE(GetSensorStats(id, 1, &stats));
+  EXPECT_FLOAT_EQ(stats.max, 16);
+  EXPECT_FALSE(GetSensorStats(id, 2, &stats));
+
+  SensorReading reading;
+  ASSERT_TRUE(GetSensorLatest(id, &reading));
+  EXPECT_FLOAT_EQ(reading.values[0], 8);
+  EXPECT_GT(reading.timestamp_us, 0);
+}
+
+TEST(SensorSamplerTest, DropsSamplesThatLeaveTheWindow) {
+  // 窗口为3，最大值9和之后的最小值1都会滑出窗口
+  ScriptedSensor sensor({{true, 9}, {true, 1}, {true, 6}, {true, 4}, {true, 5}, {true, 7}});
+  const int id = Register("wrap", 3, sensor);
+  ASSERT_TRUE(sensor.WaitDone());
+
+  SensorStats stats;
+  ASSERT_TRUE(GetSensorStats(id, 0, &stats));
+  EXPECT_EQ(stats.count, 3u);
+  EXPECT_FLOAT_EQ(stats.min, 4);
+  EXPECT_FLOAT_EQ(stats.max, 7);
+  EXPECT_FLOAT_EQ(stats.avg, 16.0f / 3);
+}
+
+// 窗口多次环绕后与直接计算最后 window 个样本的结果一致
+TEST(SensorSamplerTest, MatchesBruteForceAfterManyWraps) {
+  constexpr uint32_t kWindow = 7;
+  std::vector<ScriptedRead> script;
+  uint32_t seed = 12345;
+  for (int i = 0; i < 200; i++) {
+    seed = seed * 1103515245 + 12345;
+    script.push_back({true, static_cast<float>((seed >> 16) % 100)});
+  }
+  ScriptedSensor sensor(script);
+  const int id = Register("random", kWindow, sensor);
+  ASSERT_TRUE(sensor.WaitDone());
+
+  const auto last = std::vector<ScriptedRead>(script.end() - kWindow, script.end());
+  float min = last[0].value;
+  float max = last[0].value;
+  float sum = 0;
+  for (const auto& read : last) {
+    min = std::min(min, read.value);
+    max = std::max(max, read.value);
+    sum += read.value;
+  }
+  SensorStats stats;
+  ASSERT_TRUE(GetSensorStats(id, 0, &stats));
+  EXPECT_EQ(stats.count, kWindow);
+  EXPECT_FLOAT_EQ(stats.min, min);
+  EXPECT_FLOAT_EQ(stats.max, max);
+  EXPECT_NEAR(stats.avg, sum / kWindow, 1e-3);
+}
+
+TEST(SensorSamplerTest, FailedReadsKeepLastGoodValueAndCountFailures) {
+  ScriptedSensor sensor({{true, 10}, {false, 99}, {true, NAN}, {false, 0}});
+  const int id = Register("flaky", 4, sensor);
+  ASSERT_TRUE(sensor.WaitDone());
+
+  SensorReading reading;
+  ASSERT_TRUE(GetSensorLatest(id, &reading));
+  EXPECT_FLOAT_EQ(reading.values[0], 10);
+  SensorStats stats;
+  ASSERT_TRUE(GetSensorStats(id, 0, &stats));
+  EXPECT_EQ(stats.count, 1u);
+  EXPECT_FLOAT_EQ(stats.avg, 10);
+  EXPECT_EQ(GetMetric("sensor.flaky.failures").value(), 3u);
+}
+
+TEST(SensorSamplerTest, NoReadingBeforeFirstSuccess) {
+  ScriptedSensor sensor({{false, 1}, {false, 2}});
+  const int id = Register("never", 4, sensor);
+  ASSERT_TRUE(sensor.WaitDone());
+
+  SensorReading reading;
+  EXPECT_FALSE(GetSensorLatest(id, &reading));
+  SensorStats stats;
+  EXPECT_FALSE(GetSensorStats(id, 0, &stats));
+  EXPECT_EQ(GetMetric("sensor.never.failures").value(), 2u);
+}
+
+}  // namespace
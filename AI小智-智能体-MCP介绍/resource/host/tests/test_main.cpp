@@ -0,0 +1,14 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+// 固件中 setup()/loop() 不会返回，设备的全局对象和后台任务从不销毁；
+// 测试结束时同样直接退出，不运行静态析构函数(后台任务仍在等待这些对象)
+int main(int argc, char** argv) {
+  testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+  fflush(stdout);
+  fflush(stderr);
+  _exit(result);
+}
@@ -0,0 +1,284 @@
+#include "wifi_fast_connect.h"
+
+#include <WiFi.h>
+#include <gtest/gtest.h>
+#include <nvs.h>
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "arduino_wifi_fast_connect_driver.h"
+#include "host_fakes.h"
+
+namespace {
+
+constexpr uint8_t kBssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+
+WifiConnectionInfo CachedInfo() {
+  WifiConnectionInfo info;
+  memcpy(info.bssid, kBssid, sizeof(info.bssid));
+  info.channel = 6;
+  info.ip = 0x6401A8C0;
+  info.gateway = 0x0101A8C0;
+  info.subnet = 0x00FFFFFF;
+  info.dns = 0x0101A8C0;
+  return info;
+}
+
+class FakeDriver : public WifiFastConnectDriver {
+ public:
+  struct ConnectCall {
+    std::string ssid;
+    std::string password;
+    WifiConnectionInfo info;
+    bool static_ip;
+  };
+
+  bool GetSavedCredentials(WifiCredentials& credentials) override {
+    if (!saved_ssid) {
+      return false;
+    }
+    strcpy(credentials.ssid, saved_ssid->c_str());
+    strcpy(credentials.password, "saved_password");
+    return true;
+  }
+
+  WifiFastConnectResult Connect(const WifiCredentials& credentials,
+                                const WifiConnectionInfo& info,
+                                bool static_ip,
+                                uint32_t) override {
+    calls.push_back({credentials.ssid, credentials.password, info, static_ip});
+    connected = result == WifiFastConnectResult::kConnected;
+    return result;
+  }
+
+  void Disconnect() override {
+    connected = false;
+    disconnects++;
+  }
+
+  bool GetConnectionInfo(WifiConnectionInfo& info) override {
+    if (!connected) {
+      return false;
+    }
+    info = current;
+    return true;
+  }
+
+  std::optional<std::string> saved_ssid = "saved_ap";
+  WifiFastConnectResult result = WifiFastConnectResult::kConnected;
+  WifiConnectionInfo current = CachedInfo();
+  bool connected = false;
+  int disconnects = 0;
+  std::vector<ConnectCall> calls;
+};
+
+class MemoryStore : public WifiFastConnectStore {
+ public:
+  bool Load(WifiConnectionInfo& info) override {
+    if (!info_) {
+      return false;
+    }
+    info = *info_;
+    return true;
+  }
+
+  bool Save(const WifiConnectionInfo& info) override {
+    info_ = info;
+    saves++;
+    return true;
+  }
+
+  void Clear() override {
+    info_.reset();
+  }
+
+  std::optional<WifiConnectionInfo> info_;
+  int saves = 0;
+};
+
+TEST(WifiFastConnectTest, DoesNothingWithoutCache) {
+  FakeDriver driver;
+  MemoryStore store;
+  WifiFastConnect fast_connect(driver, store, false);
+
+  EXPECT_FALSE(fast_connect.TryConnect(1000, "ap", "password"));
+  EXPECT_TRUE(driver.calls.empty());
+}
+
+TEST(WifiFastConnectTest, ConnectsToCachedApWithConfiguredCredentials) {
+  FakeDriver driver;
+  MemoryStore store;
+  store.info_ = CachedInfo();
+  WifiFastConnect fast_connect(driver, store, false);
+
+  ASSERT_TRUE(fast_connect.TryConnect(1000, "configured_ap", "configured_password"));
+  ASSERT_EQ(driver.calls.size(), 1u);
+  EXPECT_EQ(driver.calls[0].ssid, "configured_ap");
+  EXPECT_EQ(driver.calls[0].password, "configured_password");
+  EXPECT_EQ(driver.calls[0].info.channel, 6);
+  EXPECT_EQ(memcmp(driver.calls[0].info.bssid, kBssid, sizeof(kBssid)), 0);
+  EXPECT_FALSE(driver.calls[0].static_ip);
+}
+
+TEST(WifiFastConnectTest, UsesSavedCredentialsWhenNoneConfigured) {
+  FakeDriver driver;
+  MemoryStore store;
+  store.info_ = CachedInfo();
+  WifiFastConnect fast_connect(driver, store, true);
+
+  ASSERT_TRUE(fast_connect.TryConnect(1000));
+  EXPECT_EQ(driver.calls[0].ssid, "saved_ap");
+  EXPECT_EQ(driver.calls[0].password, "saved_password");
+  EXPECT_TRUE(driver.calls[0].static_ip);
+
+  // 没有保存的凭据时不连接，也不清除缓存
+  driver.saved_ssid.reset();
+  EXPECT_FALSE(fast_connect.TryConnect(1000));
+  EXPECT_EQ(driver.calls.size(), 1u);
+  EXPECT_TRUE(store.info_.has_value());
+}
+
+TEST(WifiFastConnectTest, TimeoutKeepsCache) {
+  FakeDriver driver;
+  driver.result = WifiFastConnectResult::kTimeout;
+  MemoryStore store;
+  store.info_ = CachedInfo();
+  WifiFastConnect fast_connect(driver, store, false);
+
+  EXPECT_FALSE(fast_connect.TryConnect(1000, "ap", "password"));
+  EXPECT_EQ(driver.disconnects, 1);
+  EXPECT_TRUE(store.info_.has_value());
+
+  // 下次启动时AP恢复正常，仍然走快速连接
+  driver.result = WifiFastConnectResult::kConnected;
+  EXPECT_TRUE(fast_connect.TryConnect(1000, "ap", "password"));
+}
+
+TEST(WifiFastConnectTest, AuthFailureAndMissingNetworkClearCache) {
+  for (const auto result : {WifiFastConnectResult::kAuthFailed, WifiFastConnectResult::kNetworkNotFound}) {
+    FakeDriver driver;
+    driver.result = result;
+    MemoryStore store;
+    store.info_ = CachedInfo();
+    WifiFastConnect fast_connect(driver, store, false);
+
+    EXPECT_FALSE(fast_connect.TryConnect(1000, "ap", "password"));
+    EXPECT_EQ(driver.disconnects, 1);
+    EXPECT_FALSE(store.info_.has_value());
+  }
+}
+
+TEST(WifiFastConnectTest, UpdateCacheWritesOnlyWhenChanged) {
+  FakeDriver driver;
+  MemoryStore store;
+  WifiFastConnect fast_connect(driver, store, false);
+
+  // 未连接时不写入
+  fast_connect.UpdateCache();
+  EXPECT_EQ(store.saves, 0);
+
+  driver.connected = true;
+  fast_connect.UpdateCache();
+  fast_connect.UpdateCache();
+  EXPECT_EQ(store.saves, 1);
+
+  driver.current.channel = 11;
+  fast_connect.UpdateCache();
+  EXPECT_EQ(store.saves, 2);
+  EXPECT_EQ(store.info_->channel, 11);
+}
+
+// ==================== 模拟的 WiFi 和 NVS ====================
+
+class ArduinoWifiFastConnectTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    host::ClearNvs();
+    host::SetAccessPoint(host::AccessPoint());
+    WiFi.disconnect();
+  }
+
+  // 常规连接(扫描全部信道)后写入缓存
+  void ConnectAndCache() {
+    const host::AccessPoint ap;
+    WiFi.begin(ap.ssid.c_str(), ap.password.c_str());
+    while (WiFi.status() != WL_CONNECTED) {
+      delay(1);
+    }
+    WifiFastConnect(driver_, store_, false).UpdateCache();
+    WiFi.disconnect();
+  }
+
+  std::vector<uint8_t> RawCache() {
+    nvs_handle_t handle = 0;
+    if (nvs_open("wifi_fast", NVS_READONLY, &handle) != ESP_OK) {
+      return {};
+    }
+    size_t size = 0;
+    std::vector<uint8_t> data;
+    if (nvs_get_blob(handle, "conn", nullptr, &size) == ESP_OK) {
+      data.resize(size);
+      nvs_get_blob(handle, "conn", data.data(), &size);
+    }
+    nvs_close(handle);
+    return data;
+  }
+
+  ArduinoWifiFastConnectDriver driver_{WiFi};
+  NvsWifiFastConnectStore store_;
+};
+
+TEST_F(ArduinoWifiFastConnectTest, CacheDoesNotContainCredentials) {
+  ConnectAndCache();
+  const auto cache = RawCache();
+  ASSERT_FALSE(cache.empty());
+
+  const host::AccessPoint ap;
+  for (const auto& secret : {ap.password, ap.ssid}) {
+    EXPECT_EQ(std::search(cache.begin(), cache.end(), secret.begin(), secret.end()), cache.end()) << secret;
+  }
+}
+
+TEST_F(ArduinoWifiFastConnectTest, ReconnectsWithoutScanning) {
+  ConnectAndCache();
+  WifiFastConnect fast_connect(driver_, store_, false);
+
+  ASSERT_TRUE(fast_connect.TryConnect(1000));
+  const auto call = host::LastWifiBegin();
+  EXPECT_EQ(call.ssid, "host_ap");
+  EXPECT_EQ(call.password, "host_password");
+  EXPECT_EQ(call.channel, 6);
+  EXPECT_TRUE(call.has_bssid);
+  EXPECT_EQ(WiFi.status(), WL_CONNECTED);
+}
+
+TEST_F(ArduinoWifiFastConnectTest, ClearsCacheWhenApMovedOrPasswordChanged) {
+  ConnectAndCache();
+  auto ap = host::AccessPoint();
+  ap.channel = 11;
+  host::SetAccessPoint(ap);
+  EXPECT_FALSE(WifiFastConnect(driver_, store_, false).TryConnect(1000, "host_ap", "host_password"));
+  EXPECT_TRUE(RawCache().empty());
+
+  host::SetAccessPoint(host::AccessPoint());
+  ConnectAndCache();
+  EXPECT_FALSE(WifiFastConnect(driver_, store_, false).TryConnect(1000, "host_ap", "old_password"));
+  EXPECT_TRUE(RawCache().empty());
+}
+
+TEST_F(ArduinoWifiFastConnectTest, SlowApKeepsCache) {
+  ConnectAndCache();
+  auto ap = host::AccessPoint();
+  ap.fast_connect_ms = 200;
+  host::SetAccessPoint(ap);
+
+  EXPECT_FALSE(WifiFastConnect(driver_, store_, false).TryConnect(50, "host_ap", "host_password"));
+  EXPECT_FALSE(RawCache().empty());
+  EXPECT_NE(WiFi.status(), WL_CONNECTED);
+}
+
+}  // namespace
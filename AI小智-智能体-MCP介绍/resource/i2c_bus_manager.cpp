@@ -0,0 +1,254 @@
+#include "i2c_bus_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+int64_t NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+}  // namespace
+
+I2cBusManager::I2cBusManager(I2cBus& bus) : bus_(bus) {
+  batch_.reserve(kMaxBatchReadSize);
+}
+
+int I2cBusManager::AddDevice(const I2cDeviceConfig& config) {
+  auto device = std::make_unique<Device>();
+  device->name = config.name;
+  device->address = config.address;
+  device->priority = config.priority;
+  device->auto_increment = config.auto_increment;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  devices_.push_back(std::move(device));
+  return static_cast<int>(devices_.size()) - 1;
+}
+
+bool I2cBusManager::Write(int device, const uint8_t* data, size_t size, I2cCallback callback) {
+  return WriteRead(device, data, size, nullptr, 0, std::move(callback));
+}
+
+bool I2cBusManager::WriteRead(int device, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size,
+                              I2cCallback callback) {
+  if (write_size > kMaxWriteSize || (write_size == 0 && read_size == 0)) {
+    return false;
+  }
+  Transaction transaction;
+  if (write_size > 0) {
+    memcpy(transaction.write, write, write_size);
+  }
+  transaction.write_size = write_size;
+  transaction.read = read;
+  transaction.read_size = read_size;
+  transaction.callback = std::move(callback);
+  return Submit(device, std::move(transaction));
+}
+
+bool I2cBusManager::ReadRegisters(int device, uint8_t reg, uint8_t* data, size_t size, I2cCallback callback) {
+  if (size == 0) {
+    return false;
+  }
+  Transaction transaction;
+  transaction.write[0] = reg;
+  transaction.write_size = 1;
+  transaction.read = data;
+  transaction.read_size = size;
+  transaction.register_read = true;
+  transaction.callback = std::move(callback);
+  return Submit(device, std::move(transaction));
+}
+
+bool I2cBusManager::WriteRegister(int device, uint8_t reg, uint8_t value, I2cCallback callback) {
+  const uint8_t data[] = {reg, value};
+  return Write(device, data, sizeof(data), std::move(callback));
+}
+
+bool I2cBusManager::ReadRegistersSync(int device, uint8_t reg, uint8_t* data, size_t size) {
+  return WaitFor([&](I2cCallback callback) { return ReadRegisters(device, reg, data, size, std::move(callback)); });
+}
+
+bool I2cBusManager::WriteRegisterSync(int device, uint8_t reg, uint8_t value) {
+  return WaitFor([&](I2cCallback callback) { return WriteRegister(device, reg, value, std::move(callback)); });
+}
+
+bool I2cBusManager::WaitFor(const std::function<bool(I2cCallback)>& submit) {
+  bool done = false;
+  bool result = false;
+  const bool submitted = submit([this, &done, &result](bool ok) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result = ok;
+    done = true;
+    done_cv_.notify_all();
+  });
+  if (!submitted) {
+    return false;
+  }
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_cv_.wait(lock, [&done] { return done; });
+  return result;
+}
+
+bool I2cBusManager::Submit(int device, Transaction&& transaction) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (device < 0 || static_cast<size_t>(device) >= devices_.size()) {
+      return false;
+    }
+    if (stopped_) {
+      return false;
+    }
+    auto& target = *devices_[device];
+    if (target.queue.size() >= kMaxQueueDepth) {
+      target.stats.dropped++;
+      return false;
+    }
+    transaction.submit_us = NowUs();
+    transaction.sequence = next_sequence_++;
+    target.queue.push_back(std::move(transaction));
+    pending_++;
+  }
+  work_cv_.notify_one();
+  return true;
+}
+
+I2cBusManager::Device* I2cBusManager::NextDevice() {
+  Device* next = nullptr;
+  for (const auto& device : devices_) {
+    if (device->queue.empty()) {
+      continue;
+    }
+    if (next == nullptr || device->priority > next->priority ||
+        (device->priority == next->priority && device->queue.front().sequence < next->queue.front().sequence)) {
+      next = device.get();
+    }
+  }
+  return next;
+}
+
+bool I2cBusManager::ProcessOne() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto device = NextDevice();
+  if (device == nullptr) {
+    return false;
+  }
+
+  // 取出队首事务，以及紧随其后、寄存器地址连续的读取
+  batch_.clear();
+  batch_.push_back(std::move(device->queue.front()));
+  device->queue.pop_front();
+  size_t read_size = batch_.front().read_size;
+  if (device->auto_increment && batch_.front().register_read) {
+    while (!device->queue.empty()) {
+      const auto& next = device->queue.front();
+      if (!next.register_read || next.write[0] != batch_.front().write[0] + read_size ||
+          read_size + next.read_size > kMaxBatchReadSize) {
+        break;
+      }
+      read_size += next.read_size;
+      batch_.push_back(std::move(device->queue.front()));
+      device->queue.pop_front();
+    }
+  }
+  pending_ -= batch_.size();
+  const uint16_t address = device->address;
+  lock.unlock();
+
+  const auto start_us = NowUs();
+  bool ok = false;
+  if (batch_.size() == 1) {
+    const auto& transaction = batch_.front();
+    ok = bus_.Transfer(address, transaction.write, transaction.write_size, transaction.read, transaction.read_size);
+  } else {
+    ok = bus_.Transfer(address, batch_.front().write, 1, batch_buffer_, read_size);
+    size_t offset = 0;
+    for (auto& transaction : batch_) {
+      if (ok) {
+        memcpy(transaction.read, batch_buffer_ + offset, transaction.read_size);
+      }
+      offset += transaction.read_size;
+    }
+  }
+  const auto end_us = NowUs();
+
+  lock.lock();
+  auto& stats = device->stats;
+  const auto bus_us = static_cast<uint32_t>(end_us - start_us);
+  stats.transfers++;
+  device->bus_us_total += bus_us;
+  stats.bus_us_max = std::max(stats.bus_us_max, bus_us);
+  for (const auto& transaction : batch_) {
+    const auto wait_us = static_cast<uint32_t>(start_us - transaction.submit_us);
+    stats.transactions++;
+    device->wait_us_total += wait_us;
+    stats.wait_us_max = std::max(stats.wait_us_max, wait_us);
+    if (!ok) {
+      stats.errors++;
+    }
+  }
+  lock.unlock();
+
+  for (auto& transaction : batch_) {
+    if (transaction.callback) {
+      transaction.callback(ok);
+    }
+  }
+  return true;
+}
+
+void I2cBusManager::Run() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      work_cv_.wait(lock, [this] { return stopped_ || pending_ > 0; });
+      if (stopped_) {
+        return;
+      }
+    }
+    ProcessOne();
+  }
+}
+
+void I2cBusManager::Stop() {
+  std::vector<Transaction> cancelled;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopped_ = true;
+    for (auto& device : devices_) {
+      device->stats.errors += device->queue.size();
+      for (auto& transaction : device->queue) {
+        cancelled.push_back(std::move(transaction));
+      }
+      device->queue.clear();
+    }
+    pending_ = 0;
+  }
+  work_cv_.notify_all();
+
+  // 回调可能再次加锁(如同步调用的等待)，在锁外调用
+  for (auto& transaction : cancelled) {
+    if (transaction.callback) {
+      transaction.callback(false);
+    }
+  }
+}
+
+bool I2cBusManager::GetStats(int device, I2cDeviceStats* stats) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (device < 0 || static_cast<size_t>(device) >= devices_.size()) {
+    return false;
+  }
+  const auto& target = *devices_[device];
+  *stats = target.stats;
+  if (stats->transactions > 0) {
+    stats->wait_us_avg = static_cast<uint32_t>(target.wait_us_total / stats->transactions);
+  }
+  if (stats->transfers > 0) {
+    stats->bus_us_avg = static_cast<uint32_t>(target.bus_us_total / stats->transfers);
+  }
+  return true;
+}
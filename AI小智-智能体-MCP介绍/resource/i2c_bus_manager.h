@@ -0,0 +1,176 @@
+#pragma once
+
+#ifndef _I2C_BUS_MANAGER_H_
+#define _I2C_BUS_MANAGER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @file i2c_bus_manager.h
+ * @brief 共享 I2C 总线的异步事务队列
+ *
+ * 音频芯片和各种外接传感器、驱动板共用一条 I2C 总线，分散在不同任务中阻塞读写时
+ * 互相等待，也无法知道等待了多久。总线管理器为每个设备维护一个事务队列，由一个工作
+ * 任务按设备优先级依次执行(同优先级按提交顺序)；同一设备排队中的相邻寄存器读取合并为
+ * 一次传输。每个设备单独统计排队等待时间和总线占用时间。
+ *
+ * 管理器只依赖 I2cBus 接口和标准库，不依赖 ESP-IDF：设备上使用 EspI2cBus，
+ * 主机上可以用 SimulatedI2cBus 代替，直接调用 ProcessOne() 执行事务。
+ *
+ * 示例：
+ * @code
+ * const int sensor = manager.AddDevice({"bh1750", 0x23, I2cPriority::kLow, false});
+ * static uint8_t data[2];
+ * manager.ReadRegisters(sensor, 0x10, data, sizeof(data), [](bool ok) {
+ *   // 在工作任务中调用，data 此时已填好
+ * });
+ * @endcode
+ */
+
+/**
+ * @brief I2C 总线的传输接口
+ */
+class I2cBus {
+ public:
+  virtual ~I2cBus() = default;
+
+  /**
+   * @brief 向 address 写入 write_size 字节，再读取 read_size 字节(为0时只写)，成功返回true
+   */
+  virtual bool Transfer(uint16_t address, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size) = 0;
+};
+
+/**
+ * @brief 设备优先级，高优先级设备的事务先执行
+ */
+enum class I2cPriority : uint8_t {
+  kLow,     // 传感器轮询
+  kNormal,
+  kHigh,    // 音频芯片等控制类设备
+};
+
+struct I2cDeviceConfig {
+  const char* name;
+  uint16_t address;  // 7位地址
+  I2cPriority priority = I2cPriority::kNormal;
+  // 连续读取时寄存器地址自动递增，允许把相邻的寄存器读取合并为一次传输
+  bool auto_increment = false;
+};
+
+struct I2cDeviceStats {
+  uint32_t transactions = 0;  // 已完成的事务数
+  uint32_t transfers = 0;     // 实际的总线传输次数，合并读取时小于 transactions
+  uint32_t errors = 0;        // 失败的事务数
+  uint32_t dropped = 0;       // 队列已满而被拒绝的事务数
+  uint32_t wait_us_avg = 0;   // 从提交到开始传输的时间
+  uint32_t wait_us_max = 0;
+  uint32_t bus_us_avg = 0;    // 每次传输占用总线的时间
+  uint32_t bus_us_max = 0;
+};
+
+/**
+ * @brief 事务完成回调，在工作任务中调用
+ */
+using I2cCallback = std::function<void(bool ok)>;
+
+class I2cBusManager {
+ public:
+  static constexpr size_t kMaxWriteSize = 8;
+  static constexpr size_t kMaxQueueDepth = 16;
+  static constexpr size_t kMaxBatchReadSize = 32;
+
+  explicit I2cBusManager(I2cBus& bus);
+
+  /**
+   * @brief 添加一个设备，返回设备编号
+   */
+  int AddDevice(const I2cDeviceConfig& config);
+
+  /**
+   * @brief 异步提交事务，队列已满、参数无效或已 Stop() 时返回false且不会调用 callback
+   *
+   * read 指向的缓冲区必须保持有效直到 callback 被调用。
+   */
+  bool Write(int device, const uint8_t* data, size_t size, I2cCallback callback = nullptr);
+  bool WriteRead(int device, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size,
+                 I2cCallback callback = nullptr);
+  bool ReadRegisters(int device, uint8_t reg, uint8_t* data, size_t size, I2cCallback callback = nullptr);
+  bool WriteRegister(int device, uint8_t reg, uint8_t value, I2cCallback callback = nullptr);
+
+  /**
+   * @brief 同步版本，提交后等待完成；不能在工作任务(即事务回调)中调用
+   */
+  bool ReadRegistersSync(int device, uint8_t reg, uint8_t* data, size_t size);
+  bool WriteRegisterSync(int device, uint8_t reg, uint8_t value);
+
+  /**
+   * @brief 执行优先级最高的一个事务(或一批合并的寄存器读取)，没有待执行事务时返回false
+   */
+  bool ProcessOne();
+
+  /**
+   * @brief 工作任务的主循环，等待并执行事务，直到 Stop() 被调用
+   */
+  void Run();
+
+  /**
+   * @brief 让 Run() 在当前事务完成后返回
+   *
+   * 排队中尚未执行的事务以 callback(false) 结束(在调用 Stop() 的任务中)，
+   * 之后提交的事务直接被拒绝，等待中的同步调用因此不会永远阻塞。
+   */
+  void Stop();
+
+  bool GetStats(int device, I2cDeviceStats* stats) const;
+
+ private:
+  struct Transaction {
+    uint8_t write[kMaxWriteSize];
+    size_t write_size = 0;
+    uint8_t* read = nullptr;
+    size_t read_size = 0;
+    bool register_read = false;  // write[0] 为寄存器地址的单字节写入后读取
+    I2cCallback callback;
+    int64_t submit_us = 0;
+    uint64_t sequence = 0;
+  };
+
+  struct Device {
+    std::string name;
+    uint16_t address = 0;
+    I2cPriority priority = I2cPriority::kNormal;
+    bool auto_increment = false;
+    std::deque<Transaction> queue;
+
+    I2cDeviceStats stats;
+    uint64_t wait_us_total = 0;
+    uint64_t bus_us_total = 0;
+  };
+
+  bool Submit(int device, Transaction&& transaction);
+  bool WaitFor(const std::function<bool(I2cCallback)>& submit);
+  Device* NextDevice();
+
+  I2cBus& bus_;
+  mutable std::mutex mutex_;
+  std::condition_variable work_cv_;
+  std::condition_variable done_cv_;
+  std::vector<std::unique_ptr<Device>> devices_;
+  size_t pending_ = 0;
+  uint64_t next_sequence_ = 0;
+  bool stopped_ = false;
+
+  // 以下只由执行事务的任务访问
+  std::vector<Transaction> batch_;
+  uint8_t batch_buffer_[kMaxBatchReadSize];
+};
+
+#endif
@@ -0,0 +1,176 @@
+#include "json_writer.h"
+
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+JsonWriter::JsonWriter(char* buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {
+  Reset();
+}
+
+void JsonWriter::Reset() {
+  size_ = 0;
+  required_ = 0;
+  overflow_ = capacity_ == 0;
+  depth_ = 0;
+  has_items_ = 0;
+  after_key_ = false;
+  if (capacity_ > 0) {
+    buffer_[0] = '\0';
+  }
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+  Open('{');
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+  Close('}');
+  return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+  Open('[');
+  return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+  Close(']');
+  return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+  String(key);
+  Put(':');
+  after_key_ = true;
+  return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+  BeforeValue();
+  Put('"');
+  size_t start = 0;
+  for (size_t i = 0; i < value.size(); i++) {
+    const auto c = static_cast<unsigned char>(value[i]);
+    if (c != '"' && c != '\\' && c >= 0x20) {
+      continue;
+    }
+    // 不需要转义的部分整段复制
+    Write(value.data() + start, i - start);
+    start = i + 1;
+    if (c == '"' || c == '\\') {
+      Put('\\');
+      Put(static_cast<char>(c));
+    } else {
+      char escaped[8];
+      snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+      Write(escaped, 6);
+    }
+  }
+  Write(value.data() + start, value.size() - start);
+  Put('"');
+  return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+  BeforeValue();
+  char number[24];
+  Write(number, snprintf(number, sizeof(number), "%" PRId64, value));
+  return *this;
+}
+
+JsonWriter& JsonWriter::Uint(uint64_t value) {
+  BeforeValue();
+  char number[24];
+  Write(number, snprintf(number, sizeof(number), "%" PRIu64, value));
+  return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+  // JSON 不能表示 NaN 和无穷大
+  if (!std::isfinite(value)) {
+    return Null();
+  }
+  BeforeValue();
+  char number[32];
+  Write(number, snprintf(number, sizeof(number), "%.6g", value));
+  return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+  BeforeValue();
+  value ? Write("true", 4) : Write("false", 5);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+  BeforeValue();
+  Write("null", 4);
+  return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+  BeforeValue();
+  Write(json.data(), json.size());
+  return *this;
+}
+
+bool JsonWriter::ok() const {
+  return !overflow_ && depth_ == 0 && !after_key_ && size_ > 0;
+}
+
+void JsonWriter::BeforeValue() {
+  if (after_key_) {
+    after_key_ = false;
+    return;
+  }
+  if (depth_ == 0) {
+    return;
+  }
+  const uint32_t bit = 1u << (depth_ - 1);
+  if (has_items_ & bit) {
+    Put(',');
+  }
+  has_items_ |= bit;
+}
+
+void JsonWriter::Open(char c) {
+  BeforeValue();
+  if (depth_ == kMaxDepth) {
+    overflow_ = true;
+    return;
+  }
+  Put(c);
+  depth_++;
+  has_items_ &= ~(1u << (depth_ - 1));
+}
+
+void JsonWriter::Close(char c) {
+  if (depth_ == 0) {
+    overflow_ = true;
+    return;
+  }
+  depth_--;
+  Put(c);
+}
+
+void JsonWriter::Write(const char* data, size_t length) {
+  required_ += length;
+  if (overflow_) {
+    return;
+  }
+  // 保留一个字节给结尾的'\0'
+  if (length >= capacity_ - size_) {
+    overflow_ = true;
+    return;
+  }
+  memcpy(buffer_ + size_, data, length);
+  size_ += length;
+  buffer_[size_] = '\0';
+}
+
+void JsonWriter::Put(char c) {
+  Write(&c, 1);
+}
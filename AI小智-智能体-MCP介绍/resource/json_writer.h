@@ -0,0 +1,134 @@
+#pragma once
+
+#ifndef _JSON_WRITER_H_
+#define _JSON_WRITER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * @file json_writer.h
+ * @brief 直接写入固定缓冲区的流式 JSON 写入器
+ *
+ * 不分配内存，也不先构建文档再序列化：每个值写入时立即格式化到调用者提供的缓冲区，
+ * 逗号和字符串转义自动处理。缓冲区不足时停止写入并标记溢出，不会越界。
+ *
+ * 示例：
+ * @code
+ * JsonWriter& writer = BeginMcpJsonResponse();
+ * writer.BeginObject();
+ * writer.Field("status", "success");
+ * writer.Field("temperature", 25);
+ * writer.EndObject();
+ * SendMcpJsonResponse(event.id, writer);
+ * @endcode
+ */
+class JsonWriter {
+ public:
+  JsonWriter(char* buffer, size_t capacity);
+
+  /**
+   * @brief 清空已写入的内容，复用同一个缓冲区
+   */
+  void Reset();
+
+  JsonWriter& BeginObject();
+  JsonWriter& EndObject();
+  JsonWriter& BeginArray();
+  JsonWriter& EndArray();
+
+  /**
+   * @brief 写入对象的键，之后必须写入一个值
+   */
+  JsonWriter& Key(std::string_view key);
+
+  JsonWriter& String(std::string_view value);
+  JsonWriter& Int(int64_t value);
+  JsonWriter& Uint(uint64_t value);
+  JsonWriter& Double(double value);
+  JsonWriter& Bool(bool value);
+  JsonWriter& Null();
+
+  /**
+   * @brief 写入已编码的 JSON 值，内容原样复制，不做检查
+   */
+  JsonWriter& Raw(std::string_view json);
+
+  /**
+   * @brief 按类型写入一个值，支持 bool、整数、浮点数和字符串
+   */
+  template <typename T>
+  JsonWriter& Value(const T& value) {
+    if constexpr (std::is_same_v<T, bool>) {
+      return Bool(value);
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      return Int(value);
+    } else if constexpr (std::is_integral_v<T>) {
+      return Uint(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+      return Double(value);
+    } else {
+      return String(value);
+    }
+  }
+
+  /**
+   * @brief 写入对象中的一个键值对
+   */
+  template <typename T>
+  JsonWriter& Field(std::string_view key, const T& value) {
+    return Key(key).Value(value);
+  }
+
+  /**
+   * @brief 未溢出且所有对象和数组都已闭合
+   */
+  bool ok() const;
+
+  bool overflow() const {
+    return overflow_;
+  }
+
+  /**
+   * @brief 已写入的内容，始终以'\0'结尾
+   */
+  const char* c_str() const {
+    return buffer_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+  /**
+   * @brief 写入全部内容所需的缓冲区大小(含结尾的'\0')，溢出后仍继续累计
+   *
+   * 用 JsonWriter(nullptr, 0) 先写一遍即可得到大小，再按该大小分配缓冲区写入。
+   */
+  size_t required() const {
+    return required_ + 1;
+  }
+
+ private:
+  static constexpr uint32_t kMaxDepth = 32;
+
+  void BeforeValue();
+  void Open(char c);
+  void Close(char c);
+  void Write(const char* data, size_t length);
+  void Put(char c);
+
+  char* const buffer_;
+  const size_t capacity_;
+  size_t size_ = 0;
+  size_t required_ = 0;
+  bool overflow_ = false;
+  uint32_t depth_ = 0;
+  // 第n位表示第n层的对象或数组中已经有元素，下一个元素前需要逗号
+  uint32_t has_items_ = 0;
+  bool after_key_ = false;
+};
+
+#endif
@@ -0,0 +1,301 @@
+#include "latency_trace.h"
+
+#include <esp_timer.h>
+
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t kMaxTraceRecords = 128;
+constexpr size_t kMaxOpenMcpCalls = 8;
+// 直方图分桶上限(毫秒)，最后一个桶记录超出所有上限的值
+constexpr std::array<uint32_t, 8> kBucketLimitsMs = {50, 100, 200, 500, 1000, 2000, 5000, 10000};
+
+enum class TraceKind : uint8_t {
+  kInstant,
+  kState,
+  kMcpCall,
+};
+
+struct TraceRecord {
+  const char* name = nullptr;
+  int64_t timestamp_us = 0;
+  uint32_t duration_us = 0;
+  TraceKind kind = TraceKind::kInstant;
+};
+
+struct Histogram {
+  const char* name;
+  std::array<uint32_t, kBucketLimitsMs.size() + 1> buckets{};
+  uint32_t count = 0;
+  uint64_t total_ms = 0;
+  uint32_t max_ms = 0;
+};
+
+struct OpenMcpCall {
+  int64_t id = 0;
+  const char* name = nullptr;
+  int64_t start_us = 0;
+  bool deferred = false;
+};
+
+enum HistogramIndex {
+  kButtonToListening,
+  kListeningToSpeaking,
+  kListeningToFirstMessage,
+  kMcpCallToResponse,
+  kHistogramCount,
+};
+
+std::array<Histogram, kHistogramCount> g_histograms = {{
+    {"button_to_listening"},
+    {"listening_to_speaking"},
+    {"listening_to_first_message"},
+    {"mcp_call_to_response"},
+}};
+
+std::array<TraceRecord, kMaxTraceRecords> g_records;
+size_t g_record_count = 0;
+size_t g_next_record = 0;
+
+std::array<OpenMcpCall, kMaxOpenMcpCalls> g_open_mcp_calls;
+
+// 按钮回调在其他任务中执行，只通过这个原子变量与主循环交互
+std::atomic<int64_t> g_button_press_us{0};
+int64_t g_listening_start_us = 0;
+// 进入聆听状态后尚未收到对话消息时非0
+int64_t g_first_message_start_us = 0;
+const char* g_state_name = nullptr;
+int64_t g_state_start_us = 0;
+
+void AddRecord(TraceKind kind, const char* name, int64_t timestamp_us, uint32_t duration_us = 0) {
+  auto& record = g_records[g_next_record];
+  record.name = name;
+  record.timestamp_us = timestamp_us;
+  record.duration_us = duration_us;
+  record.kind = kind;
+  g_next_record = (g_next_record + 1) % g_records.size();
+  if (g_record_count < g_records.size()) {
+    g_record_count++;
+  }
+}
+
+void AddSample(HistogramIndex index, int64_t elapsed_us) {
+  auto& histogram = g_histograms[index];
+  const auto elapsed_ms = static_cast<uint32_t>(elapsed_us / 1000);
+  size_t bucket = 0;
+  while (bucket < kBucketLimitsMs.size() && elapsed_ms > kBucketLimitsMs[bucket]) {
+    bucket++;
+  }
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.total_ms += elapsed_ms;
+  if (elapsed_ms > histogram.max_ms) {
+    histogram.max_ms = elapsed_ms;
+  }
+}
+
+const char* StateName(ai_vox::ChatState state) {
+  switch (state) {
+    case ai_vox::ChatState::kIdle:
+      return "Idle";
+    case ai_vox::ChatState::kInitted:
+      return "Initted";
+    case ai_vox::ChatState::kLoading:
+      return "Loading";
+    case ai_vox::ChatState::kLoadingFailed:
+      return "LoadingFailed";
+    case ai_vox::ChatState::kStandby:
+      return "Standby";
+    case ai_vox::ChatState::kConnecting:
+      return "Connecting";
+    case ai_vox::ChatState::kListening:
+      return "Listening";
+    case ai_vox::ChatState::kSpeaking:
+      return "Speaking";
+    default:
+      return "Unknown";
+  }
+}
+
+OpenMcpCall* FindOpenMcpCall(int64_t id) {
+  for (auto& call : g_open_mcp_calls) {
+    if (call.name != nullptr && call.id == id) {
+      return &call;
+    }
+  }
+  return nullptr;
+}
+
+void CloseMcpCall(OpenMcpCall& call, int64_t now_us) {
+  AddRecord(TraceKind::kMcpCall, call.name, call.start_us, static_cast<uint32_t>(now_us - call.start_us));
+  AddSample(kMcpCallToResponse, now_us - call.start_us);
+  call = OpenMcpCall();
+}
+
+void PrintJsonString(const char* value) {
+  putchar('"');
+  for (const char* p = value; *p != '\0'; p++) {
+    if (*p == '"' || *p == '\\') {
+      putchar('\\');
+    }
+    putchar(*p);
+  }
+  putchar('"');
+}
+
+}  // namespace
+
+void TraceButtonPress() {
+  g_button_press_us.store(esp_timer_get_time(), std::memory_order_relaxed);
+}
+
+void TraceStateChanged(ai_vox::ChatState state) {
+  const auto now_us = esp_timer_get_time();
+
+  // 上一个状态作为一个完整区间记录
+  if (g_state_name != nullptr) {
+    AddRecord(TraceKind::kState, g_state_name, g_state_start_us, static_cast<uint32_t>(now_us - g_state_start_us));
+  }
+  g_state_name = StateName(state);
+  g_state_start_us = now_us;
+
+  const auto button_press_us = g_button_press_us.load(std::memory_order_relaxed);
+
+  switch (state) {
+    case ai_vox::ChatState::kListening:
+      if (button_press_us != 0) {
+        AddSample(kButtonToListening, now_us - button_press_us);
+      }
+      g_listening_start_us = now_us;
+      g_first_message_start_us = now_us;
+      break;
+    case ai_vox::ChatState::kSpeaking:
+      if (g_listening_start_us != 0) {
+        AddSample(kListeningToSpeaking, now_us - g_listening_start_us);
+        g_listening_start_us = 0;
+      }
+      break;
+    case ai_vox::ChatState::kIdle:
+    case ai_vox::ChatState::kStandby:
+      g_listening_start_us = 0;
+      g_first_message_start_us = 0;
+      break;
+    default:
+      break;
+  }
+
+  // 按钮按下后经过连接等中间状态才进入聆听，因此只在进入聆听或回到待命时清除
+  if (button_press_us != 0 &&
+      (state == ai_vox::ChatState::kListening || state == ai_vox::ChatState::kStandby || state == ai_vox::ChatState::kIdle)) {
+    AddRecord(TraceKind::kInstant, "ButtonPress", button_press_us);
+    // 期间若又按下按钮则保留新的时间
+    int64_t expected = button_press_us;
+    g_button_press_us.compare_exchange_strong(expected, 0, std::memory_order_relaxed);
+  }
+}
+
+void TraceChatMessage(ai_vox::ChatRole role) {
+  const auto now_us = esp_timer_get_time();
+  AddRecord(TraceKind::kInstant, role == ai_vox::ChatRole::kUser ? "UserMessage" : "AssistantMessage", now_us);
+  if (g_first_message_start_us != 0) {
+    AddSample(kListeningToFirstMessage, now_us - g_first_message_start_us);
+    g_first_message_start_us = 0;
+  }
+}
+
+void TraceInstant(const char* name) {
+  AddRecord(TraceKind::kInstant, name, esp_timer_get_time());
+}
+
+void TraceMcpCallStart(int64_t id, const char* name) {
+  // 没有空位时覆盖最早开始的调用，被覆盖的调用不再计入直方图
+  auto slot = &g_open_mcp_calls[0];
+  for (auto& call : g_open_mcp_calls) {
+    if (call.name == nullptr) {
+      slot = &call;
+      break;
+    }
+    if (call.start_us < slot->start_us) {
+      slot = &call;
+    }
+  }
+  slot->id = id;
+  slot->name = name;
+  slot->start_us = esp_timer_get_time();
+  slot->deferred = false;
+}
+
+void TraceMcpCallDeferred(int64_t id) {
+  if (auto call = FindOpenMcpCall(id)) {
+    call->deferred = true;
+  }
+}
+
+void TraceMcpCallReturned(int64_t id) {
+  auto call = FindOpenMcpCall(id);
+  if (call != nullptr && !call->deferred) {
+    CloseMcpCall(*call, esp_timer_get_time());
+  }
+}
+
+void TraceMcpCallEnd(int64_t id) {
+  if (auto call = FindOpenMcpCall(id)) {
+    CloseMcpCall(*call, esp_timer_get_time());
+  }
+}
+
+void PrintLatencyHistograms() {
+  for (const auto& histogram : g_histograms) {
+    if (histogram.count == 0) {
+      continue;
+    }
+    printf("latency %s: %" PRIu32 " samples, avg %" PRIu64 " ms, max %" PRIu32 " ms |",
+           histogram.name, histogram.count, histogram.total_ms / histogram.count, histogram.max_ms);
+    for (size_t i = 0; i < kBucketLimitsMs.size(); i++) {
+      printf(" <=%" PRIu32 ":%" PRIu32, kBucketLimitsMs[i], histogram.buckets[i]);
+    }
+    printf(" >%" PRIu32 ":%" PRIu32 "\n", kBucketLimitsMs.back(), histogram.buckets.back());
+  }
+}
+
+void DumpChromeTrace() {
+  printf("----- chrome trace begin -----\n");
+  printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  // 状态在线程1，MCP调用在线程2
+  printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"chat state\"}},\n");
+  printf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"mcp calls\"}}");
+
+  const size_t first = (g_next_record + g_records.size() - g_record_count) % g_records.size();
+  for (size_t i = 0; i < g_record_count; i++) {
+    const auto& record = g_records[(first + i) % g_records.size()];
+    printf(",\n{\"name\":");
+    PrintJsonString(record.name);
+    switch (record.kind) {
+      case TraceKind::kInstant:
+        printf(",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":1,\"ts\":%" PRId64 "}", record.timestamp_us);
+        break;
+      case TraceKind::kState:
+        printf(",\"cat\":\"state\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%" PRId64 ",\"dur\":%" PRIu32 "}",
+               record.timestamp_us, record.duration_us);
+        break;
+      case TraceKind::kMcpCall:
+        printf(",\"cat\":\"mcp\",\"ph\":\"X\",\"pid\":1,\"tid\":2,\"ts\":%" PRId64 ",\"dur\":%" PRIu32 "}",
+               record.timestamp_us, record.duration_us);
+        break;
+    }
+  }
+
+  // 尚未结束的状态也输出，便于查看最后一段
+  if (g_state_name != nullptr) {
+    printf(",\n{\"name\":");
+    PrintJsonString(g_state_name);
+    printf(",\"cat\":\"state\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}",
+           g_state_start_us, esp_timer_get_time() - g_state_start_us);
+  }
+  printf("\n]}\n");
+  printf("----- chrome trace end -----\n");
+}
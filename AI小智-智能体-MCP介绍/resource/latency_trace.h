@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef _LATENCY_TRACE_H_
+#define _LATENCY_TRACE_H_
+
+#include <cstdint>
+
+#include "ai_vox_engine.h"
+
+/**
+ * @file latency_trace.h
+ * @brief 对话延迟追踪
+ *
+ * 主循环中观察到的事件都会带上时间戳写入一个固定大小的环形缓冲区(满时覆盖最旧的记录)，
+ * 同时把关键阶段之间的耗时计入固定分桶的直方图：
+ * - button_to_listening：按下按钮到进入聆听状态
+ * - listening_to_speaking：进入聆听状态到开始说话
+ * - listening_to_first_message：进入聆听状态到收到第一条对话消息
+ * - mcp_call_to_response：收到 MCP 调用到发出响应
+ *
+ * 除 TraceButtonPress() 外，所有函数都只能在主循环所在任务中调用。
+ */
+
+/**
+ * @brief 记录按钮按下，可在按钮回调等任意任务中调用
+ */
+void TraceButtonPress();
+
+void TraceStateChanged(ai_vox::ChatState state);
+
+void TraceChatMessage(ai_vox::ChatRole role);
+
+/**
+ * @brief 记录一个瞬时事件，name 必须是在程序运行期间一直有效的字符串
+ */
+void TraceInstant(const char* name);
+
+/**
+ * @brief 记录 MCP 调用开始，name 必须是在程序运行期间一直有效的字符串
+ */
+void TraceMcpCallStart(int64_t id, const char* name);
+
+/**
+ * @brief 标记该调用的响应将在处理函数返回后异步发出
+ */
+void TraceMcpCallDeferred(int64_t id);
+
+/**
+ * @brief 处理函数返回，未标记为异步的调用视为已响应
+ */
+void TraceMcpCallReturned(int64_t id);
+
+/**
+ * @brief 记录 MCP 调用已发出响应
+ */
+void TraceMcpCallEnd(int64_t id);
+
+/**
+ * @brief 打印各直方图的调用次数、平均值、最大值和分桶计数
+ */
+void PrintLatencyHistograms();
+
+/**
+ * @brief 以 Chrome trace 格式(JSON)通过串口输出环形缓冲区中的全部记录
+ *
+ * 复制 begin/end 标记之间的内容保存为 .json 文件，即可在 chrome://tracing 或 Perfetto 中查看。
+ */
+void DumpChromeTrace();
+
+#endif
@@ -0,0 +1,194 @@
+#include "led_effects.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "metrics.h"
+
+namespace {
+
+constexpr uint32_t kFrameIntervalMs = 20;  // 50fps
+constexpr uint32_t kTaskStackSize = 3072;
+constexpr UBaseType_t kTaskPriority = 3;
+// Arduino 的 loop() 运行在核心1，动画任务固定在核心0，避免主循环的负载造成闪烁
+constexpr BaseType_t kTaskCore = 0;
+// 超过该数量的灯珠使用RMT DMA发送，避免逐块填充RMT内存时因中断延迟产生时序错误
+constexpr uint32_t kDmaLedThreshold = 64;
+constexpr size_t kDmaMemBlockSymbols = 1024;
+constexpr float kGamma = 2.2f;
+constexpr uint32_t kChaseTailLength = 4;
+
+uint8_t Channel(uint32_t color, int shift) {
+  return static_cast<uint8_t>(color >> shift);
+}
+
+// 色相 0-255 转换为饱和度和亮度都最大的颜色
+uint32_t ColorWheel(uint8_t hue) {
+  const uint8_t segment = hue / 85;
+  const uint8_t offset = (hue % 85) * 3;
+  switch (segment) {
+    case 0:
+      return (static_cast<uint32_t>(255 - offset) << 16) | (static_cast<uint32_t>(offset) << 8);
+    case 1:
+      return (static_cast<uint32_t>(255 - offset) << 8) | offset;
+    default:
+      return (static_cast<uint32_t>(offset) << 16) | (255 - offset);
+  }
+}
+
+}  // namespace
+
+LedEffects::LedEffects(gpio_num_t gpio, uint32_t led_count)
+    : led_count_(led_count), frame_(led_count * 3), last_frame_(led_count * 3) {
+  const bool with_dma = led_count > kDmaLedThreshold;
+  led_strip_config_t strip_config = {
+      .strip_gpio_num = gpio,
+      .max_leds = led_count,
+      .led_model = LED_MODEL_WS2812,
+      .color_component_format = LED_STRIP_COLOR_COMPONENT_FMT_GRB,
+      .flags = {
+          .invert_out = false,
+      }};
+
+  led_strip_rmt_config_t rmt_config = {
+      .clk_src = RMT_CLK_SRC_DEFAULT,
+      .resolution_hz = 10 * 1000 * 1000,
+      .mem_block_symbols = with_dma ? kDmaMemBlockSymbols : 0,
+      .flags = {
+          .with_dma = with_dma,
+      }};
+  ESP_ERROR_CHECK(led_strip_new_rmt_device(&strip_config, &rmt_config, &strip_));
+  ESP_ERROR_CHECK(led_strip_clear(strip_));
+
+  for (size_t i = 0; i < gamma_.size(); i++) {
+    gamma_[i] = static_cast<uint8_t>(std::lround(std::pow(i / 255.0f, kGamma) * 255.0f));
+  }
+  UpdateLut(brightness_.load());
+
+  effect_queue_ = xQueueCreate(1, sizeof(Effect));
+  if (effect_queue_ == nullptr) {
+    printf("Failed to create led effect queue\n");
+    abort();
+  }
+
+  if (xTaskCreatePinnedToCore(Task, "led_effects", kTaskStackSize, this, kTaskPriority, &task_, kTaskCore) != pdPASS) {
+    printf("Failed to create led effects task\n");
+    abort();
+  }
+  RegisterMetricTask("led_effects", task_);
+}
+
+LedEffects::~LedEffects() {
+  UnregisterMetricTask(task_);
+  vTaskDelete(task_);
+  vQueueDelete(effect_queue_);
+  led_strip_clear(strip_);
+  led_strip_del(strip_);
+}
+
+void LedEffects::SetEffect(const Effect& effect) {
+  // 队列深度为1，未被取走的旧效果直接被覆盖
+  xQueueOverwrite(effect_queue_, &effect);
+}
+
+void LedEffects::SetBrightness(uint8_t brightness) {
+  brightness_.store(brightness);
+}
+
+void LedEffects::Task(void* arg) {
+  static_cast<LedEffects*>(arg)->Loop();
+}
+
+void LedEffects::Loop() {
+  Effect effect;
+  TickType_t effect_start_tick = xTaskGetTickCount();
+  TickType_t last_wake_tick = xTaskGetTickCount();
+  while (true) {
+    if (xQueueReceive(effect_queue_, &effect, 0) == pdTRUE) {
+      effect_start_tick = xTaskGetTickCount();
+      if (effect.period_ms == 0) {
+        effect.period_ms = 1;
+      }
+    }
+
+    const auto brightness = brightness_.load();
+    if (brightness != lut_brightness_) {
+      UpdateLut(brightness);
+    }
+
+    Render(effect, pdTICKS_TO_MS(xTaskGetTickCount() - effect_start_tick));
+    if (frame_ != last_frame_) {
+      for (uint32_t i = 0; i < led_count_; i++) {
+        ESP_ERROR_CHECK(led_strip_set_pixel(strip_, i, frame_[i * 3], frame_[i * 3 + 1], frame_[i * 3 + 2]));
+      }
+      ESP_ERROR_CHECK(led_strip_refresh(strip_));
+      last_frame_ = frame_;
+    }
+
+    // 固定帧率，计算和刷新的耗时不会累积成帧间隔的抖动
+    vTaskDelayUntil(&last_wake_tick, pdMS_TO_TICKS(kFrameIntervalMs));
+  }
+}
+
+void LedEffects::Render(const Effect& effect, uint32_t elapsed_ms) {
+  const uint32_t phase = elapsed_ms % effect.period_ms;
+  switch (effect.mode) {
+    case Mode::kOff:
+      std::fill(frame_.begin(), frame_.end(), 0);
+      break;
+    case Mode::kSolid:
+      for (uint32_t i = 0; i < led_count_; i++) {
+        SetPixel(i, effect.color, 255);
+      }
+      break;
+    case Mode::kBlink: {
+      const uint8_t level = phase < effect.period_ms / 2 ? 255 : 0;
+      for (uint32_t i = 0; i < led_count_; i++) {
+        SetPixel(i, effect.color, level);
+      }
+      break;
+    }
+    case Mode::kBreathe: {
+      // 三角波，经过gamma查找表后亮度变化接近人眼感知的线性
+      const uint32_t half_period = std::max<uint32_t>(effect.period_ms / 2, 1);
+      const uint32_t ramp = phase < half_period ? phase : effect.period_ms - phase;
+      const auto level = static_cast<uint8_t>(std::min<uint32_t>(ramp * 255 / half_period, 255));
+      for (uint32_t i = 0; i < led_count_; i++) {
+        SetPixel(i, effect.color, level);
+      }
+      break;
+    }
+    case Mode::kChase: {
+      // 一个周期内光点走完整条灯带，后面拖一段逐渐变暗的尾巴
+      const uint32_t head = phase * led_count_ / effect.period_ms;
+      for (uint32_t i = 0; i < led_count_; i++) {
+        const uint32_t distance = (head + led_count_ - i) % led_count_;
+        const uint8_t level = distance < kChaseTailLength ? 255 * (kChaseTailLength - distance) / kChaseTailLength : 0;
+        SetPixel(i, effect.color, level);
+      }
+      break;
+    }
+    case Mode::kRainbow: {
+      const uint32_t hue_offset = phase * 256 / effect.period_ms;
+      for (uint32_t i = 0; i < led_count_; i++) {
+        SetPixel(i, ColorWheel(static_cast<uint8_t>(hue_offset + i * 256 / led_count_)), 255);
+      }
+      break;
+    }
+  }
+}
+
+void LedEffects::SetPixel(uint32_t index, uint32_t color, uint8_t level) {
+  frame_[index * 3] = lut_[Channel(color, 16) * level / 255];
+  frame_[index * 3 + 1] = lut_[Channel(color, 8) * level / 255];
+  frame_[index * 3 + 2] = lut_[Channel(color, 0) * level / 255];
+}
+
+void LedEffects::UpdateLut(uint8_t brightness) {
+  for (size_t i = 0; i < lut_.size(); i++) {
+    lut_[i] = static_cast<uint8_t>(gamma_[i] * brightness / 255);
+  }
+  lut_brightness_ = brightness;
+}
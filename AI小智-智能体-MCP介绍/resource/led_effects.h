@@ -0,0 +1,76 @@
+#pragma once
+
+#ifndef _LED_EFFECTS_H_
+#define _LED_EFFECTS_H_
+
+#include <driver/gpio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "led_strip.h"
+
+/**
+ * @file led_effects.h
+ * @brief WS2812 灯带动画引擎
+ *
+ * 动画在独立任务中以固定帧率计算和刷新，调用者只提交要播放的效果，不会被刷新阻塞。
+ * 颜色经过预先计算的 gamma 和亮度查找表转换；画面没有变化时不刷新灯带。
+ * 灯珠数量较多时使用 RMT 的 DMA 通道发送数据。
+ */
+class LedEffects {
+ public:
+  enum class Mode : uint8_t {
+    kOff,
+    kSolid,
+    kBlink,
+    kBreathe,
+    kChase,
+    kRainbow,
+  };
+
+  struct Effect {
+    Mode mode = Mode::kOff;
+    uint32_t color = 0;  // 0xRRGGBB
+    uint32_t period_ms = 1000;
+  };
+
+  LedEffects(gpio_num_t gpio, uint32_t led_count);
+  ~LedEffects();
+
+  /**
+   * @brief 切换效果，可在任意任务中调用，立即返回，在下一帧生效
+   */
+  void SetEffect(const Effect& effect);
+
+  /**
+   * @brief 设置全局亮度，0-255
+   */
+  void SetBrightness(uint8_t brightness);
+
+ private:
+  static void Task(void* arg);
+  void Loop();
+  void Render(const Effect& effect, uint32_t elapsed_ms);
+  void SetPixel(uint32_t index, uint32_t color, uint8_t level);
+  void UpdateLut(uint8_t brightness);
+
+  const uint32_t led_count_;
+  led_strip_handle_t strip_ = nullptr;
+  QueueHandle_t effect_queue_ = nullptr;
+  TaskHandle_t task_ = nullptr;
+  std::atomic<uint8_t> brightness_{255};
+  uint8_t lut_brightness_ = 0;
+  std::array<uint8_t, 256> gamma_{};
+  std::array<uint8_t, 256> lut_{};
+  // 每个灯珠的RGB值(已经过查找表转换)
+  std::vector<uint8_t> frame_;
+  std::vector<uint8_t> last_frame_;
+};
+
+#endif
@@ -1,64 +1,49 @@
 #include <Arduino.h>
 #include "ai_vox3_device.h"
 #include "ai_vox_engine.h"
+#include "mcp_batch.h"
+#include "mcp_tool.h"
 
 // ========== LED 控制 MCP 工具 ==========
 
 /**
  * @brief MCP工具 - LED 开启
  *
- * 该函数注册一个名为 "user.led_on" 的MCP工具，用于开启用户LED
+ * 工具 "user.led_on" 的处理函数，用于开启用户LED，工具没有参数
  */
-void mcp_tool_led_on()
+void HandleLedOn(const ai_vox::McpToolCallEvent &ev, const McpNoArgs &)
 {
-    // 注册工具声明器，定义工具的名称、描述和参数
-    RegisterUserMcpDeclarator([](ai_vox::Engine &engine)
-                              {
-                                  engine.AddMcpTool("user.led_on",
-                                                    "Turn on user LED",
-                                                    {}); // 无参数
-                              });
-
-    // 注册工具处理器
-    RegisterUserMcpHandler("user.led_on", [](const ai_vox::McpToolCallEvent &ev)
-                           {
-        printf("LED on\n");
-        digitalWrite(1, HIGH);
-        ai_vox::Engine::GetInstance().SendMcpCallResponse(ev.id, true); });
+    printf("LED on\n");
+    digitalWrite(1, HIGH);
+    SendMcpResult(ev.id, true);
 }
 
+// 工具描述：名称、描述和参数只声明一次，schema 和参数校验都由它生成
+constexpr auto kLedOnTool = MakeMcpTool("user.led_on", "Turn on user LED");
+
 /**
  * @brief MCP工具 - LED 关闭
  *
- * 该函数注册一个名为 "user.led_off" 的MCP工具，用于关闭用户LED
+ * 工具 "user.led_off" 的处理函数，用于关闭用户LED，工具没有参数
  */
-void mcp_tool_led_off()
+void HandleLedOff(const ai_vox::McpToolCallEvent &ev, const McpNoArgs &)
 {
-    // 注册工具声明器，定义工具的名称、描述和参数
-    RegisterUserMcpDeclarator([](ai_vox::Engine &engine)
-                              {
-                                  engine.AddMcpTool("user.led_off",
-                                                    "Turn off user LED",
-                                                    {}); // 无参数
-                              });
-
-    // 注册工具处理器
-    RegisterUserMcpHandler("user.led_off", [](const ai_vox::McpToolCallEvent &ev)
-                           {
-        printf("LED off\n");
-        digitalWrite(1, LOW);
-        ai_vox::Engine::GetInstance().SendMcpCallResponse(ev.id, true); });
+    printf("LED off\n");
+    digitalWrite(1, LOW);
+    SendMcpResult(ev.id, true);
 }
 
+constexpr auto kLedOffTool = MakeMcpTool("user.led_off", "Turn off user LED");
+
 // ========== Setup 和 Loop ==========
 
 void setup()
 {
-    // 初始化 LED 开启工具
-    mcp_tool_led_on();
+    // 注册 LED 开启工具
+    RegisterUserMcpTool(McpToolEntryOf<kLedOnTool, HandleLedOn>());
 
-    // 初始化 LED 关闭工具
-    mcp_tool_led_off();
+    // 注册 LED 关闭工具
+    RegisterUserMcpTool(McpToolEntryOf<kLedOffTool, HandleLedOff>());
 
     // 初始化设备服务
     InitializeDevice();
@@ -66,6 +51,6 @@ void setup()
 
 void loop()
 {
-    // 处理设备服务主循环事件
-    ProcessMainLoop();
+    // 处理设备服务主循环事件，空闲时最多休眠20毫秒，不让 loop() 空转
+    ProcessMainLoop(20);
 }
@@ -0,0 +1,203 @@
+#include "mcp_async.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <memory>
+#include <utility>
+
+#include "ai_vox_engine.h"
+#include "latency_trace.h"
+#include "mcp_batch.h"
+#include "metrics.h"
+
+namespace {
+
+constexpr uint32_t kWorkerCount = 2;
+constexpr uint32_t kWorkerStackSize = 6144;
+constexpr UBaseType_t kWorkerPriority = 2;
+// Arduino 的 loop() 运行在核心1，工作任务固定在核心0
+constexpr BaseType_t kWorkerCore = 0;
+constexpr UBaseType_t kMaxQueuedCalls = 8;
+
+Metric& ErrorMetric() {
+  static auto& s_errors = GetMetric("mcp.errors");
+  return s_errors;
+}
+
+struct McpAsyncTool {
+  std::string name;
+  McpAsyncHandler handler;
+  uint32_t timeout_ms = 0;
+  uint32_t max_in_flight = 1;
+  std::atomic<uint32_t> in_flight{0};
+};
+
+}  // namespace
+
+// 一次异步调用，由主循环和工作任务共同持有
+class McpAsyncCall {
+ public:
+  McpAsyncCall(std::shared_ptr<McpAsyncTool> tool, const ai_vox::McpToolCallEvent& event)
+      : tool_(std::move(tool)), event_(event) {
+    if (tool_->timeout_ms > 0) {
+      deadline_us_ = esp_timer_get_time() + static_cast<int64_t>(tool_->timeout_ms) * 1000;
+    }
+  }
+
+  // 在工作任务中执行
+  void Run() {
+    tool_->handler(event_, responder_);
+    tool_->in_flight.fetch_sub(1);
+    finished_.store(true);
+  }
+
+  int64_t id() const {
+    return event_.id;
+  }
+
+  // 在主循环中执行，返回true表示已发送响应
+  bool TrySendResponse(int64_t now_us) {
+    std::lock_guard<std::mutex> lock(responder_.mutex_);
+    if (responder_.error_) {
+      ErrorMetric().Add();
+      SendMcpErrorResult(event_.id, *responder_.error_);
+    } else if (responder_.value_) {
+      SendMcpResult(event_.id, std::move(*responder_.value_));
+    } else if (finished_.load()) {
+      printf("mcp async tool %s returned without response\n", tool_->name.c_str());
+      ErrorMetric().Add();
+      SendMcpErrorResult(event_.id, "Tool returned without response");
+    } else if (deadline_us_ != 0 && now_us >= deadline_us_) {
+      printf("mcp async tool %s timed out\n", tool_->name.c_str());
+      ErrorMetric().Add();
+      SendMcpErrorResult(event_.id, "Tool call timed out");
+    } else {
+      return false;
+    }
+    responder_.closed_ = true;
+    return true;
+  }
+
+ private:
+  std::shared_ptr<McpAsyncTool> tool_;
+  const ai_vox::McpToolCallEvent event_;
+  McpCallResponder responder_;
+  int64_t deadline_us_ = 0;
+  std::atomic<bool> finished_{false};
+};
+
+namespace {
+
+QueueHandle_t g_call_queue = nullptr;
+// 只在主循环中访问
+std::list<std::shared_ptr<McpAsyncCall>> g_pending_calls;
+
+void WorkerTask(void*) {
+  while (true) {
+    std::shared_ptr<McpAsyncCall>* call = nullptr;
+    if (xQueueReceive(g_call_queue, &call, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+    (*call)->Run();
+    delete call;
+  }
+}
+
+}  // namespace
+
+void McpCallResponder::Respond(Value value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!closed_ && !value_ && !error_) {
+    value_ = std::move(value);
+  }
+}
+
+void McpCallResponder::Error(std::string message) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!closed_ && !value_ && !error_) {
+    error_ = std::move(message);
+  }
+}
+
+std::function<void(const ai_vox::McpToolCallEvent&)> MakeMcpAsyncHandler(const std::string& name,
+                                                                        McpAsyncHandler handler,
+                                                                        uint32_t timeout_ms,
+                                                                        uint32_t max_in_flight) {
+  auto tool = std::make_shared<McpAsyncTool>();
+  tool->name = name;
+  tool->handler = std::move(handler);
+  tool->timeout_ms = timeout_ms;
+  tool->max_in_flight = max_in_flight > 0 ? max_in_flight : 1;
+
+  return [tool](const ai_vox::McpToolCallEvent& event) {
+    if (g_call_queue == nullptr) {
+      SendMcpErrorResult(event.id, "Async workers not started");
+      return;
+    }
+
+    if (tool->in_flight.fetch_add(1) >= tool->max_in_flight) {
+      tool->in_flight.fetch_sub(1);
+      printf("mcp async tool %s busy\n", tool->name.c_str());
+      ErrorMetric().Add();
+      SendMcpErrorResult(event.id, "Tool is busy, please retry later");
+      return;
+    }
+
+    auto call = std::make_shared<McpAsyncCall>(tool, event);
+    auto item = new std::shared_ptr<McpAsyncCall>(call);
+    if (xQueueSend(g_call_queue, &item, 0) != pdTRUE) {
+      delete item;
+      tool->in_flight.fetch_sub(1);
+      ErrorMetric().Add();
+      SendMcpErrorResult(event.id, "Tool is busy, please retry later");
+      return;
+    }
+    TraceMcpCallDeferred(event.id);
+    DeferMcpResult(event.id);
+    g_pending_calls.push_back(std::move(call));
+  };
+}
+
+void StartMcpAsyncWorkers() {
+  if (g_call_queue != nullptr) {
+    return;
+  }
+
+  g_call_queue = xQueueCreate(kMaxQueuedCalls, sizeof(std::shared_ptr<McpAsyncCall>*));
+  if (g_call_queue == nullptr) {
+    printf("Failed to create mcp async queue\n");
+    abort();
+  }
+
+  for (uint32_t i = 0; i < kWorkerCount; i++) {
+    TaskHandle_t task = nullptr;
+    if (xTaskCreatePinnedToCore(WorkerTask, "mcp_async", kWorkerStackSize, nullptr, kWorkerPriority, &task, kWorkerCore) != pdPASS) {
+      printf("Failed to create mcp async worker\n");
+      abort();
+    }
+    RegisterMetricTask("mcp_async_" + std::to_string(i), task);
+  }
+}
+
+void ProcessMcpAsyncCalls() {
+  if (g_pending_calls.empty()) {
+    return;
+  }
+
+  const auto now_us = esp_timer_get_time();
+  for (auto it = g_pending_calls.begin(); it != g_pending_calls.end();) {
+    if ((*it)->TrySendResponse(now_us)) {
+      TraceMcpCallEnd((*it)->id());
+      it = g_pending_calls.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#ifndef _MCP_ASYNC_H_
+#define _MCP_ASYNC_H_
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <variant>
+
+namespace ai_vox {
+struct McpToolCallEvent;
+}
+
+/**
+ * @brief 异步 MCP 调用的应答器
+ *
+ * 异步处理器在工作任务中通过它返回结果，实际的 SendMcpCallResponse/SendMcpCallError
+ * 由主循环发出。只有第一次应答生效，超时后的应答会被忽略。
+ */
+class McpCallResponder {
+ public:
+  using Value = std::variant<bool, int64_t, std::string>;
+
+  /**
+   * @brief 返回调用结果，支持 bool、整数和字符串
+   */
+  void Respond(Value value);
+
+  /**
+   * @brief 返回错误信息
+   */
+  void Error(std::string message);
+
+ private:
+  friend class McpAsyncCall;
+
+  std::mutex mutex_;
+  bool closed_ = false;
+  std::optional<Value> value_;
+  std::optional<std::string> error_;
+};
+
+using McpAsyncHandler = std::function<void(const ai_vox::McpToolCallEvent&, McpCallResponder&)>;
+
+/**
+ * @brief 将异步处理器包装为普通的 MCP 处理器
+ *
+ * 返回的处理器在主循环中被调用时，只把调用放入工作任务队列后立即返回。
+ *
+ * @param timeout_ms 超时时间(毫秒)，超时后自动返回错误，0表示不限时
+ * @param max_in_flight 该工具同时执行的最大调用数，超出时立即返回错误
+ */
+std::function<void(const ai_vox::McpToolCallEvent&)> MakeMcpAsyncHandler(const std::string& name,
+                                                                        McpAsyncHandler handler,
+                                                                        uint32_t timeout_ms,
+                                                                        uint32_t max_in_flight);
+
+/**
+ * @brief 启动异步 MCP 调用的工作任务，固定在主循环之外的另一个核心上运行
+ */
+void StartMcpAsyncWorkers();
+
+/**
+ * @brief 在主循环中发送已完成或已超时的异步调用的响应
+ */
+void ProcessMcpAsyncCalls();
+
+#endif
@@ -0,0 +1,539 @@
+#include "mcp_batch.h"
+
+#include <esp_timer.h>
+
+#include <cinttypes>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ai_vox_engine.h"
+#include "json_writer.h"
+#include "latency_trace.h"
+#include "metrics.h"
+
+namespace {
+
+constexpr char kBatchToolName[] = "self.batch";
+constexpr size_t kMaxBatchCalls = 8;
+// 大于异步工具常用的超时时间，只用于兜底没有返回结果的工具
+constexpr int64_t kBatchTimeoutUs = 30 * 1000 * 1000;
+
+Metric& ErrorMetric() {
+  static auto& s_errors = GetMetric("mcp.errors");
+  return s_errors;
+}
+
+// ==================== 参数解析 ====================
+
+// 只解析 self.batch 的 calls 参数：对象数组，参数值只支持字符串、整数、布尔值和 null
+class BatchParser {
+ public:
+  explicit BatchParser(std::string_view text) : text_(text) {
+  }
+
+  bool ParseCalls(std::vector<ai_vox::McpToolCallEvent>& calls) {
+    if (!Consume('[')) {
+      return Fail("expected an array");
+    }
+    if (Consume(']')) {
+      return Fail("empty batch");
+    }
+    while (true) {
+      if (calls.size() == kMaxBatchCalls) {
+        return Fail("too many calls");
+      }
+      if (!ParseCall(calls.emplace_back())) {
+        return false;
+      }
+      if (Consume(']')) {
+        break;
+      }
+      if (!Consume(',')) {
+        return Fail("expected ',' or ']'");
+      }
+    }
+    SkipSpace();
+    return pos_ == text_.size() || Fail("unexpected trailing characters");
+  }
+
+  const char* error() const {
+    return error_;
+  }
+
+ private:
+  bool ParseCall(ai_vox::McpToolCallEvent& call) {
+    if (!Consume('{')) {
+      return Fail("expected an object");
+    }
+    bool has_name = false;
+    if (!Consume('}')) {
+      while (true) {
+        std::string key;
+        if (!ParseString(key) || !Expect(':')) {
+          return false;
+        }
+        if (key == "name") {
+          if (!ParseString(call.name)) {
+            return false;
+          }
+          has_name = true;
+        } else if (key == "arguments") {
+          if (!ParseArguments(call)) {
+            return false;
+          }
+        } else {
+          return Fail("unknown key in call");
+        }
+        if (Consume('}')) {
+          break;
+        }
+        if (!Expect(',')) {
+          return false;
+        }
+      }
+    }
+    return has_name || Fail("missing name");
+  }
+
+  bool ParseArguments(ai_vox::McpToolCallEvent& call) {
+    if (!Consume('{')) {
+      return Fail("arguments must be an object");
+    }
+    if (Consume('}')) {
+      return true;
+    }
+    while (true) {
+      std::string key;
+      if (!ParseString(key) || !Expect(':') || !ParseArgument(key, call)) {
+        return false;
+      }
+      if (Consume('}')) {
+        return true;
+      }
+      if (!Expect(',')) {
+        return false;
+      }
+    }
+  }
+
+  bool ParseArgument(const std::string& key, ai_vox::McpToolCallEvent& call) {
+    SkipSpace();
+    if (pos_ == text_.size()) {
+      return Fail("unexpected end");
+    }
+    const char c = text_[pos_];
+    if (c == '"') {
+      std::string value;
+      if (!ParseString(value)) {
+        return false;
+      }
+      call.params.insert_or_assign(key, std::move(value));
+    } else if (ConsumeLiteral("true")) {
+      call.params.insert_or_assign(key, true);
+    } else if (ConsumeLiteral("false")) {
+      call.params.insert_or_assign(key, false);
+    } else if (ConsumeLiteral("null")) {
+      // null 视为未提供该参数
+    } else if (c == '-' || (c >= '0' && c <= '9')) {
+      int64_t value = 0;
+      if (!ParseInteger(value)) {
+        return false;
+      }
+      call.params.insert_or_assign(key, value);
+    } else {
+      return Fail("unsupported argument value");
+    }
+    return true;
+  }
+
+  bool ParseInteger(int64_t& value) {
+    const bool negative = text_[pos_] == '-';
+    if (negative) {
+      pos_++;
+    }
+    uint64_t magnitude = 0;
+    const size_t start = pos_;
+    for (; pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9'; pos_++) {
+      const uint64_t digit = text_[pos_] - '0';
+      if (magnitude > (UINT64_MAX - digit) / 10) {
+        return Fail("integer out of range");
+      }
+      magnitude = magnitude * 10 + digit;
+    }
+    if (pos_ == start) {
+      return Fail("invalid number");
+    }
+    if (pos_ < text_.size() && (text_[pos_] == '.' || text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      return Fail("only integer numbers are supported");
+    }
+    const uint64_t limit = negative ? static_cast<uint64_t>(INT64_MAX) + 1 : INT64_MAX;
+    if (magnitude > limit) {
+      return Fail("integer out of range");
+    }
+    value = negative ? static_cast<int64_t>(0 - magnitude) : static_cast<int64_t>(magnitude);
+    return true;
+  }
+
+  bool ParseString(std::string& out) {
+    if (!Consume('"')) {
+      return Fail("expected a string");
+    }
+    out.clear();
+    while (pos_ < text_.size()) {
+      const char c = text_[pos_++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return Fail("control character in string");
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ == text_.size()) {
+        break;
+      }
+      const char escaped = text_[pos_++];
+      switch (escaped) {
+        case '"':
+        case '\\':
+        case '/':
+          out += escaped;
+          break;
+        case 'b':
+          out += '\b';
+          break;
+        case 'f':
+          out += '\f';
+          break;
+        case 'n':
+          out += '\n';
+          break;
+        case 'r':
+          out += '\r';
+          break;
+        case 't':
+          out += '\t';
+          break;
+        case 'u':
+          if (!ParseUnicodeEscape(out)) {
+            return false;
+          }
+          break;
+        default:
+          return Fail("invalid escape in string");
+      }
+    }
+    return Fail("unterminated string");
+  }
+
+  // 解析 \uXXXX(含代理对)并以UTF-8写入，调用时已读过 "\u"
+  bool ParseUnicodeEscape(std::string& out) {
+    uint32_t code = 0;
+    if (!ParseHex4(code)) {
+      return false;
+    }
+    if (code >= 0xD800 && code <= 0xDBFF) {
+      uint32_t low = 0;
+      if (!ConsumeLiteral("\\u") || !ParseHex4(low) || low < 0xDC00 || low > 0xDFFF) {
+        return Fail("invalid surrogate pair");
+      }
+      code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+    } else if (code >= 0xDC00 && code <= 0xDFFF) {
+      return Fail("invalid surrogate pair");
+    }
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return true;
+  }
+
+  bool ParseHex4(uint32_t& code) {
+    if (text_.size() - pos_ < 4) {
+      return Fail("invalid unicode escape");
+    }
+    for (int i = 0; i < 4; i++) {
+      const char c = text_[pos_++];
+      code <<= 4;
+      if (c >= '0' && c <= '9') {
+        code |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        code |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        code |= c - 'A' + 10;
+      } else {
+        return Fail("invalid unicode escape");
+      }
+    }
+    return true;
+  }
+
+  void SkipSpace() {
+    while (pos_ < text_.size() &&
+           (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n' || text_[pos_] == '\r')) {
+      pos_++;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipSpace();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      pos_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool Expect(char c) {
+    if (Consume(c)) {
+      return true;
+    }
+    return Fail(c == ':' ? "expected ':'" : "expected ','");
+  }
+
+  bool ConsumeLiteral(std::string_view literal) {
+    if (text_.substr(pos_, literal.size()) == literal) {
+      pos_ += literal.size();
+      return true;
+    }
+    return false;
+  }
+
+  bool Fail(const char* error) {
+    if (error_ == nullptr) {
+      error_ = error;
+    }
+    return false;
+  }
+
+  const std::string_view text_;
+  size_t pos_ = 0;
+  const char* error_ = nullptr;
+};
+
+// ==================== 批量调用状态 ====================
+
+struct BatchItem {
+  std::string name;
+  bool ok = false;
+  // value 为字符串时是否为已编码的 JSON
+  bool raw_json = false;
+  // 成功时为结果，失败时为错误信息
+  McpResult value;
+  // 处理器返回后才会给出结果
+  bool deferred = false;
+};
+
+struct Batch {
+  int64_t id = 0;
+  int64_t deadline_us = 0;
+  std::vector<BatchItem> items;
+  size_t pending = 0;
+};
+
+std::mutex g_mutex;
+std::list<Batch> g_batches;
+// 未完成的子调用 id -> (所属批量调用, 序号)
+std::unordered_map<int64_t, std::pair<Batch*, size_t>> g_sub_calls;
+int64_t g_next_sub_call_id = -1;
+
+// 引擎下发的调用 id 都不是负数
+bool IsSubCall(int64_t id) {
+  return id < 0;
+}
+
+// 子调用已分发、处理器已返回，但既没有给出结果也没有声明稍后返回
+bool IsAbandonedSubCall(int64_t id) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  const auto it = g_sub_calls.find(id);
+  if (it == g_sub_calls.end()) {
+    return false;
+  }
+  const auto [batch, index] = it->second;
+  return !batch->items[index].deferred;
+}
+
+void SendBatchResult(const Batch& batch) {
+  // 字符串最坏情况下每个字节转义为 \u00XX
+  size_t capacity = 32;
+  for (const auto& item : batch.items) {
+    const auto value = std::get_if<std::string>(&item.value);
+    capacity += item.name.size() * 6 + (value != nullptr ? value->size() * 6 : 24) + 48;
+  }
+  std::vector<char> buffer(capacity);
+  JsonWriter writer(buffer.data(), buffer.size());
+
+  writer.BeginObject();
+  writer.Key("results").BeginArray();
+  for (const auto& item : batch.items) {
+    writer.BeginObject();
+    writer.Field("name", item.name);
+    writer.Field("ok", item.ok);
+    writer.Key(item.ok ? "result" : "error");
+    if (item.raw_json) {
+      writer.Raw(std::get<std::string>(item.value));
+    } else {
+      std::visit([&writer](const auto& value) { writer.Value(value); }, item.value);
+    }
+    writer.EndObject();
+  }
+  writer.EndArray();
+  writer.EndObject();
+
+  // 子调用的结果都在主循环中返回(异步工具的结果由 ProcessMcpAsyncCalls() 发送)，这里可以结束追踪区间
+  TraceMcpCallEnd(batch.id);
+  auto& engine = ai_vox::Engine::GetInstance();
+  if (!writer.ok()) {
+    printf("mcp batch result overflow, %zu bytes written\n", writer.size());
+    ErrorMetric().Add();
+    engine.SendMcpCallError(batch.id, "Batch result too large");
+    return;
+  }
+  engine.SendMcpCallResponse(batch.id, writer.c_str());
+}
+
+void CompleteSubCall(int64_t id, bool ok, bool raw_json, McpResult value) {
+  std::unique_lock<std::mutex> lock(g_mutex);
+  const auto it = g_sub_calls.find(id);
+  if (it == g_sub_calls.end()) {
+    // 超时后才返回的结果，批量调用已经发送过
+    return;
+  }
+  const auto [batch, index] = it->second;
+  g_sub_calls.erase(it);
+
+  auto& item = batch->items[index];
+  item.ok = ok;
+  item.raw_json = raw_json;
+  item.value = std::move(value);
+  if (--batch->pending > 0) {
+    return;
+  }
+
+  // 全部子调用完成，移出列表后在锁外发送
+  std::list<Batch> done;
+  for (auto batch_it = g_batches.begin(); batch_it != g_batches.end(); ++batch_it) {
+    if (&*batch_it == batch) {
+      done.splice(done.begin(), g_batches, batch_it);
+      break;
+    }
+  }
+  lock.unlock();
+  SendBatchResult(done.front());
+}
+
+}  // namespace
+
+void SendMcpResult(int64_t id, McpResult value) {
+  if (IsSubCall(id)) {
+    CompleteSubCall(id, true, false, std::move(value));
+    return;
+  }
+  auto& engine = ai_vox::Engine::GetInstance();
+  std::visit([&engine, id](auto& result) { engine.SendMcpCallResponse(id, result); }, value);
+}
+
+void SendMcpJsonResult(int64_t id, const char* json) {
+  if (IsSubCall(id)) {
+    CompleteSubCall(id, true, true, std::string(json));
+    return;
+  }
+  ai_vox::Engine::GetInstance().SendMcpCallResponse(id, json);
+}
+
+void SendMcpErrorResult(int64_t id, const std::string& message) {
+  if (IsSubCall(id)) {
+    CompleteSubCall(id, false, false, message);
+    return;
+  }
+  ai_vox::Engine::GetInstance().SendMcpCallError(id, message);
+}
+
+void DeferMcpResult(int64_t id) {
+  if (!IsSubCall(id)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_mutex);
+  const auto it = g_sub_calls.find(id);
+  if (it != g_sub_calls.end()) {
+    const auto [batch, index] = it->second;
+    batch->items[index].deferred = true;
+  }
+}
+
+bool RunMcpBatch(int64_t id, std::string_view calls_json, McpDispatcher dispatch, std::string* error) {
+  std::vector<ai_vox::McpToolCallEvent> calls;
+  BatchParser parser(calls_json);
+  if (!parser.ParseCalls(calls)) {
+    *error = parser.error();
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    auto& batch = g_batches.emplace_back();
+    batch.id = id;
+    batch.deadline_us = esp_timer_get_time() + kBatchTimeoutUs;
+    batch.items.resize(calls.size());
+    batch.pending = calls.size();
+    for (size_t i = 0; i < calls.size(); i++) {
+      calls[i].id = g_next_sub_call_id--;
+      batch.items[i].name = calls[i].name;
+      g_sub_calls.emplace(calls[i].id, std::make_pair(&batch, i));
+    }
+  }
+
+  // 同步工具在这里依次执行完毕，异步工具进入工作任务队列后并行执行；
+  // 最后一个子调用完成时发送汇总结果，可能就在这个循环中
+  for (const auto& call : calls) {
+    if (call.name == kBatchToolName) {
+      SendMcpErrorResult(call.id, "Nested self.batch is not allowed");
+    } else if (!dispatch(call)) {
+      SendMcpErrorResult(call.id, "Unknown tool");
+    } else if (IsAbandonedSubCall(call.id)) {
+      // 多半是直接调用 Engine 返回结果的工具，结果已经发给了引擎，无法汇总
+      printf("mcp batch: %s returned without SendMcpResult\n", call.name.c_str());
+      ErrorMetric().Add();
+      SendMcpErrorResult(call.id, "Tool does not support self.batch");
+    }
+  }
+  return true;
+}
+
+void ProcessMcpBatches() {
+  std::vector<int64_t> expired;
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_batches.empty()) {
+      return;
+    }
+    const auto now_us = esp_timer_get_time();
+    for (const auto& [sub_call_id, owner] : g_sub_calls) {
+      if (now_us >= owner.first->deadline_us) {
+        expired.push_back(sub_call_id);
+      }
+    }
+  }
+  for (const auto sub_call_id : expired) {
+    printf("mcp batch sub call %" PRId64 " timed out\n", sub_call_id);
+    ErrorMetric().Add();
+    SendMcpErrorResult(sub_call_id, "Tool call timed out");
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#ifndef _MCP_BATCH_H_
+#define _MCP_BATCH_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <variant>
+
+namespace ai_vox {
+struct McpToolCallEvent;
+}
+
+/**
+ * @file mcp_batch.h
+ * @brief 批量 MCP 调用(self.batch)与调用结果的统一发送
+ *
+ * self.batch 在一次调用中执行多个工具，把各工具的结果汇总成一个响应，减少与云端的往返次数。
+ * 子调用使用负数的内部 id，通过同一张分发表执行；同步工具在主循环中依次执行，
+ * 异步工具(RegisterUserMcpAsyncHandler)在工作任务中并行执行，全部完成后发送汇总结果。
+ *
+ * 因此工具必须通过下面的 SendMcp*Result 函数返回结果(而不是直接调用 Engine)：
+ * 属于批量调用的结果被汇总，其余结果直接发送给引擎。
+ * 同步工具返回时仍未给出结果、也没有调用 DeferMcpResult() 的子调用立即记为错误，
+ * 直接调用 Engine 的旧式工具因此不会让整个批量调用等到超时。
+ */
+
+using McpResult = std::variant<bool, int64_t, std::string>;
+
+/**
+ * @brief 返回调用结果
+ */
+void SendMcpResult(int64_t id, McpResult value);
+
+/**
+ * @brief 返回已编码的 JSON 作为调用结果，批量调用中作为 JSON 值嵌入汇总结果
+ */
+void SendMcpJsonResult(int64_t id, const char* json);
+
+/**
+ * @brief 返回错误信息
+ */
+void SendMcpErrorResult(int64_t id, const std::string& message);
+
+/**
+ * @brief 声明该调用的结果将在处理器返回之后(由其它任务或之后的主循环迭代)通过 SendMcp*Result 返回
+ */
+void DeferMcpResult(int64_t id);
+
+/**
+ * @brief 分发一个 MCP 调用，返回false表示没有该名称的工具
+ */
+using McpDispatcher = bool (*)(const ai_vox::McpToolCallEvent& event);
+
+/**
+ * @brief 解析并执行一次批量调用，在主循环中调用
+ *
+ * @param calls JSON 数组，形如 [{"name":"self.led.set","arguments":{"state":true}}, ...]
+ * @param error 参数无效时写入错误原因并返回false，此时调用者负责发送错误
+ */
+bool RunMcpBatch(int64_t id, std::string_view calls, McpDispatcher dispatch, std::string* error);
+
+/**
+ * @brief 为超时仍未完成的子调用返回错误，在主循环中周期调用
+ */
+void ProcessMcpBatches();
+
+#endif
@@ -0,0 +1,10 @@
+#include "mcp_tool.h"
+
+#include "mcp_batch.h"
+#include "metrics.h"
+
+void SendMcpArgumentError(int64_t id, const char* reason, const char* name) {
+  static auto& s_errors = GetMetric("mcp.errors");
+  s_errors.Add();
+  SendMcpErrorResult(id, std::string(reason) + ": " + name);
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#ifndef _MCP_TOOL_H_
+#define _MCP_TOOL_H_
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "ai_vox_engine.h"
+
+/**
+ * @file mcp_tool.h
+ * @brief 编译期类型化的 MCP 工具描述
+ *
+ * 工具的名称、描述和参数只声明一次，参数绑定到一个参数结构体的成员上。
+ * 由同一个描述同时生成 AddMcpTool 所需的参数 schema 和调用处理函数：处理函数收到的是
+ * 已经填好的参数结构体，缺少参数、超出范围时自动返回错误，不会调用用户处理函数。
+ * 工具名称和参数名称在编译期检查，分发时直接调用函数指针，没有 std::function 的间接调用。
+ *
+ * 示例：
+ * @code
+ * struct SetPinArgs {
+ *   int64_t pin = 0;
+ *   bool level = false;
+ * };
+ *
+ * void HandleSetPin(const ai_vox::McpToolCallEvent& event, const SetPinArgs& args) {
+ *   digitalWrite(args.pin, args.level ? HIGH : LOW);
+ *   SendMcpResult(event.id, true);
+ * }
+ *
+ * constexpr auto kSetPinTool = MakeMcpTool<SetPinArgs>("user.gpio.set_pin", "Set the level of a GPIO pin.",
+ *                                                      McpInt("pin", &SetPinArgs::pin, 0, 48),
+ *                                                      McpBool("level", &SetPinArgs::level));
+ *
+ * RegisterUserMcpTool(McpToolEntryOf<kSetPinTool, HandleSetPin>());
+ * @endcode
+ */
+
+/**
+ * @brief 没有参数的工具使用的参数结构体
+ */
+struct McpNoArgs {};
+
+/**
+ * @brief 参数成员声明为 std::optional 时参数是可选的，调用时未提供则保持为空
+ */
+template <typename Member, typename Value>
+constexpr bool kIsMcpParamMember = std::is_same_v<Member, Value> || std::is_same_v<Member, std::optional<Value>>;
+
+template <typename Args, typename Member>
+struct McpBoolParam {
+  const char* name;
+  Member Args::*member;
+  std::optional<bool> default_value;
+};
+
+template <typename Args, typename Member>
+struct McpIntParam {
+  const char* name;
+  Member Args::*member;
+  int64_t min;
+  int64_t max;
+  std::optional<int64_t> default_value;
+};
+
+template <typename Args, typename Member>
+struct McpStringParam {
+  const char* name;
+  Member Args::*member;
+  const char* default_value;  // nullptr 表示没有默认值
+};
+
+template <typename Args, typename Member>
+constexpr McpBoolParam<Args, Member> McpBool(const char* name,
+                                             Member Args::*member,
+                                             std::optional<bool> default_value = std::nullopt) {
+  static_assert(kIsMcpParamMember<Member, bool>, "bool parameter must bind to a bool or std::optional<bool> member");
+  return {name, member, default_value};
+}
+
+template <typename Args, typename Member>
+constexpr McpIntParam<Args, Member> McpInt(const char* name,
+                                           Member Args::*member,
+                                           int64_t min,
+                                           int64_t max,
+                                           std::optional<int64_t> default_value = std::nullopt) {
+  static_assert(kIsMcpParamMember<Member, int64_t>,
+                "int parameter must bind to an int64_t or std::optional<int64_t> member");
+  return {name, member, min, max, default_value};
+}
+
+template <typename Args, typename Member>
+constexpr McpStringParam<Args, Member> McpString(const char* name,
+                                                 Member Args::*member,
+                                                 const char* default_value = nullptr) {
+  static_assert(kIsMcpParamMember<Member, std::string>,
+                "string parameter must bind to a std::string or std::optional<std::string> member");
+  return {name, member, default_value};
+}
+
+template <typename Args, typename... Params>
+struct McpToolDef {
+  using ArgsType = Args;
+
+  const char* name;
+  const char* description;
+  std::tuple<Params...> params;
+};
+
+template <typename Args = McpNoArgs, typename... Params>
+constexpr McpToolDef<Args, Params...> MakeMcpTool(const char* name, const char* description, Params... params) {
+  return {name, description, std::tuple<Params...>(params...)};
+}
+
+/**
+ * @brief 分发表中的一项：声明函数在 InitMcpTools() 中调用，调用函数在收到同名调用时执行
+ */
+struct McpToolEntry {
+  const char* name;
+  void (*declare)(ai_vox::Engine& engine);
+  void (*invoke)(const ai_vox::McpToolCallEvent& event);
+};
+
+/**
+ * @brief 发送参数错误并计入 mcp.errors，message 形如 "<reason>: <name>"
+ */
+void SendMcpArgumentError(int64_t id, const char* reason, const char* name);
+
+namespace mcp_tool_internal {
+
+constexpr bool StringEquals(const char* a, const char* b) {
+  while (*a != '\0' && *a == *b) {
+    ++a;
+    ++b;
+  }
+  return *a == *b;
+}
+
+// 工具名称只允许字母、数字以及 '_'、'.'、'-'
+constexpr bool IsValidName(const char* name) {
+  if (name == nullptr || *name == '\0') {
+    return false;
+  }
+  for (; *name != '\0'; ++name) {
+    const char c = *name;
+    const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' ||
+                       c == '.' || c == '-';
+    if (!valid) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename Param>
+constexpr bool IsValidRange(const Param&) {
+  return true;
+}
+
+template <typename Args, typename Member>
+constexpr bool IsValidRange(const McpIntParam<Args, Member>& param) {
+  return param.min <= param.max &&
+         (!param.default_value || (*param.default_value >= param.min && *param.default_value <= param.max));
+}
+
+template <typename Tuple, size_t... I>
+constexpr bool HasValidParams(const Tuple& params, std::index_sequence<I...>) {
+  const char* names[] = {std::get<I>(params).name..., nullptr};
+  for (size_t i = 0; i < sizeof...(I); ++i) {
+    if (!IsValidName(names[i])) {
+      return false;
+    }
+    for (size_t j = i + 1; j < sizeof...(I); ++j) {
+      if (StringEquals(names[i], names[j])) {
+        return false;
+      }
+    }
+  }
+  return (IsValidRange(std::get<I>(params)) && ...);
+}
+
+template <typename Args, typename Member>
+ai_vox::ParamSchemaVariant Schema(const McpBoolParam<Args, Member>& param) {
+  return ai_vox::ParamSchema<bool>{
+      .default_value = param.default_value,
+  };
+}
+
+template <typename Args, typename Member>
+ai_vox::ParamSchemaVariant Schema(const McpIntParam<Args, Member>& param) {
+  return ai_vox::ParamSchema<int64_t>{
+      .default_value = param.default_value,
+      .min = param.min,
+      .max = param.max,
+  };
+}
+
+template <typename Args, typename Member>
+ai_vox::ParamSchemaVariant Schema(const McpStringParam<Args, Member>& param) {
+  return ai_vox::ParamSchema<std::string>{
+      .default_value = param.default_value != nullptr ? std::optional<std::string>(param.default_value) : std::nullopt,
+  };
+}
+
+template <typename Member>
+constexpr bool kIsOptional = false;
+
+template <typename Value>
+constexpr bool kIsOptional<std::optional<Value>> = true;
+
+// 将调用中的参数值(或默认值)写入参数结构体，参数缺失且不可省略时发送错误并返回false
+template <typename Value, typename Args, typename Member>
+bool Read(int64_t id,
+          const char* name,
+          const Value* value_ptr,
+          const std::optional<Value>& default_value,
+          Member Args::*member,
+          Args& args) {
+  if (value_ptr != nullptr) {
+    args.*member = *value_ptr;
+  } else if (default_value) {
+    args.*member = *default_value;
+  } else if constexpr (!kIsOptional<Member>) {
+    SendMcpArgumentError(id, "Missing valid argument", name);
+    return false;
+  }
+  return true;
+}
+
+template <typename Args, typename Member>
+bool ReadParam(const ai_vox::McpToolCallEvent& event, const McpBoolParam<Args, Member>& param, Args& args) {
+  return Read(event.id, param.name, event.param<bool>(param.name), param.default_value, param.member, args);
+}
+
+template <typename Args, typename Member>
+bool ReadParam(const ai_vox::McpToolCallEvent& event, const McpIntParam<Args, Member>& param, Args& args) {
+  const auto value_ptr = event.param<int64_t>(param.name);
+  // schema 中的范围只是提示，AI 仍可能传入超出范围的值
+  if (value_ptr != nullptr && (*value_ptr < param.min || *value_ptr > param.max)) {
+    SendMcpArgumentError(event.id, "Argument out of range", param.name);
+    return false;
+  }
+  return Read(event.id, param.name, value_ptr, param.default_value, param.member, args);
+}
+
+template <typename Args, typename Member>
+bool ReadParam(const ai_vox::McpToolCallEvent& event, const McpStringParam<Args, Member>& param, Args& args) {
+  const auto default_value =
+      param.default_value != nullptr ? std::optional<std::string>(param.default_value) : std::nullopt;
+  return Read(event.id, param.name, event.param<std::string>(param.name), default_value, param.member, args);
+}
+
+template <const auto& kTool>
+void Declare(ai_vox::Engine& engine) {
+  std::map<std::string, ai_vox::ParamSchemaVariant> schema;
+  std::apply([&schema](const auto&... params) { (schema.emplace(params.name, Schema(params)), ...); }, kTool.params);
+  engine.AddMcpTool(kTool.name, kTool.description, std::move(schema));
+}
+
+template <const auto& kTool, auto kHandler>
+void Invoke(const ai_vox::McpToolCallEvent& event) {
+  typename std::remove_reference_t<decltype(kTool)>::ArgsType args{};
+  // 按声明顺序读取，遇到第一个无效参数即停止
+  const bool valid = std::apply([&](const auto&... params) { return (ReadParam(event, params, args) && ...); },
+                                kTool.params);
+  if (valid) {
+    kHandler(event, args);
+  }
+}
+
+}  // namespace mcp_tool_internal
+
+/**
+ * @brief 由工具描述和处理函数生成分发表项，名称和参数在编译期检查
+ *
+ * @tparam kTool 由 MakeMcpTool 创建的 constexpr 工具描述
+ * @tparam kHandler 处理函数，签名为 void(const ai_vox::McpToolCallEvent&, const Args&)
+ */
+template <const auto& kTool, auto kHandler>
+constexpr McpToolEntry McpToolEntryOf() {
+  using Args = typename std::remove_reference_t<decltype(kTool)>::ArgsType;
+  static_assert(mcp_tool_internal::IsValidName(kTool.name),
+                "MCP tool name must be non-empty and contain only letters, digits, '_', '.' or '-'");
+  static_assert(mcp_tool_internal::HasValidParams(
+                    kTool.params,
+                    std::make_index_sequence<std::tuple_size_v<std::remove_cv_t<decltype(kTool.params)>>>()),
+                "MCP parameter names must be valid and unique, int ranges must contain their default values");
+  static_assert(std::is_invocable_v<decltype(kHandler), const ai_vox::McpToolCallEvent&, const Args&>,
+                "handler must be callable as handler(const ai_vox::McpToolCallEvent&, const Args&)");
+  return {kTool.name, &mcp_tool_internal::Declare<kTool>, &mcp_tool_internal::Invoke<kTool, kHandler>};
+}
+
+#endif
@@ -0,0 +1,108 @@
+#include "metrics.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <list>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace {
+
+struct NamedMetric {
+  explicit NamedMetric(std::string metric_name) : name(std::move(metric_name)) {
+  }
+
+  std::string name;
+  Metric metric;
+};
+
+struct NamedGauge {
+  std::string name;
+  std::function<uint32_t()> read;
+};
+
+struct NamedTask {
+  std::string name;
+  TaskHandle_t task;
+};
+
+std::mutex g_mutex;
+// std::list 保证已返回的 Metric 引用不会因插入而失效
+std::list<NamedMetric> g_metrics;
+std::vector<NamedGauge> g_gauges;
+std::vector<NamedTask> g_tasks;
+
+void WriteHeapInfo(JsonWriter& writer, const char* name, uint32_t caps) {
+  if (heap_caps_get_total_size(caps) == 0) {
+    return;
+  }
+  writer.Key(name).BeginObject();
+  writer.Field("total", heap_caps_get_total_size(caps));
+  writer.Field("free", heap_caps_get_free_size(caps));
+  writer.Field("min_free", heap_caps_get_minimum_free_size(caps));
+  // 最大空闲块远小于空闲总量时说明碎片严重
+  writer.Field("largest_free_block", heap_caps_get_largest_free_block(caps));
+  writer.EndObject();
+}
+
+}  // namespace
+
+Metric& GetMetric(const std::string& name) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  auto it = std::find_if(g_metrics.begin(), g_metrics.end(), [&](const NamedMetric& metric) { return metric.name == name; });
+  if (it != g_metrics.end()) {
+    return it->metric;
+  }
+  return g_metrics.emplace_back(name).metric;
+}
+
+void RegisterMetricGauge(const std::string& name, std::function<uint32_t()> read) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_gauges.push_back({name, std::move(read)});
+}
+
+void RegisterMetricTask(const std::string& name, TaskHandle_t task) {
+  if (task == nullptr) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_tasks.push_back({name, task});
+}
+
+void UnregisterMetricTask(TaskHandle_t task) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  g_tasks.erase(std::remove_if(g_tasks.begin(), g_tasks.end(), [task](const NamedTask& named_task) { return named_task.task == task; }),
+                g_tasks.end());
+}
+
+void WriteMetricsJson(JsonWriter& writer) {
+  writer.BeginObject();
+  writer.Field("uptime_ms", static_cast<uint64_t>(esp_timer_get_time() / 1000));
+
+  writer.Key("heap").BeginObject();
+  WriteHeapInfo(writer, "internal", MALLOC_CAP_INTERNAL);
+  WriteHeapInfo(writer, "spiram", MALLOC_CAP_SPIRAM);
+  writer.EndObject();
+
+  std::lock_guard<std::mutex> lock(g_mutex);
+
+  // 任务栈历史最小剩余空间(字节)，接近0时有栈溢出风险
+  writer.Key("stack_high_water_mark").BeginObject();
+  for (const auto& task : g_tasks) {
+    writer.Field(task.name, uxTaskGetStackHighWaterMark(task.task));
+  }
+  writer.EndObject();
+
+  writer.Key("metrics").BeginObject();
+  for (const auto& metric : g_metrics) {
+    writer.Field(metric.name, metric.metric.value());
+  }
+  for (const auto& gauge : g_gauges) {
+    writer.Field(gauge.name, gauge.read());
+  }
+  writer.EndObject();
+  writer.EndObject();
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef _METRICS_H_
+#define _METRICS_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "json_writer.h"
+
+/**
+ * @file metrics.h
+ * @brief 运行时指标注册表
+ *
+ * 各模块按名称注册计数器、采样函数和任务，WriteMetricsJson() 在查询时汇总为JSON，
+ * 同时附带堆内存使用情况(含最大空闲块)和各任务栈的历史最小剩余空间。
+ * 指标名称建议使用 "模块.指标" 形式，如 "main_loop.iterations"。
+ */
+
+/**
+ * @brief 一个32位指标值，可在任意任务中无锁更新
+ */
+class Metric {
+ public:
+  void Add(uint32_t delta = 1) {
+    value_.fetch_add(delta, std::memory_order_relaxed);
+  }
+
+  void Set(uint32_t value) {
+    value_.store(value, std::memory_order_relaxed);
+  }
+
+  // 只在新值更大时更新，用于记录最大值
+  void UpdateMax(uint32_t value) {
+    uint32_t current = value_.load(std::memory_order_relaxed);
+    while (value > current && !value_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+  }
+
+  uint32_t value() const {
+    return value_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<uint32_t> value_{0};
+};
+
+/**
+ * @brief 获取指定名称的指标，不存在时创建
+ *
+ * 返回的引用在程序运行期间一直有效，热路径上应缓存该引用，例如：
+ * @code
+ * static auto& s_errors = GetMetric("mcp.errors");
+ * s_errors.Add();
+ * @endcode
+ */
+Metric& GetMetric(const std::string& name);
+
+/**
+ * @brief 注册一个在查询时才读取的指标
+ */
+void RegisterMetricGauge(const std::string& name, std::function<uint32_t()> read);
+
+/**
+ * @brief 注册需要报告栈剩余空间的任务
+ */
+void RegisterMetricTask(const std::string& name, TaskHandle_t task);
+
+/**
+ * @brief 注销任务，删除任务前必须调用
+ */
+void UnregisterMetricTask(TaskHandle_t task);
+
+/**
+ * @brief 以JSON格式写入全部指标
+ */
+void WriteMetricsJson(JsonWriter& writer);
+
+#endif
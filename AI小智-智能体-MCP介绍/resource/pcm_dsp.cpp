@@ -0,0 +1,257 @@
+#include "pcm_dsp.h"
+
+#if defined(__XTENSA__) && __has_include(<sdkconfig.h>)
+#include <sdkconfig.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+// ESP32-S3 的 PIE 向量扩展：8个 int16_t 一组，要求地址按16字节对齐
+#if defined(__XTENSA__) && defined(CONFIG_IDF_TARGET_ESP32S3)
+#define PCM_DSP_HAS_PIE 1
+#else
+#define PCM_DSP_HAS_PIE 0
+#endif
+
+namespace {
+
+constexpr size_t kBlockSamples = 8;
+
+// PcmDspSelfTest() 发现结果不一致时清除，之后只使用标量实现
+std::atomic<bool> g_vector_enabled{true};
+
+#if PCM_DSP_HAS_PIE
+// 向量乘法的结果右移 SAR 位，与标量实现的 >> 15 一致
+void GainBlocksPie(const int16_t* in, int16_t* out, size_t blocks, int32_t gain_q15) {
+  alignas(16) int16_t gains[kBlockSamples];
+  std::fill_n(gains, kBlockSamples, static_cast<int16_t>(gain_q15));
+  asm volatile(
+      "wsr.sar %[shift]\n"
+      "ee.vld.128.ip q1, %[gains], 0\n"
+      "1:\n"
+      "ee.vld.128.ip q0, %[in], 16\n"
+      "ee.vmul.s16 q2, q0, q1\n"
+      "ee.vst.128.ip q2, %[out], 16\n"
+      "addi %[blocks], %[blocks], -1\n"
+      "bnez %[blocks], 1b\n"
+      : [in] "+r"(in), [out] "+r"(out), [blocks] "+r"(blocks)
+      : [gains] "r"(gains), [shift] "r"(15)
+      : "memory");
+}
+
+bool Aligned(const int16_t* p) {
+  return (reinterpret_cast<uintptr_t>(p) & 15) == 0;
+}
+
+// 让 out 对齐到16字节需要先用标量处理的样本数
+size_t AlignHead(const int16_t* out, size_t count) {
+  return std::min(count, ((16 - (reinterpret_cast<uintptr_t>(out) & 15)) & 15) / sizeof(int16_t));
+}
+#endif
+
+}  // namespace
+
+void PcmDownmixStereo(const int16_t* in, size_t frames, int16_t* out) {
+  // 写入位置始终不超过读取位置，可以就地处理
+  for (size_t i = 0; i < frames; i++) {
+    out[i] = static_cast<int16_t>((in[2 * i] + in[2 * i + 1]) >> 1);
+  }
+}
+
+void PcmApplyGainScalar(const int16_t* in, int16_t* out, size_t count, int32_t gain_q15) {
+  if (gain_q15 >= kPcmUnityGain) {
+    if (in != out) {
+      memmove(out, in, count * sizeof(int16_t));
+    }
+    return;
+  }
+  for (size_t i = 0; i < count; i++) {
+    out[i] = static_cast<int16_t>((in[i] * gain_q15) >> 15);
+  }
+}
+
+void PcmApplyGain(const int16_t* in, int16_t* out, size_t count, int32_t gain_q15) {
+#if PCM_DSP_HAS_PIE
+  const size_t head = AlignHead(out, count);
+  if (gain_q15 < kPcmUnityGain && count - head >= kBlockSamples && Aligned(in + head) &&
+      g_vector_enabled.load(std::memory_order_relaxed)) {
+    PcmApplyGainScalar(in, out, head, gain_q15);
+    const size_t blocks = (count - head) / kBlockSamples;
+    GainBlocksPie(in + head, out + head, blocks, gain_q15);
+    const size_t done = head + blocks * kBlockSamples;
+    in += done;
+    out += done;
+    count -= done;
+  }
+#endif
+  PcmApplyGainScalar(in, out, count, gain_q15);
+}
+
+// ==================== 采样率转换 ====================
+
+void PcmResampler::Reset(uint32_t in_rate, uint32_t out_rate) {
+  step_ = static_cast<uint32_t>((static_cast<uint64_t>(in_rate) << 16) / out_rate);
+  phase_ = 0;
+  last_ = 0;
+  primed_ = false;
+}
+
+size_t PcmResampler::MaxOutput(size_t count) const {
+  if (passthrough()) {
+    return count;
+  }
+  return static_cast<size_t>((static_cast<uint64_t>(count) << 16) / step_) + 2;
+}
+
+size_t PcmResampler::Process(const int16_t* in, size_t count, int16_t* out) {
+  if (count == 0) {
+    return 0;
+  }
+  if (passthrough()) {
+    memcpy(out, in, count * sizeof(int16_t));
+    return count;
+  }
+  if (!primed_) {
+    last_ = in[0];
+    primed_ = true;
+  }
+
+  // 位置以 last_ 为0，在 x[i - 1] 和 x[i] 之间插值
+  const uint64_t end = static_cast<uint64_t>(count) << 16;
+  uint64_t phase = phase_;
+  size_t written = 0;
+  while (phase < end) {
+    const size_t i = static_cast<size_t>(phase >> 16);
+    const int32_t x0 = i == 0 ? last_ : in[i - 1];
+    const int32_t x1 = in[i];
+    // 相位取15位，避免乘积溢出 int32_t
+    const int32_t frac = static_cast<int32_t>(phase & 0xffff) >> 1;
+    out[written++] = static_cast<int16_t>(x0 + (((x1 - x0) * frac) >> 15));
+    phase += step_;
+  }
+  phase_ = static_cast<uint32_t>(phase - end);
+  last_ = in[count - 1];
+  return written;
+}
+
+// ==================== 解码输出转换 ====================
+
+void PcmConverter::Configure(uint32_t in_rate, uint32_t in_channels, uint32_t out_rate) {
+  in_channels_ = in_channels == 2 ? 2 : 1;
+  resampler_.Reset(in_rate, out_rate);
+}
+
+size_t PcmConverter::MaxOutput(size_t count) const {
+  return resampler_.MaxOutput(count / in_channels_);
+}
+
+size_t PcmConverter::Process(int16_t* in, size_t count, int16_t* out, int32_t gain_q15) {
+  size_t frames = count;
+  if (in_channels_ == 2) {
+    frames = count / 2;
+    PcmDownmixStereo(in, frames, in);
+  }
+  if (resampler_.passthrough()) {
+    PcmApplyGain(in, out, frames, gain_q15);
+    return frames;
+  }
+  const auto written = resampler_.Process(in, frames, out);
+  PcmApplyGain(out, out, written, gain_q15);
+  return written;
+}
+
+// ==================== 自检和性能测试 ====================
+
+namespace {
+
+constexpr size_t kSelfTestSamples = 256;
+constexpr size_t kBenchmarkSamples = 4096;
+constexpr int kBenchmarkRounds = 32;
+
+int64_t NowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// 执行 kBenchmarkRounds 次，返回每秒处理的样本数
+template <typename Function>
+uint32_t MeasureThroughput(Function function) {
+  const auto start_us = NowUs();
+  for (int round = 0; round < kBenchmarkRounds; round++) {
+    function();
+  }
+  const auto elapsed_us = std::max<int64_t>(NowUs() - start_us, 1);
+  return static_cast<uint32_t>(kBenchmarkSamples * kBenchmarkRounds * 1000000LL / elapsed_us);
+}
+
+// 按16字节对齐分配，多留出一组样本供偏移使用
+int16_t* AlignedSamples(std::unique_ptr<int16_t[]>& storage, size_t count) {
+  storage.reset(new int16_t[count + 2 * kBlockSamples]);
+  auto address = reinterpret_cast<uintptr_t>(storage.get());
+  return reinterpret_cast<int16_t*>((address + 15) & ~static_cast<uintptr_t>(15));
+}
+
+void FillTestSamples(int16_t* samples, size_t count) {
+  uint32_t seed = 12345;
+  for (size_t i = 0; i < count; i++) {
+    seed = seed * 1664525 + 1013904223;
+    samples[i] = static_cast<int16_t>(seed >> 16);
+  }
+  // 包含极值，覆盖取整的边界
+  samples[0] = INT16_MIN;
+  samples[1] = INT16_MAX;
+}
+
+}  // namespace
+
+bool PcmDspSelfTest() {
+  std::unique_ptr<int16_t[]> storage[3];
+  int16_t* in = AlignedSamples(storage[0], kSelfTestSamples);
+  int16_t* vector = AlignedSamples(storage[1], kSelfTestSamples);
+  int16_t* scalar = AlignedSamples(storage[2], kSelfTestSamples);
+  FillTestSamples(in, kSelfTestSamples + kBlockSamples);
+
+  bool bit_exact = true;
+  const int32_t gains[] = {0, 1, 12345, 16384, 32767, kPcmUnityGain};
+  const size_t offsets[] = {0, 1, 3, 8};
+  for (const auto gain : gains) {
+    for (const auto offset : offsets) {
+      const size_t count = kSelfTestSamples - offset;
+      PcmApplyGain(in + offset, vector + offset, count, gain);
+      PcmApplyGainScalar(in + offset, scalar + offset, count, gain);
+      bit_exact = bit_exact && memcmp(vector + offset, scalar + offset, count * sizeof(int16_t)) == 0;
+    }
+  }
+  if (!bit_exact) {
+    g_vector_enabled.store(false, std::memory_order_relaxed);
+  }
+  return bit_exact;
+}
+
+bool BenchmarkPcmDsp(const char* label) {
+  const bool bit_exact = PcmDspSelfTest();
+
+  std::unique_ptr<int16_t[]> storage[2];
+  int16_t* in = AlignedSamples(storage[0], kBenchmarkSamples);
+  int16_t* out = AlignedSamples(storage[1], kBenchmarkSamples);
+  FillTestSamples(in, kBenchmarkSamples);
+
+  constexpr int32_t kDuckGain = kPcmUnityGain / 4;
+  const auto gain_scalar = MeasureThroughput([&] { PcmApplyGainScalar(in, out, kBenchmarkSamples, kDuckGain); });
+  const auto gain_vector = MeasureThroughput([&] { PcmApplyGain(in, out, kBenchmarkSamples, kDuckGain); });
+  const auto downmix = MeasureThroughput([&] { PcmDownmixStereo(in, kBenchmarkSamples / 2, out); });
+  PcmResampler resampler;
+  resampler.Reset(44100, 16000);
+  const auto resample = MeasureThroughput([&] { resampler.Process(in, kBenchmarkSamples, out); });
+
+  printf("pcm_dsp %s: %s, samples/s: gain %" PRIu32 " (scalar %" PRIu32 "), downmix %" PRIu32
+         ", resample 44100->16000 %" PRIu32 "\n",
+         label, bit_exact ? "bit-exact" : "MISMATCH", gain_vector, gain_scalar, downmix, resample);
+  return bit_exact;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#ifndef _PCM_DSP_H_
+#define _PCM_DSP_H_
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file pcm_dsp.h
+ * @brief 16位PCM后处理：声道下混、采样率转换和定点增益
+ *
+ * 增益为Q15定点数，kPcmUnityGain 表示1.0(不做处理)，小于它时为衰减，
+ * 结果 = (样本 * 增益) >> 15，向负无穷取整。
+ *
+ * 在 ESP32-S3 上，增益使用 PIE 128位向量指令，每条指令处理8个样本；
+ * 其它平台(以及地址未按16字节对齐的部分)使用标量实现。两种实现的结果应逐位相同，
+ * InitializeDevice() 启动时用 PcmDspSelfTest() 核对，不一致时改用标量实现；
+ * BenchmarkPcmDsp() 另外测量吞吐。
+ */
+
+constexpr int32_t kPcmUnityGain = 32768;
+
+/**
+ * @brief 把双声道交错样本下混为单声道，out 可以与 in 相同
+ *
+ * @param frames 帧数，即每个声道的样本数
+ */
+void PcmDownmixStereo(const int16_t* in, size_t frames, int16_t* out);
+
+/**
+ * @brief out = in * gain_q15，out 可以与 in 相同；gain_q15 取值 [0, kPcmUnityGain]
+ */
+void PcmApplyGain(const int16_t* in, int16_t* out, size_t count, int32_t gain_q15);
+
+/**
+ * @brief 标量实现，供核对和性能对比使用
+ */
+void PcmApplyGainScalar(const int16_t* in, int16_t* out, size_t count, int32_t gain_q15);
+
+/**
+ * @brief 在当前核心上核对向量实现与标量实现的结果，不一致时之后只使用标量实现
+ *
+ * 不需要额外的编译宏，没有向量实现的平台上总是返回true。
+ *
+ * @return 向量实现与标量实现逐位相同
+ */
+bool PcmDspSelfTest();
+
+/**
+ * @brief 流式线性插值采样率转换，单声道
+ *
+ * 相邻两次 Process() 之间保留上一块的最后一个样本和插值相位，分块处理与一次性处理的结果相同。
+ */
+class PcmResampler {
+ public:
+  void Reset(uint32_t in_rate, uint32_t out_rate);
+
+  bool passthrough() const {
+    return step_ == kOne;
+  }
+
+  /**
+   * @brief 输入 count 个样本时最多输出的样本数
+   */
+  size_t MaxOutput(size_t count) const;
+
+  /**
+   * @brief 转换一块样本，返回写入 out 的样本数；out 不能与 in 相同
+   */
+  size_t Process(const int16_t* in, size_t count, int16_t* out);
+
+ private:
+  static constexpr uint32_t kOne = 1 << 16;
+
+  uint32_t step_ = kOne;  // 每个输出样本前进的输入样本数，Q16
+  uint32_t phase_ = 0;    // 下一个输出样本相对 last_ 的位置，Q16
+  int16_t last_ = 0;
+  bool primed_ = false;
+};
+
+/**
+ * @brief 解码器输出到音频设备之间的转换：下混为单声道、转换到输出采样率、施加增益
+ */
+class PcmConverter {
+ public:
+  void Configure(uint32_t in_rate, uint32_t in_channels, uint32_t out_rate);
+
+  /**
+   * @brief 不需要任何转换，可以直接使用解码器输出
+   */
+  bool passthrough(int32_t gain_q15) const {
+    return in_channels_ == 1 && resampler_.passthrough() && gain_q15 == kPcmUnityGain;
+  }
+
+  /**
+   * @brief 输入 count 个(交错)样本时最多输出的样本数
+   */
+  size_t MaxOutput(size_t count) const;
+
+  /**
+   * @brief 转换一块解码结果，返回写入 out 的样本数；双声道时会就地改写 in
+   */
+  size_t Process(int16_t* in, size_t count, int16_t* out, int32_t gain_q15);
+
+ private:
+  uint32_t in_channels_ = 1;
+  PcmResampler resampler_;
+};
+
+/**
+ * @brief 在当前核心上执行 PcmDspSelfTest()，并打印各处理步骤的吞吐(样本/秒)
+ *
+ * @return 向量实现与标量实现逐位相同
+ */
+bool BenchmarkPcmDsp(const char* label);
+
+#endif
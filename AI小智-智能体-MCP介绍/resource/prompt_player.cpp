@@ -0,0 +1,500 @@
+#include "prompt_player.h"
+
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+#include "components/espressif/esp_audio_codec/esp_mp3_dec.h"
+#include "metrics.h"
+
+namespace {
+
+constexpr UBaseType_t kMaxPendingPrompts = 8;
+constexpr uint32_t kDecodeTaskStackSize = 8192;
+constexpr uint32_t kWriteTaskStackSize = 4096;
+constexpr UBaseType_t kTaskPriority = 5;
+// 播放PCM缓存和PCM提示音时每次交给写入任务的样本数，决定了 Cancel() 的响应粒度
+constexpr size_t kPcmChunkSamples = 1024;
+
+}  // namespace
+
+PromptPlayer::PromptPlayer(std::shared_ptr<ai_vox::AudioDeviceEs8311> audio_device, uint32_t sample_rate)
+    : audio_device_(std::move(audio_device)), sample_rate_(sample_rate) {
+  request_queue_ = xQueueCreate(kMaxPendingPrompts, sizeof(Request));
+  free_frame_queue_ = xQueueCreate(2, sizeof(Frame*));
+  filled_frame_queue_ = xQueueCreate(2, sizeof(Frame*));
+  if (request_queue_ == nullptr || free_frame_queue_ == nullptr || filled_frame_queue_ == nullptr) {
+    printf("Failed to create prompt player queues\n");
+    abort();
+  }
+
+  for (auto& frame : frames_) {
+    Frame* frame_ptr = &frame;
+    xQueueSend(free_frame_queue_, &frame_ptr, 0);
+  }
+
+  if (xTaskCreate(DecodeTask, "prompt_decode", kDecodeTaskStackSize, this, kTaskPriority, &decode_task_) != pdPASS ||
+      xTaskCreate(WriteTask, "prompt_write", kWriteTaskStackSize, this, kTaskPriority, &write_task_) != pdPASS) {
+    printf("Failed to create prompt player tasks\n");
+    abort();
+  }
+  RegisterMetricTask("prompt_decode", decode_task_);
+  RegisterMetricTask("prompt_write", write_task_);
+}
+
+PromptPlayer::~PromptPlayer() {
+  Cancel();
+  Release();
+  UnregisterMetricTask(decode_task_);
+  UnregisterMetricTask(write_task_);
+  vTaskDelete(decode_task_);
+  vTaskDelete(write_task_);
+  vQueueDelete(request_queue_);
+  vQueueDelete(free_frame_queue_);
+  vQueueDelete(filled_frame_queue_);
+  for (auto& [data, cache] : pcm_caches_) {
+    heap_caps_free(cache.samples);
+  }
+}
+
+void PromptPlayer::SetGain(int32_t gain_q15) {
+  gain_q15_.store(std::clamp<int32_t>(gain_q15, 0, kPcmUnityGain));
+}
+
+bool PromptPlayer::Enqueue(const uint8_t* data, size_t size, Priority priority) {
+  return Submit(
+      Request{
+          .data = data,
+          .size = size,
+          .pcm_sample_rate = 0,
+          .pcm_channels = 0,
+          .generation = 0,
+          .enqueue_us = 0,
+      },
+      priority);
+}
+
+bool PromptPlayer::EnqueuePcm(const int16_t* samples, size_t sample_count, uint32_t sample_rate, uint8_t channels,
+                              Priority priority) {
+  return Submit(
+      Request{
+          .data = reinterpret_cast<const uint8_t*>(samples),
+          .size = sample_count * sizeof(int16_t),
+          .pcm_sample_rate = sample_rate,
+          .pcm_channels = channels,
+          .generation = 0,
+          .enqueue_us = 0,
+      },
+      priority);
+}
+
+bool PromptPlayer::Submit(Request request, Priority priority) {
+  if (priority == Priority::kPreempt) {
+    Cancel();
+  }
+
+  pending_.fetch_add(1);
+  request.generation = generation_.load();
+  request.enqueue_us = esp_timer_get_time();
+  if (xQueueSend(request_queue_, &request, 0) != pdTRUE) {
+    printf("prompt queue full, dropped\n");
+    FinishPrompt();
+    return false;
+  }
+  return true;
+}
+
+void PromptPlayer::EnablePcmCache(const uint8_t* data) {
+  pcm_caches_.try_emplace(data);
+}
+
+void PromptPlayer::Cancel() {
+  generation_.fetch_add(1);
+
+  Request request;
+  while (xQueueReceive(request_queue_, &request, 0) == pdTRUE) {
+    FinishPrompt();
+  }
+}
+
+bool PromptPlayer::WaitIdle(TickType_t timeout) {
+  const auto start = xTaskGetTickCount();
+  while (pending_.load() > 0) {
+    if (timeout != portMAX_DELAY && xTaskGetTickCount() - start >= timeout) {
+      return false;
+    }
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return true;
+}
+
+void PromptPlayer::Play(const uint8_t* data, size_t size) {
+  if (Enqueue(data, size)) {
+    WaitIdle();
+  }
+}
+
+void PromptPlayer::Release() {
+  // 等待两个任务都回到阻塞状态后再释放它们使用的资源
+  WaitIdle();
+
+  if (output_opened_) {
+    audio_device_->CloseOutput();
+    output_opened_ = false;
+  }
+
+  if (decoder_registered_) {
+    esp_audio_dec_unregister(ESP_AUDIO_TYPE_MP3);
+    decoder_registered_ = false;
+  }
+
+  for (auto& frame : frames_) {
+    heap_caps_free(frame.buffer);
+    frame.buffer = nullptr;
+    frame.capacity = 0;
+    heap_caps_free(frame.pcm);
+    frame.pcm = nullptr;
+    frame.pcm_capacity = 0;
+  }
+}
+
+PromptPlayer::Stats PromptPlayer::TakeStats() {
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  const auto stats = stats_;
+  stats_ = Stats();
+  return stats;
+}
+
+void PromptPlayer::DecodeTask(void* self) {
+  static_cast<PromptPlayer*>(self)->DecodeLoop();
+}
+
+void PromptPlayer::WriteTask(void* self) {
+  static_cast<PromptPlayer*>(self)->WriteLoop();
+}
+
+void PromptPlayer::DecodeLoop() {
+  while (true) {
+    Request request;
+    if (xQueueReceive(request_queue_, &request, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    if (IsStale(request.generation)) {
+      FinishPrompt();
+      continue;
+    }
+    Decode(request);
+  }
+}
+
+void PromptPlayer::Decode(const Request& request) {
+  Prepare();
+
+  if (request.pcm_sample_rate != 0) {
+    converter_.Configure(request.pcm_sample_rate, request.pcm_channels, sample_rate_);
+    StreamPcm(request, reinterpret_cast<const int16_t*>(request.data), request.size / sizeof(int16_t));
+    return;
+  }
+
+  auto cache_it = pcm_caches_.find(request.data);
+  PcmCache* cache = cache_it != pcm_caches_.end() ? &cache_it->second : nullptr;
+  if (cache != nullptr && cache->ready) {
+    // 缓存中已是输出格式
+    converter_.Configure(sample_rate_, 1, sample_rate_);
+    StreamPcm(request, cache->samples, cache->sample_count);
+    return;
+  }
+
+  esp_audio_simple_dec_handle_t decoder = nullptr;
+  esp_audio_simple_dec_cfg_t audio_dec_cfg{
+      .dec_type = ESP_AUDIO_SIMPLE_DEC_TYPE_MP3,
+      .dec_cfg = nullptr,
+      .cfg_size = 0,
+  };
+  const auto ret = esp_audio_simple_dec_open(&audio_dec_cfg, &decoder);
+  if (ret != ESP_AUDIO_ERR_OK) {
+    printf("Failed to open mp3 decoder: %d\n", ret);
+    abort();
+  }
+
+  esp_audio_simple_dec_raw_t raw = {
+      .buffer = const_cast<uint8_t*>(request.data),
+      .len = static_cast<uint32_t>(request.size),
+      .eos = true,
+      .consumed = 0,
+      .frame_recover = ESP_AUDIO_SIMPLE_DEC_RECOVERY_NONE,
+  };
+
+  Frame* frame = nullptr;
+  bool first = true;
+  bool configured = false;
+  bool completed = false;
+  int64_t total_decode_time_us = 0;
+  while (!IsStale(request.generation)) {
+    if (raw.len == 0) {
+      completed = true;
+      break;
+    }
+
+    if (frame == nullptr) {
+      frame = AcquireFrame();
+    }
+
+    esp_audio_simple_dec_out_t out_frame = {
+        .buffer = frame->buffer,
+        .len = static_cast<uint32_t>(frame->capacity),
+        .needed_size = 0,
+        .decoded_size = 0,
+    };
+
+    const auto decode_start_us = esp_timer_get_time();
+    const auto ret = esp_audio_simple_dec_process(decoder, &raw, &out_frame);
+    const auto decode_time_us = esp_timer_get_time() - decode_start_us;
+
+    if (ret == ESP_AUDIO_ERR_BUFF_NOT_ENOUGH) {
+      // 缓冲区按解码器首次要求的大小在PSRAM中分配，之后所有提示音复用
+      auto buffer = reinterpret_cast<uint8_t*>(heap_caps_realloc(frame->buffer, out_frame.needed_size, MALLOC_CAP_SPIRAM));
+      if (buffer == nullptr) {
+        printf("Failed to allocate %" PRIu32 " bytes for mp3 frame\n", out_frame.needed_size);
+        break;
+      }
+      frame->buffer = buffer;
+      frame->capacity = out_frame.needed_size;
+      continue;
+    }
+
+    if (ret != ESP_AUDIO_ERR_OK) {
+      break;
+    }
+
+    raw.len -= raw.consumed;
+    raw.buffer += raw.consumed;
+
+    total_decode_time_us += decode_time_us;
+    {
+      std::lock_guard<std::mutex> lock(stats_mutex_);
+      stats_.decode_time_us += decode_time_us;
+      stats_.decoded_samples += out_frame.decoded_size >> 1;
+    }
+
+    if (out_frame.decoded_size == 0) {
+      continue;
+    }
+
+    // 解码出第一帧后才能取得MP3的采样率和声道数
+    if (!configured) {
+      esp_audio_simple_dec_info_t info = {};
+      esp_audio_simple_dec_get_info(decoder, &info);
+      converter_.Configure(info.sample_rate, info.channel, sample_rate_);
+      if (!converter_.passthrough(kPcmUnityGain)) {
+        printf("prompt: converting %" PRIu32 " Hz %u ch to %" PRIu32 " Hz mono\n", info.sample_rate, info.channel,
+               sample_rate_);
+      }
+      configured = true;
+    }
+
+    const int16_t* samples = reinterpret_cast<const int16_t*>(out_frame.buffer);
+    size_t sample_count = out_frame.decoded_size >> 1;
+    if (!converter_.passthrough(kPcmUnityGain)) {
+      if (!ReservePcm(*frame, converter_.MaxOutput(sample_count))) {
+        break;
+      }
+      sample_count = converter_.Process(reinterpret_cast<int16_t*>(out_frame.buffer), sample_count, frame->pcm,
+                                        kPcmUnityGain);
+      samples = frame->pcm;
+    }
+
+    if (cache != nullptr && !AppendPcmCache(*cache, samples, sample_count)) {
+      cache = nullptr;
+    }
+
+    // 交给写入任务，下一帧解码到另一个缓冲区
+    frame->samples = ApplyGain(*frame, samples, sample_count);
+    frame->sample_count = sample_count;
+    frame->generation = request.generation;
+    frame->start_us = request.enqueue_us;
+    frame->first = first;
+    frame->last = false;
+    first = false;
+    xQueueSend(filled_frame_queue_, &frame, portMAX_DELAY);
+    frame = nullptr;
+  }
+
+  esp_audio_simple_dec_close(decoder);
+
+  if (cache_it != pcm_caches_.end()) {
+    auto& entry = cache_it->second;
+    if (completed && cache != nullptr) {
+      entry.ready = true;
+      printf("prompt pcm cache: mp3 %zu B -> pcm %zu B, decode %" PRId64 " us saved per play\n",
+             request.size, entry.sample_count * sizeof(int16_t), total_decode_time_us);
+    } else {
+      // 播放被打断或内存不足，丢弃不完整的缓存，下次播放时重新生成
+      heap_caps_free(entry.samples);
+      entry = PcmCache();
+    }
+  }
+
+  // 用一个空帧通知写入任务这段提示音已结束
+  if (frame == nullptr) {
+    frame = AcquireFrame();
+  }
+  frame->sample_count = 0;
+  frame->generation = request.generation;
+  frame->first = false;
+  frame->last = true;
+  xQueueSend(filled_frame_queue_, &frame, portMAX_DELAY);
+}
+
+void PromptPlayer::StreamPcm(const Request& request, const int16_t* samples, size_t sample_count) {
+  size_t offset = 0;
+  bool first = true;
+  while (true) {
+    auto frame = AcquireFrame();
+    auto count = IsStale(request.generation) ? 0 : std::min(kPcmChunkSamples, sample_count - offset);
+    const int16_t* chunk = samples + offset;
+    offset += count;
+    size_t output_count = count;
+    if (count > 0 && !converter_.passthrough(kPcmUnityGain)) {
+      // 双声道时 Process() 会就地改写输入，而 samples 可能在只读的 flash 中，先复制到帧的解码缓冲区
+      const size_t bytes = count * sizeof(int16_t);
+      if (bytes > frame->capacity) {
+        auto buffer = reinterpret_cast<uint8_t*>(heap_caps_realloc(frame->buffer, bytes, MALLOC_CAP_SPIRAM));
+        if (buffer != nullptr) {
+          frame->buffer = buffer;
+          frame->capacity = bytes;
+        }
+      }
+      if (bytes > frame->capacity || !ReservePcm(*frame, converter_.MaxOutput(count))) {
+        printf("Failed to allocate buffers for prompt pcm conversion\n");
+        output_count = 0;
+        offset = sample_count;
+      } else {
+        memcpy(frame->buffer, chunk, bytes);
+        output_count =
+            converter_.Process(reinterpret_cast<int16_t*>(frame->buffer), count, frame->pcm, kPcmUnityGain);
+        chunk = frame->pcm;
+      }
+    }
+    frame->samples = ApplyGain(*frame, chunk, output_count);
+    frame->sample_count = output_count;
+    frame->generation = request.generation;
+    frame->start_us = request.enqueue_us;
+    frame->first = first;
+    frame->last = offset >= sample_count || count == 0;
+    first = false;
+
+    const bool last = frame->last;
+    xQueueSend(filled_frame_queue_, &frame, portMAX_DELAY);
+    if (last) {
+      break;
+    }
+  }
+}
+
+bool PromptPlayer::AppendPcmCache(PcmCache& cache, const int16_t* samples, size_t count) {
+  if (cache.sample_count + count > cache.capacity) {
+    const auto capacity = std::max(cache.capacity * 2, cache.sample_count + count);
+    auto buffer = reinterpret_cast<int16_t*>(heap_caps_realloc(cache.samples, capacity * sizeof(int16_t), MALLOC_CAP_SPIRAM));
+    if (buffer == nullptr) {
+      printf("Failed to allocate %zu bytes for prompt pcm cache\n", capacity * sizeof(int16_t));
+      return false;
+    }
+    cache.samples = buffer;
+    cache.capacity = capacity;
+  }
+  memcpy(cache.samples + cache.sample_count, samples, count * sizeof(int16_t));
+  cache.sample_count += count;
+  return true;
+}
+
+bool PromptPlayer::ReservePcm(Frame& frame, size_t count) {
+  if (count <= frame.pcm_capacity) {
+    return true;
+  }
+  // 放在内部RAM中，向量指令和I2S写入都比PSRAM快；容量只增不减，之后所有提示音复用
+  heap_caps_free(frame.pcm);
+  frame.pcm = static_cast<int16_t*>(heap_caps_aligned_alloc(16, count * sizeof(int16_t), MALLOC_CAP_INTERNAL));
+  frame.pcm_capacity = frame.pcm != nullptr ? count : 0;
+  if (frame.pcm == nullptr) {
+    printf("Failed to allocate %zu bytes for prompt pcm\n", count * sizeof(int16_t));
+    return false;
+  }
+  return true;
+}
+
+const int16_t* PromptPlayer::ApplyGain(Frame& frame, const int16_t* samples, size_t count) {
+  const auto gain_q15 = gain_q15_.load();
+  if (gain_q15 >= kPcmUnityGain || count == 0) {
+    return samples;
+  }
+  // samples 已经在 frame.pcm 中时就地处理
+  if (samples != frame.pcm && !ReservePcm(frame, count)) {
+    return samples;
+  }
+  PcmApplyGain(samples, frame.pcm, count, gain_q15);
+  return frame.pcm;
+}
+
+PromptPlayer::Frame* PromptPlayer::AcquireFrame() {
+  Frame* frame = nullptr;
+  xQueueReceive(free_frame_queue_, &frame, portMAX_DELAY);
+  return frame;
+}
+
+void PromptPlayer::WriteLoop() {
+  while (true) {
+    Frame* frame = nullptr;
+    if (xQueueReceive(filled_frame_queue_, &frame, portMAX_DELAY) != pdTRUE) {
+      continue;
+    }
+
+    if (frame->sample_count > 0 && !IsStale(frame->generation)) {
+      audio_device_->Write(const_cast<int16_t*>(frame->samples), frame->sample_count);
+      if (frame->first) {
+        const auto first_sample_us = esp_timer_get_time() - frame->start_us;
+        printf("prompt first sample after %" PRId64 " us\n", first_sample_us);
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.last_first_sample_us = first_sample_us;
+      }
+    }
+
+    const bool last = frame->last;
+    xQueueSend(free_frame_queue_, &frame, portMAX_DELAY);
+    if (last) {
+      FinishPrompt();
+    }
+  }
+}
+
+void PromptPlayer::Prepare() {
+  if (!decoder_registered_) {
+    const auto ret = esp_mp3_dec_register();
+    if (ret != ESP_AUDIO_ERR_OK) {
+      printf("Failed to register mp3 decoder: %d\n", ret);
+      abort();
+    }
+    decoder_registered_ = true;
+  }
+
+  // 输出通道在连续的提示音之间保持打开，直到 Release()
+  if (!output_opened_) {
+    audio_device_->OpenOutput(sample_rate_);
+    output_opened_ = true;
+  }
+}
+
+void PromptPlayer::FinishPrompt() {
+  pending_.fetch_sub(1);
+}
+
+bool PromptPlayer::IsStale(uint32_t generation) const {
+  return generation != generation_.load();
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#ifndef _PROMPT_PLAYER_H_
+#define _PROMPT_PLAYER_H_
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include "audio_device/audio_device_es8311.h"
+#include "components/espressif/esp_audio_codec/esp_audio_simple_dec.h"
+#include "pcm_dsp.h"
+
+/**
+ * @brief 提示音播放器
+ *
+ * 长期持有MP3解码器注册、PCM输出缓冲区和音频输出通道，
+ * 连续播放多段提示音时无需重复注册解码器、分配缓冲区和打开输出。
+ *
+ * 提示音通过队列异步播放：解码任务把下一帧解码到一个缓冲区的同时，
+ * 写入任务把上一帧写入 AudioDeviceEs8311（双缓冲流水线）。
+ *
+ * 对启用了PCM缓存的提示音，首次播放时把解码结果保存在PSRAM中，
+ * 之后再播放时直接从内存写入I2S，不再解码。
+ *
+ * 解码结果按MP3实际的采样率和声道数转换为输出采样率的单声道，再施加 SetGain() 设置的增益，
+ * 非16kHz单声道的素材也能正常播放。资源包中未压缩的PCM提示音经 EnqueuePcm() 不解码直接播放。
+ */
+class PromptPlayer {
+ public:
+  enum class Priority : uint8_t {
+    kNormal,   // 排在队列末尾，依次播放
+    kPreempt,  // 打断正在播放的提示音并清空队列后立即播放
+  };
+
+  struct Stats {
+    size_t decoded_samples = 0;
+    int64_t decode_time_us = 0;
+    int64_t last_first_sample_us = 0;
+  };
+
+  PromptPlayer(std::shared_ptr<ai_vox::AudioDeviceEs8311> audio_device, uint32_t sample_rate);
+  ~PromptPlayer();
+
+  PromptPlayer(const PromptPlayer&) = delete;
+  PromptPlayer& operator=(const PromptPlayer&) = delete;
+
+  /**
+   * @brief 将一段MP3数据加入播放队列后立即返回
+   *
+   * data 指向的数据在播放完成前必须保持有效（通常为编译进固件的常量数组）。
+   *
+   * @return 队列已满时返回false
+   */
+  bool Enqueue(const uint8_t* data, size_t size, Priority priority = Priority::kNormal);
+
+  /**
+   * @brief 将一段16位PCM数据(多声道时交错存放)加入播放队列后立即返回
+   *
+   * 不经过解码器，按 sample_rate 和 channels 转换为输出格式后播放。samples 在播放完成前
+   * 必须保持有效，可以直接指向映射的 flash(只读取，不修改)。
+   *
+   * @param sample_count 样本总数(各声道之和)
+   * @return 队列已满时返回false
+   */
+  bool EnqueuePcm(const int16_t* samples, size_t sample_count, uint32_t sample_rate, uint8_t channels,
+                  Priority priority = Priority::kNormal);
+
+  /**
+   * @brief 为一段MP3数据启用PCM缓存
+   *
+   * 需在该数据首次 Enqueue() 之前调用。首次播放完成后会打印MP3大小、
+   * PCM大小和解码耗时，便于按提示音权衡内存占用和播放延迟。
+   */
+  void EnablePcmCache(const uint8_t* data);
+
+  /**
+   * @brief 设置提示音增益(Q15，kPcmUnityGain 为原音量)，用于与其它音频同时播放时压低提示音
+   *
+   * 对之后解码或从缓存读取的帧生效，PCM缓存中保存的是施加增益之前的数据。
+   */
+  void SetGain(int32_t gain_q15);
+
+  /**
+   * @brief 停止正在播放的提示音并清空队列
+   */
+  void Cancel();
+
+  /**
+   * @brief 等待队列中的提示音全部播放完成
+   *
+   * @return 超时返回false
+   */
+  bool WaitIdle(TickType_t timeout = portMAX_DELAY);
+
+  /**
+   * @brief 同步播放一段MP3数据，播放完成后输出通道保持打开
+   */
+  void Play(const uint8_t* data, size_t size);
+
+  /**
+   * @brief 等待播放完成，关闭输出通道并释放解码器和缓冲区
+   *
+   * 在音频设备交给AI引擎之前必须调用，之后再次播放会重新初始化。
+   */
+  void Release();
+
+  /**
+   * @brief 取出自上次调用以来的解码统计并清零
+   */
+  Stats TakeStats();
+
+ private:
+  struct PcmCache {
+    int16_t* samples = nullptr;
+    size_t sample_count = 0;
+    size_t capacity = 0;
+    bool ready = false;
+  };
+
+  struct Request {
+    const uint8_t* data;
+    size_t size;
+    // 为0时 data 是MP3数据，否则是该采样率的PCM
+    uint32_t pcm_sample_rate;
+    uint8_t pcm_channels;
+    uint32_t generation;
+    int64_t enqueue_us;
+  };
+
+  struct Frame {
+    uint8_t* buffer = nullptr;
+    size_t capacity = 0;
+    // 采样率转换和增益的输出，按16字节对齐以使用向量指令
+    int16_t* pcm = nullptr;
+    size_t pcm_capacity = 0;
+    // 指向 buffer 中的解码结果、pcm 中的转换结果，或直接指向PCM缓存和资源包中的PCM
+    const int16_t* samples = nullptr;
+    size_t sample_count = 0;
+    uint32_t generation = 0;
+    int64_t start_us = 0;
+    bool first = false;
+    bool last = false;
+  };
+
+  static void DecodeTask(void* self);
+  static void WriteTask(void* self);
+  void DecodeLoop();
+  void WriteLoop();
+  bool Submit(Request request, Priority priority);
+  void Decode(const Request& request);
+  void StreamPcm(const Request& request, const int16_t* samples, size_t sample_count);
+  bool AppendPcmCache(PcmCache& cache, const int16_t* samples, size_t count);
+  bool ReservePcm(Frame& frame, size_t count);
+  const int16_t* ApplyGain(Frame& frame, const int16_t* samples, size_t count);
+  Frame* AcquireFrame();
+  void Prepare();
+  void FinishPrompt();
+  bool IsStale(uint32_t generation) const;
+
+  std::shared_ptr<ai_vox::AudioDeviceEs8311> audio_device_;
+  const uint32_t sample_rate_;
+  bool decoder_registered_ = false;
+  bool output_opened_ = false;
+  // 只在解码任务中访问，每段提示音按解码器报告的格式重新配置
+  PcmConverter converter_;
+  std::atomic<int32_t> gain_q15_{kPcmUnityGain};
+
+  // 两个帧缓冲区在空闲队列和待写队列之间轮转
+  Frame frames_[2];
+  // 只在解码任务中访问（EnablePcmCache() 除外，须在首次播放前调用）
+  std::map<const uint8_t*, PcmCache> pcm_caches_;
+  QueueHandle_t request_queue_ = nullptr;
+  QueueHandle_t free_frame_queue_ = nullptr;
+  QueueHandle_t filled_frame_queue_ = nullptr;
+  TaskHandle_t decode_task_ = nullptr;
+  TaskHandle_t write_task_ = nullptr;
+
+  // Cancel() 时递增，旧代次的请求和帧会被直接丢弃
+  std::atomic<uint32_t> generation_{0};
+  std::atomic<int32_t> pending_{0};
+
+  std::mutex stats_mutex_;
+  Stats stats_;
+};
+
+#endif
@@ -0,0 +1,243 @@
+#include "sensor_sampler.h"
+
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "metrics.h"
+
+namespace {
+
+constexpr uint32_t kSamplerStackSize = 4096;
+constexpr UBaseType_t kSamplerPriority = 1;
+// Arduino 的 loop() 运行在核心1，采样任务固定在核心0
+constexpr BaseType_t kSamplerCore = 0;
+
+// 单调队列，按样本序号记录滑动窗口内可能成为最小值(或最大值)的样本
+class MonotonicQueue {
+ public:
+  void Init(uint32_t capacity) {
+    seqs_.assign(capacity, 0);
+  }
+
+  // 移除已滑出窗口的样本，必须在新样本覆盖环形缓冲区之前调用
+  void Evict(uint64_t oldest_seq) {
+    while (size_ > 0 && seqs_[head_] < oldest_seq) {
+      head_ = (head_ + 1) % seqs_.size();
+      size_--;
+    }
+  }
+
+  // 移除不可能再成为极值的样本后加入新样本，keep(a, b) 表示 a 在 b 之前时仍需保留 a
+  template <typename Value, typename Keep>
+  void Push(uint64_t seq, Value value_of, Keep keep) {
+    const float value = value_of(seq);
+    while (size_ > 0 && !keep(value_of(Back()), value)) {
+      size_--;
+    }
+    seqs_[(head_ + size_) % seqs_.size()] = seq;
+    size_++;
+  }
+
+  uint64_t Front() const {
+    return seqs_[head_];
+  }
+
+ private:
+  uint64_t Back() const {
+    return seqs_[(head_ + size_ - 1) % seqs_.size()];
+  }
+
+  std::vector<uint64_t> seqs_;
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+struct Sensor {
+  std::string name;
+  uint32_t period_ms = 0;
+  uint32_t channels = 0;
+  uint32_t window = 0;
+  SensorReadFunction read;
+  int64_t next_due_us = 0;  // 只由采样任务访问
+
+  // 以下成员由 g_mutex 保护
+  std::vector<SensorReading> ring;
+  uint64_t count = 0;  // 累计成功读取次数，最新样本的序号为 count - 1
+  double sums[kMaxSensorChannels] = {};
+  MonotonicQueue min_queues[kMaxSensorChannels];
+  MonotonicQueue max_queues[kMaxSensorChannels];
+
+  Metric* failures = nullptr;
+  Metric* read_us_max = nullptr;
+};
+
+std::mutex g_mutex;
+std::vector<std::unique_ptr<Sensor>> g_sensors;
+TaskHandle_t g_sampler_task = nullptr;
+
+void AddSample(Sensor& sensor, const SensorReading& reading) {
+  const uint64_t seq = sensor.count;
+  auto& slot = sensor.ring[seq % sensor.window];
+  const bool full = seq >= sensor.window;
+  const uint64_t oldest_seq = full ? seq - sensor.window + 1 : 0;
+  const auto value_at = [&sensor](uint32_t channel) {
+    return [&sensor, channel](uint64_t sample_seq) { return sensor.ring[sample_seq % sensor.window].values[channel]; };
+  };
+
+  for (uint32_t channel = 0; channel < sensor.channels; channel++) {
+    sensor.min_queues[channel].Evict(oldest_seq);
+    sensor.max_queues[channel].Evict(oldest_seq);
+    if (full) {
+      sensor.sums[channel] -= slot.values[channel];
+    }
+    sensor.sums[channel] += reading.values[channel];
+  }
+  slot = reading;
+  for (uint32_t channel = 0; channel < sensor.channels; channel++) {
+    sensor.min_queues[channel].Push(seq, value_at(channel), [](float kept, float value) { return kept < value; });
+    sensor.max_queues[channel].Push(seq, value_at(channel), [](float kept, float value) { return kept > value; });
+  }
+  sensor.count++;
+}
+
+void Sample(Sensor& sensor) {
+  SensorReading reading;
+  const auto start_time = esp_timer_get_time();
+  bool ok = sensor.read(reading.values);
+  reading.timestamp_us = esp_timer_get_time();
+  sensor.read_us_max->UpdateMax(static_cast<uint32_t>(reading.timestamp_us - start_time));
+
+  for (uint32_t channel = 0; ok && channel < sensor.channels; channel++) {
+    ok = std::isfinite(reading.values[channel]);
+  }
+  if (!ok) {
+    // 读取失败时保留上一次的结果，调用者可根据时间戳判断数据是否过旧
+    sensor.failures->Add();
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(g_mutex);
+  AddSample(sensor, reading);
+}
+
+void SamplerTask(void*) {
+  while (true) {
+    std::vector<Sensor*> sensors;
+    {
+      std::lock_guard<std::mutex> lock(g_mutex);
+      for (const auto& sensor : g_sensors) {
+        sensors.push_back(sensor.get());
+      }
+    }
+
+    int64_t next_wake_us = INT64_MAX;
+    for (auto sensor : sensors) {
+      const auto now_us = esp_timer_get_time();
+      if (now_us >= sensor->next_due_us) {
+        Sample(*sensor);
+        const int64_t period_us = static_cast<int64_t>(sensor->period_ms) * 1000;
+        sensor->next_due_us += period_us;
+        // 读取耗时超过周期时不补采，从现在起重新计时
+        if (sensor->next_due_us <= now_us) {
+          sensor->next_due_us = now_us + period_us;
+        }
+      }
+      next_wake_us = std::min(next_wake_us, sensor->next_due_us);
+    }
+
+    // 新注册传感器时会通知本任务提前醒来
+    TickType_t wait_ticks = portMAX_DELAY;
+    if (next_wake_us != INT64_MAX) {
+      const int64_t wait_us = std::max<int64_t>(next_wake_us - esp_timer_get_time(), 0);
+      wait_ticks = pdMS_TO_TICKS((wait_us + 999) / 1000);
+    }
+    ulTaskNotifyTake(pdTRUE, wait_ticks);
+  }
+}
+
+Sensor* FindSensor(int sensor) {
+  if (sensor < 0 || static_cast<size_t>(sensor) >= g_sensors.size()) {
+    return nullptr;
+  }
+  return g_sensors[sensor].get();
+}
+
+}  // namespace
+
+int RegisterSensor(const char* name, uint32_t period_ms, uint32_t channels, uint32_t window, SensorReadFunction read) {
+  if (period_ms == 0 || channels == 0 || channels > kMaxSensorChannels || window == 0 || !read) {
+    printf("invalid sensor config: %s\n", name);
+    return -1;
+  }
+
+  auto sensor = std::make_unique<Sensor>();
+  sensor->name = name;
+  sensor->period_ms = period_ms;
+  sensor->channels = channels;
+  sensor->window = window;
+  sensor->read = std::move(read);
+  sensor->ring.resize(window);
+  for (uint32_t channel = 0; channel < channels; channel++) {
+    sensor->min_queues[channel].Init(window);
+    sensor->max_queues[channel].Init(window);
+  }
+  sensor->failures = &GetMetric("sensor." + sensor->name + ".failures");
+  sensor->read_us_max = &GetMetric("sensor." + sensor->name + ".read_us_max");
+
+  int id = 0;
+  {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    id = static_cast<int>(g_sensors.size());
+    g_sensors.push_back(std::move(sensor));
+  }
+  if (g_sampler_task != nullptr) {
+    xTaskNotifyGive(g_sampler_task);
+  }
+  return id;
+}
+
+void StartSensorSampler() {
+  if (g_sampler_task != nullptr) {
+    return;
+  }
+  if (xTaskCreatePinnedToCore(SamplerTask, "sensor_sampler", kSamplerStackSize, nullptr, kSamplerPriority,
+                              &g_sampler_task, kSamplerCore) != pdPASS) {
+    printf("Failed to create sensor sampler task\n");
+    abort();
+  }
+  RegisterMetricTask("sensor_sampler", g_sampler_task);
+}
+
+bool GetSensorLatest(int sensor, SensorReading* reading) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  const auto target = FindSensor(sensor);
+  if (target == nullptr || target->count == 0) {
+    return false;
+  }
+  *reading = target->ring[(target->count - 1) % target->window];
+  return true;
+}
+
+bool GetSensorStats(int sensor, uint32_t channel, SensorStats* stats) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  const auto target = FindSensor(sensor);
+  if (target == nullptr || channel >= target->channels || target->count == 0) {
+    return false;
+  }
+  const auto value_of = [target, channel](uint64_t seq) { return target->ring[seq % target->window].values[channel]; };
+  stats->count = static_cast<uint32_t>(std::min<uint64_t>(target->count, target->window));
+  stats->min = value_of(target->min_queues[channel].Front());
+  stats->max = value_of(target->max_queues[channel].Front());
+  stats->avg = static_cast<float>(target->sums[channel] / stats->count);
+  return true;
+}
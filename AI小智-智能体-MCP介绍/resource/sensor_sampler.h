@@ -0,0 +1,79 @@
+#pragma once
+
+#ifndef _SENSOR_SAMPLER_H_
+#define _SENSOR_SAMPLER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+/**
+ * @file sensor_sampler.h
+ * @brief 后台传感器采样
+ *
+ * DHT11、光敏、超声波等传感器读取慢(DHT11 两次读取至少间隔约2秒，每次阻塞几十毫秒)，
+ * 在 MCP 处理函数中直接读取会拖慢响应甚至失败。注册后由后台任务按各自的周期读取，
+ * 结果带时间戳存入每个传感器的环形缓冲区；处理函数只取缓存，最新值和统计窗口内的
+ * 最小/最大/平均值都是常数时间。
+ *
+ * 示例：
+ * @code
+ * const int dht11 = RegisterSensor("dht11", 2000, 2, 30, [](float* values) {
+ *   values[0] = dht.readTemperature();
+ *   values[1] = dht.readHumidity();
+ *   return !isnan(values[0]) && !isnan(values[1]);
+ * });
+ *
+ * SensorReading reading;
+ * if (GetSensorLatest(dht11, &reading)) {
+ *   // reading.values[0] 为温度，reading.values[1] 为湿度
+ * }
+ * @endcode
+ */
+
+constexpr size_t kMaxSensorChannels = 4;
+
+/**
+ * @brief 读取一次传感器，把 channels 个数值写入 values，失败时返回false
+ */
+using SensorReadFunction = std::function<bool(float* values)>;
+
+struct SensorReading {
+  float values[kMaxSensorChannels] = {};
+  int64_t timestamp_us = 0;  // esp_timer_get_time() 时间
+};
+
+struct SensorStats {
+  float min = 0;
+  float max = 0;
+  float avg = 0;
+  uint32_t count = 0;  // 窗口内的样本数，未满窗口时小于 window
+};
+
+/**
+ * @brief 注册一个传感器，可在 StartSensorSampler() 之前或之后调用
+ *
+ * @param name 名称，用于日志和 sensor.<name>.* 指标
+ * @param period_ms 采样周期(毫秒)
+ * @param channels 每次读取得到的数值个数，如温度和湿度为2，不超过 kMaxSensorChannels
+ * @param window 保留的最近样本数，也是 GetSensorStats() 的统计窗口
+ * @return 传感器编号，参数无效时返回-1
+ */
+int RegisterSensor(const char* name, uint32_t period_ms, uint32_t channels, uint32_t window, SensorReadFunction read);
+
+/**
+ * @brief 启动后台采样任务
+ */
+void StartSensorSampler();
+
+/**
+ * @brief 取最近一次成功读取的结果，还没有成功读取过时返回false
+ */
+bool GetSensorLatest(int sensor, SensorReading* reading);
+
+/**
+ * @brief 取统计窗口内某个通道的最小/最大/平均值，还没有样本时返回false
+ */
+bool GetSensorStats(int sensor, uint32_t channel, SensorStats* stats);
+
+#endif
@@ -0,0 +1,56 @@
+#include "simulated_i2c_bus.h"
+
+#include <chrono>
+#include <thread>
+
+SimulatedI2cBus::SimulatedI2cBus(uint32_t transfer_us) : transfer_us_(transfer_us) {
+}
+
+void SimulatedI2cBus::AddDevice(uint16_t address) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  devices_[address];
+}
+
+void SimulatedI2cBus::SetFailing(uint16_t address, bool failing) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  devices_[address].failing = failing;
+}
+
+void SimulatedI2cBus::SetRegister(uint16_t address, uint8_t reg, uint8_t value) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  devices_[address].registers[reg] = value;
+}
+
+uint8_t SimulatedI2cBus::GetRegister(uint16_t address, uint8_t reg) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const auto it = devices_.find(address);
+  return it == devices_.end() ? 0 : it->second.registers[reg];
+}
+
+uint32_t SimulatedI2cBus::transfers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return transfers_;
+}
+
+bool SimulatedI2cBus::Transfer(uint16_t address, const uint8_t* write, size_t write_size, uint8_t* read,
+                               size_t read_size) {
+  if (transfer_us_ > 0) {
+    std::this_thread::sleep_for(std::chrono::microseconds(transfer_us_));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  transfers_++;
+  const auto it = devices_.find(address);
+  if (it == devices_.end() || it->second.failing) {
+    return false;
+  }
+  auto& registers = it->second.registers;
+  uint8_t reg = write_size > 0 ? write[0] : 0;
+  for (size_t i = 1; i < write_size; i++) {
+    registers[reg++] = write[i];
+  }
+  for (size_t i = 0; i < read_size; i++) {
+    read[i] = registers[reg++];
+  }
+  return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef _SIMULATED_I2C_BUS_H_
+#define _SIMULATED_I2C_BUS_H_
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <mutex>
+
+#include "i2c_bus_manager.h"
+
+/**
+ * @file simulated_i2c_bus.h
+ * @brief 模拟的 I2C 总线，用于在主机上运行 I2cBusManager
+ *
+ * 每个设备有256个寄存器，第一个写入字节为寄存器地址，之后的读写从该地址开始自动递增。
+ * 可设置每次传输的耗时和某个设备是否应答，以复现总线争用和设备故障。
+ */
+class SimulatedI2cBus : public I2cBus {
+ public:
+  explicit SimulatedI2cBus(uint32_t transfer_us = 0);
+
+  void AddDevice(uint16_t address);
+  void SetFailing(uint16_t address, bool failing);
+  void SetRegister(uint16_t address, uint8_t reg, uint8_t value);
+  uint8_t GetRegister(uint16_t address, uint8_t reg) const;
+
+  /**
+   * @brief 已执行的传输次数
+   */
+  uint32_t transfers() const;
+
+  bool Transfer(uint16_t address, const uint8_t* write, size_t write_size, uint8_t* read, size_t read_size) override;
+
+ private:
+  struct Device {
+    std::array<uint8_t, 256> registers = {};
+    bool failing = false;
+  };
+
+  const uint32_t transfer_us_;
+  mutable std::mutex mutex_;
+  std::map<uint16_t, Device> devices_;
+  uint32_t transfers_ = 0;
+};
+
+#endif
@@ -0,0 +1,343 @@
+/**
+ * @file asset_pack_tool.cpp
+ * @brief 在 PC(Linux/macOS)上生成和检查提示音资源包
+ *
+ * 不属于固件(Arduino 不编译草图中 tools 目录下的文件)，与固件共用 asset_pack.cpp 中的读取实现。
+ * 在 tools 目录下：
+ * @code
+ * # 1. 编译本工具
+ * g++ -std=c++17 -O2 -I.. -o asset_pack_tool asset_pack_tool.cpp ../asset_pack.cpp
+ *
+ * # 2. 生成资源包：ID=文件，ID 与 ai_vox3_device.cpp 中的 PromptId 一致。
+ * #    .mp3 原样存放；.wav(16位PCM)存放为PCM，播放时不需要解码；
+ * #    *_mp3.h 取出其中的数组，即原先编译进固件的提示音
+ * ./asset_pack_tool build assets.bin 1=../notification_0_mp3.h 2=../network_config_mode_mp3.h \
+ *     3=../network_connected_mp3.h
+ *
+ * # 3. 映射文件并用固件的读取实现检查格式和校验值，列出所有资源(build 完成后会自动检查)
+ * ./asset_pack_tool check assets.bin
+ *
+ * # 4. 烧录到 partitions.csv 中名为 assets 的数据分区(0x500000，1MB)，固件以 PROMPT_ASSET_PACK 宏编译
+ * parttool.py --port /dev/ttyUSB0 write_partition --partition-name assets --input assets.bin
+ * # 或者
+ * esptool.py --chip esp32s3 --port /dev/ttyUSB0 write_flash 0x500000 assets.bin
+ * @endcode
+ */
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_pack.h"
+
+namespace {
+
+struct InputAsset {
+  AssetPackEntry entry;
+  std::vector<uint8_t> data;
+};
+
+bool ReadFile(const std::string& path, std::vector<uint8_t>* data) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    printf("cannot open %s\n", path.c_str());
+    return false;
+  }
+  data->assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  return true;
+}
+
+uint32_t ReadLe32(const uint8_t* data) {
+  return data[0] | data[1] << 8 | data[2] << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+uint16_t ReadLe16(const uint8_t* data) {
+  return data[0] | data[1] << 8;
+}
+
+// 取出 WAV 文件中的16位PCM数据，只支持未压缩格式
+bool ParseWav(const std::string& path, const std::vector<uint8_t>& file, InputAsset* asset) {
+  if (file.size() < 12 || memcmp(file.data(), "RIFF", 4) != 0 || memcmp(file.data() + 8, "WAVE", 4) != 0) {
+    printf("%s: not a RIFF/WAVE file\n", path.c_str());
+    return false;
+  }
+
+  bool has_format = false;
+  size_t offset = 12;
+  while (offset + 8 <= file.size()) {
+    const uint8_t* chunk = file.data() + offset;
+    const size_t chunk_size = std::min<size_t>(ReadLe32(chunk + 4), file.size() - offset - 8);
+    if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16) {
+      const auto format = ReadLe16(chunk + 8);
+      const auto channels = ReadLe16(chunk + 10);
+      const auto bits = ReadLe16(chunk + 22);
+      if (format != 1 || bits != 16 || channels == 0 || channels > 2) {
+        printf("%s: only 16-bit mono or stereo PCM is supported (format %u, %u bits, %u channels)\n", path.c_str(),
+               format, bits, channels);
+        return false;
+      }
+      asset->entry.channels = static_cast<uint8_t>(channels);
+      asset->entry.sample_rate = ReadLe32(chunk + 12);
+      has_format = true;
+    } else if (memcmp(chunk, "data", 4) == 0) {
+      if (!has_format) {
+        printf("%s: data chunk before fmt chunk\n", path.c_str());
+        return false;
+      }
+      const size_t frame_bytes = asset->entry.channels * sizeof(int16_t);
+      asset->data.assign(chunk + 8, chunk + 8 + chunk_size / frame_bytes * frame_bytes);
+      asset->entry.encoding = static_cast<uint8_t>(AssetEncoding::kPcm16);
+      return true;
+    }
+    // 块按偶数字节对齐
+    offset += 8 + chunk_size + (chunk_size & 1);
+  }
+  printf("%s: no data chunk\n", path.c_str());
+  return false;
+}
+
+// 取出 C 头文件中第一个数组初始化列表里的所有十六进制字节(如 network_connected_mp3.h)
+bool ParseByteArrayHeader(const std::string& path, const std::vector<uint8_t>& file, std::vector<uint8_t>* data) {
+  const std::string_view text(reinterpret_cast<const char*>(file.data()), file.size());
+  const auto begin = text.find('{');
+  const auto end = text.find('}', begin);
+  if (begin == std::string_view::npos || end == std::string_view::npos) {
+    printf("%s: no array initializer found\n", path.c_str());
+    return false;
+  }
+
+  data->clear();
+  const std::string body(text.substr(begin + 1, end - begin - 1));
+  const char* p = body.c_str();
+  while (*p != '\0') {
+    char* next = nullptr;
+    const auto value = strtoul(p, &next, 0);
+    if (next == p) {
+      p++;
+      continue;
+    }
+    if (value > UINT8_MAX) {
+      printf("%s: value %lu is not a byte\n", path.c_str(), value);
+      return false;
+    }
+    data->push_back(static_cast<uint8_t>(value));
+    p = next;
+  }
+  if (data->empty()) {
+    printf("%s: empty array\n", path.c_str());
+    return false;
+  }
+  return true;
+}
+
+bool EndsWith(std::string_view text, std::string_view suffix) {
+  return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+// 解析 "ID=文件"
+bool LoadInput(const std::string& argument, InputAsset* asset) {
+  const auto separator = argument.find('=');
+  char* end = nullptr;
+  const auto id = separator == std::string::npos ? 0 : strtoul(argument.c_str(), &end, 0);
+  if (separator == std::string::npos || end != argument.c_str() + separator || id > UINT16_MAX) {
+    printf("bad asset argument '%s', expected ID=FILE\n", argument.c_str());
+    return false;
+  }
+  const auto path = argument.substr(separator + 1);
+
+  std::vector<uint8_t> file;
+  if (!ReadFile(path, &file)) {
+    return false;
+  }
+
+  asset->entry = AssetPackEntry();
+  asset->entry.id = static_cast<uint16_t>(id);
+  if (EndsWith(path, ".wav")) {
+    return ParseWav(path, file, asset);
+  }
+  if (EndsWith(path, ".mp3")) {
+    asset->entry.encoding = static_cast<uint8_t>(AssetEncoding::kMp3);
+    asset->data = std::move(file);
+    return true;
+  }
+  if (EndsWith(path, "_mp3.h")) {
+    asset->entry.encoding = static_cast<uint8_t>(AssetEncoding::kMp3);
+    return ParseByteArrayHeader(path, file, &asset->data);
+  }
+  printf("%s: unsupported file type, expected .mp3, .wav or *_mp3.h\n", path.c_str());
+  return false;
+}
+
+size_t AlignUp(size_t value) {
+  return (value + kAssetPackAlignment - 1) / kAssetPackAlignment * kAssetPackAlignment;
+}
+
+const char* EncodingName(AssetEncoding encoding) {
+  return encoding == AssetEncoding::kPcm16 ? "pcm16" : "mp3";
+}
+
+// 以只读方式映射整个文件，与固件映射分区的方式相同
+class MappedFile {
+ public:
+  ~MappedFile() {
+    if (data_ != nullptr) {
+      munmap(data_, size_);
+    }
+  }
+
+  bool Map(const char* path) {
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+      printf("cannot open %s\n", path);
+      return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+      printf("cannot map empty file %s\n", path);
+      close(fd);
+      return false;
+    }
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+      printf("cannot mmap %s\n", path);
+      return false;
+    }
+    data_ = data;
+    size_ = info.st_size;
+    return true;
+  }
+
+  const void* data() const {
+    return data_;
+  }
+
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+int Check(const char* path) {
+  MappedFile file;
+  AssetPack pack;
+  if (!file.Map(path) || !pack.Open(file.data(), file.size()) || !pack.Verify()) {
+    return 1;
+  }
+
+  printf("%s: %zu assets, %zu bytes\n", path, pack.asset_count(), pack.size());
+  for (size_t i = 0; i < pack.asset_count(); i++) {
+    const auto asset = pack.at(i);
+    const auto offset = asset.data - static_cast<const uint8_t*>(file.data());
+    printf("  id %5u  %-5s  offset %8td  size %8zu", asset.id, EncodingName(asset.encoding), offset, asset.size);
+    if (asset.encoding == AssetEncoding::kPcm16) {
+      printf("  %" PRIu32 " Hz %u ch  %.2f s", asset.sample_rate, asset.channels,
+             static_cast<double>(asset.size) / (asset.sample_rate * asset.channels * sizeof(int16_t)));
+    }
+    printf("\n");
+  }
+  return 0;
+}
+
+int Build(const char* output, int count, char** arguments) {
+  std::vector<InputAsset> assets(count);
+  for (int i = 0; i < count; i++) {
+    if (!LoadInput(arguments[i], &assets[i])) {
+      return 1;
+    }
+  }
+
+  // 偏移表按ID升序，固件用二分查找
+  std::sort(assets.begin(), assets.end(), [](const InputAsset& a, const InputAsset& b) {
+    return a.entry.id < b.entry.id;
+  });
+  for (size_t i = 1; i < assets.size(); i++) {
+    if (assets[i].entry.id == assets[i - 1].entry.id) {
+      printf("duplicate asset id %u\n", assets[i].entry.id);
+      return 1;
+    }
+  }
+  if (assets.size() > UINT16_MAX) {
+    printf("too many assets\n");
+    return 1;
+  }
+
+  size_t offset = sizeof(AssetPackHeader) + assets.size() * sizeof(AssetPackEntry);
+  for (auto& asset : assets) {
+    offset = AlignUp(offset);
+    asset.entry.offset = static_cast<uint32_t>(offset);
+    asset.entry.size = static_cast<uint32_t>(asset.data.size());
+    offset += asset.data.size();
+  }
+  if (offset > UINT32_MAX) {
+    printf("pack exceeds 4 GiB\n");
+    return 1;
+  }
+
+  // 头部和偏移表按小端字节序直接写出，与 ESP32 相同
+  std::vector<uint8_t> pack(offset, 0);
+  for (size_t i = 0; i < assets.size(); i++) {
+    memcpy(pack.data() + sizeof(AssetPackHeader) + i * sizeof(AssetPackEntry), &assets[i].entry,
+           sizeof(AssetPackEntry));
+    std::copy(assets[i].data.begin(), assets[i].data.end(), pack.begin() + assets[i].entry.offset);
+  }
+
+  AssetPackHeader header;
+  memcpy(header.magic, kAssetPackMagic, sizeof(header.magic));
+  header.version = kAssetPackVersion;
+  header.asset_count = static_cast<uint16_t>(assets.size());
+  header.size = static_cast<uint32_t>(pack.size());
+  header.checksum = AssetPackChecksum(pack.data() + sizeof(AssetPackHeader), pack.size() - sizeof(AssetPackHeader));
+  memcpy(pack.data(), &header, sizeof(header));
+
+  std::ofstream file(output, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(pack.data()), pack.size());
+  file.close();
+  if (!file) {
+    printf("cannot write %s\n", output);
+    return 1;
+  }
+
+  // 用固件的读取实现重新检查写出的文件
+  return Check(output);
+}
+
+int Usage(const char* program) {
+  printf("usage:\n");
+  printf("  %s build <output> <id>=<file.mp3|file.wav|name_mp3.h>...\n", program);
+  printf("  %s check <pack>\n", program);
+  return 2;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const uint16_t probe = 1;
+  if (*reinterpret_cast<const uint8_t*>(&probe) != 1) {
+    printf("big-endian hosts are not supported\n");
+    return 1;
+  }
+
+  if (argc >= 4 && strcmp(argv[1], "build") == 0) {
+    return Build(argv[2], argc - 3, argv + 3);
+  }
+  if (argc == 3 && strcmp(argv[1], "check") == 0) {
+    return Check(argv[2]);
+  }
+  return Usage(argv[0]);
+}
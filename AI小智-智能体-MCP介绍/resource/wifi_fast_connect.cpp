@@ -0,0 +1,156 @@
+#include "wifi_fast_connect.h"
+
+#include <nvs.h>
+
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+constexpr char kNvsNamespace[] = "wifi_fast";
+constexpr char kNvsKey[] = "conn";
+// 修改 WifiConnectionInfo 的布局时递增，旧版本的缓存自动失效(版本1保存了SSID和密码)
+constexpr uint32_t kRecordVersion = 2;
+
+struct Record {
+  uint32_t version = kRecordVersion;
+  WifiConnectionInfo info;
+};
+
+bool IsValid(const WifiConnectionInfo& info) {
+  constexpr uint8_t kZeroBssid[sizeof(info.bssid)] = {};
+  return info.channel != 0 && memcmp(info.bssid, kZeroBssid, sizeof(info.bssid)) != 0;
+}
+
+bool IsSameConnection(const WifiConnectionInfo& a, const WifiConnectionInfo& b) {
+  return memcmp(a.bssid, b.bssid, sizeof(a.bssid)) == 0 && a.channel == b.channel && a.ip == b.ip &&
+         a.gateway == b.gateway && a.subnet == b.subnet && a.dns == b.dns;
+}
+
+void CopyString(char* dest, size_t dest_size, const char* src) {
+  strncpy(dest, src, dest_size - 1);
+  dest[dest_size - 1] = '\0';
+}
+
+const char* ResultName(WifiFastConnectResult result) {
+  switch (result) {
+    case WifiFastConnectResult::kConnected:
+      return "connected";
+    case WifiFastConnectResult::kTimeout:
+      return "timeout";
+    case WifiFastConnectResult::kAuthFailed:
+      return "auth failed";
+    case WifiFastConnectResult::kNetworkNotFound:
+      return "network not found";
+  }
+  return "unknown";
+}
+
+}  // namespace
+
+// ==================== WifiFastConnect ====================
+
+WifiFastConnect::WifiFastConnect(WifiFastConnectDriver& driver, WifiFastConnectStore& store, bool reuse_ip)
+    : driver_(driver), store_(store), reuse_ip_(reuse_ip) {
+}
+
+bool WifiFastConnect::TryConnect(uint32_t timeout_ms, const char* ssid, const char* password) {
+  WifiConnectionInfo info;
+  if (!store_.Load(info) || !IsValid(info)) {
+    printf("wifi fast connect: no cached connection\n");
+    return false;
+  }
+
+  WifiCredentials credentials;
+  if (ssid != nullptr) {
+    CopyString(credentials.ssid, sizeof(credentials.ssid), ssid);
+    CopyString(credentials.password, sizeof(credentials.password), password != nullptr ? password : "");
+  } else if (!driver_.GetSavedCredentials(credentials)) {
+    printf("wifi fast connect: no saved credentials\n");
+    return false;
+  }
+
+  const bool static_ip = reuse_ip_ && info.ip != 0;
+  printf("wifi fast connect: ssid %s, channel %u, %s\n", credentials.ssid, info.channel,
+         static_ip ? "static ip" : "dhcp");
+  const auto result = driver_.Connect(credentials, info, static_ip, timeout_ms);
+  if (result == WifiFastConnectResult::kConnected) {
+    return true;
+  }
+
+  driver_.Disconnect();
+  // 超时可能只是AP暂时繁忙，保留缓存供下次启动使用
+  if (result == WifiFastConnectResult::kTimeout) {
+    printf("wifi fast connect: %s, keep cache\n", ResultName(result));
+  } else {
+    printf("wifi fast connect: %s, clear cache\n", ResultName(result));
+    store_.Clear();
+  }
+  return false;
+}
+
+void WifiFastConnect::UpdateCache() {
+  WifiConnectionInfo current;
+  if (!driver_.GetConnectionInfo(current) || !IsValid(current)) {
+    return;
+  }
+
+  WifiConnectionInfo cached;
+  if (store_.Load(cached) && IsSameConnection(current, cached)) {
+    return;
+  }
+
+  if (store_.Save(current)) {
+    printf("wifi fast connect: cache updated\n");
+  }
+}
+
+// ==================== NvsWifiFastConnectStore ====================
+
+bool NvsWifiFastConnectStore::Load(WifiConnectionInfo& info) {
+  nvs_handle_t handle = 0;
+  if (nvs_open(kNvsNamespace, NVS_READONLY, &handle) != ESP_OK) {
+    return false;
+  }
+
+  Record record;
+  size_t size = sizeof(record);
+  const auto err = nvs_get_blob(handle, kNvsKey, &record, &size);
+  nvs_close(handle);
+  if (err != ESP_OK || size != sizeof(record) || record.version != kRecordVersion) {
+    return false;
+  }
+  info = record.info;
+  return true;
+}
+
+bool NvsWifiFastConnectStore::Save(const WifiConnectionInfo& info) {
+  nvs_handle_t handle = 0;
+  if (nvs_open(kNvsNamespace, NVS_READWRITE, &handle) != ESP_OK) {
+    printf("wifi fast connect: failed to open nvs\n");
+    return false;
+  }
+
+  Record record;
+  record.info = info;
+  auto err = nvs_set_blob(handle, kNvsKey, &record, sizeof(record));
+  if (err == ESP_OK) {
+    err = nvs_commit(handle);
+  }
+  nvs_close(handle);
+  if (err != ESP_OK) {
+    printf("wifi fast connect: failed to save cache, err: %d\n", err);
+    return false;
+  }
+  return true;
+}
+
+void NvsWifiFastConnectStore::Clear() {
+  nvs_handle_t handle = 0;
+  if (nvs_open(kNvsNamespace, NVS_READWRITE, &handle) != ESP_OK) {
+    return;
+  }
+  nvs_erase_key(handle, kNvsKey);
+  nvs_commit(handle);
+  nvs_close(handle);
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#ifndef _WIFI_FAST_CONNECT_H_
+#define _WIFI_FAST_CONNECT_H_
+
+#include <cstdint>
+
+/**
+ * @file wifi_fast_connect.h
+ * @brief 使用缓存的连接信息快速重连WiFi
+ *
+ * 上次连接成功的AP的BSSID、信道和IP信息保存在NVS中，重启后直接向该AP发起连接，
+ * 跳过扫描，可选复用上次的IP以跳过DHCP。缓存中不保存SSID和密码，凭据来自编译期配置
+ * 或WiFi驱动自己保存的配置。只有认证失败或找不到该AP时才清除缓存，单次超时保留缓存，
+ * 由调用者回退到常规配网流程。
+ *
+ * WiFi驱动和存储通过接口访问，缓存逻辑可以在主机上配合假的实现进行测试；
+ * 基于 Arduino WiFi 的驱动见 arduino_wifi_fast_connect_driver.h。
+ */
+
+/**
+ * @brief 缓存的AP和IP信息
+ */
+struct WifiConnectionInfo {
+  uint8_t bssid[6] = {};
+  uint8_t channel = 0;
+  uint32_t ip = 0;
+  uint32_t gateway = 0;
+  uint32_t subnet = 0;
+  uint32_t dns = 0;
+};
+
+/**
+ * @brief 连接使用的凭据，只在连接时临时存在，不写入缓存
+ */
+struct WifiCredentials {
+  char ssid[33] = {};
+  char password[65] = {};
+};
+
+enum class WifiFastConnectResult : uint8_t {
+  kConnected,
+  kTimeout,          // 在超时时间内未完成连接，可能只是AP暂时繁忙
+  kAuthFailed,       // 密码错误或认证被拒绝
+  kNetworkNotFound,  // 缓存的信道上找不到该BSSID和SSID的AP
+};
+
+class WifiFastConnectDriver {
+ public:
+  virtual ~WifiFastConnectDriver() = default;
+
+  /**
+   * @brief 读取WiFi驱动保存的凭据(上次配网或连接时使用的)，没有时返回false
+   */
+  virtual bool GetSavedCredentials(WifiCredentials& credentials) = 0;
+
+  /**
+   * @brief 按指定的BSSID和信道连接，等待连接成功、失败或超时
+   *
+   * @param static_ip 为true时使用 info 中的IP信息，不经过DHCP
+   */
+  virtual WifiFastConnectResult Connect(const WifiCredentials& credentials,
+                                        const WifiConnectionInfo& info,
+                                        bool static_ip,
+                                        uint32_t timeout_ms) = 0;
+
+  /**
+   * @brief 断开连接并恢复DHCP
+   */
+  virtual void Disconnect() = 0;
+
+  /**
+   * @brief 读取当前连接的AP和IP信息，未连接时返回false
+   */
+  virtual bool GetConnectionInfo(WifiConnectionInfo& info) = 0;
+};
+
+class WifiFastConnectStore {
+ public:
+  virtual ~WifiFastConnectStore() = default;
+  virtual bool Load(WifiConnectionInfo& info) = 0;
+  virtual bool Save(const WifiConnectionInfo& info) = 0;
+  virtual void Clear() = 0;
+};
+
+class WifiFastConnect {
+ public:
+  /**
+   * @param reuse_ip 快速连接时是否复用缓存的IP，跳过DHCP。
+   *                 租约可能已被路由器分配给其他设备，只建议在路由器为本设备保留了IP时开启
+   */
+  WifiFastConnect(WifiFastConnectDriver& driver, WifiFastConnectStore& store, bool reuse_ip);
+
+  /**
+   * @brief 使用缓存的AP信息连接
+   *
+   * @param ssid/password 编译期配置的凭据，为nullptr时使用WiFi驱动保存的凭据。
+   *                      修改了配置的网络后，旧AP上找不到新的SSID，缓存随之失效
+   * @return 没有可用缓存或连接失败时返回false并断开连接；认证失败或找不到AP时清除缓存
+   */
+  bool TryConnect(uint32_t timeout_ms, const char* ssid = nullptr, const char* password = nullptr);
+
+  /**
+   * @brief 连接成功后调用，连接信息与缓存不同时才写入，减少Flash擦写
+   */
+  void UpdateCache();
+
+ private:
+  WifiFastConnectDriver& driver_;
+  WifiFastConnectStore& store_;
+  const bool reuse_ip_;
+};
+
+/**
+ * @brief 基于NVS的存储实现
+ */
+class NvsWifiFastConnectStore : public WifiFastConnectStore {
+ public:
+  bool Load(WifiConnectionInfo& info) override;
+  bool Save(const WifiConnectionInfo& info) override;
+  void Clear() override;
+};
+
+#endif